@@ -0,0 +1,30 @@
+/* Alerts probe declarations for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ALERTS_PROBE_H__
+#define __ALERTS_PROBE_H__
+
+#include <vector>
+#include <time.h>
+#include "api_response.h"
+
+time_t scheduleAlertsProbe(time_t now, time_t nextUpdate);
+bool isAlertsProbeWake();
+void rememberAlerts(const std::vector<owm_alerts_t> &alerts);
+bool alertsChanged(const std::vector<owm_alerts_t> &alerts);
+
+#endif
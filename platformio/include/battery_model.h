@@ -0,0 +1,37 @@
+/* Battery discharge model declarations for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BATTERY_MODEL_H__
+#define __BATTERY_MODEL_H__
+
+#include <cstdint>
+#include <time.h>
+#include <Preferences.h>
+
+typedef struct bat_sample
+{
+  uint32_t time;       // Unix, UTC
+  uint16_t millivolts;
+  uint16_t scale;      // sleep interval scale at the time, x100
+} bat_sample_t;
+
+uint32_t calcBatPercent(uint32_t v, uint32_t minv, uint32_t maxv);
+void updateBatteryModel(Preferences &prefs, uint32_t batteryVoltage,
+                        time_t now);
+float getBatteryDaysRemaining();
+
+#endif
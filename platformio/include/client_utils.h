@@ -32,10 +32,14 @@ void killWiFi();
 bool waitForSNTPSync(tm *timeInfo);
 bool printLocalTime(tm *timeInfo);
 #ifdef USE_HTTP
-  int getOWMonecall(WiFiClient &client, owm_resp_onecall_t &r);
+  int getOWMonecall(WiFiClient &client, owm_resp_onecall_t &r,
+                    uint8_t sections);
+  int getOWMalerts(WiFiClient &client, owm_resp_onecall_t &r);
   int getOWMairpollution(WiFiClient &client, owm_resp_air_pollution_t &r);
 #else
-  int getOWMonecall(WiFiClientSecure &client, owm_resp_onecall_t &r);
+  int getOWMonecall(WiFiClientSecure &client, owm_resp_onecall_t &r,
+                    uint8_t sections);
+  int getOWMalerts(WiFiClientSecure &client, owm_resp_onecall_t &r);
   int getOWMairpollution(WiFiClientSecure &client, owm_resp_air_pollution_t &r);
 #endif
 
@@ -42,6 +42,90 @@
 #define DRIVER_DESPI_C02
 // #define DRIVER_WAVESHARE
 
+// PARTIAL REFRESH
+// Only supported by the 7.5in e-Paper (v2) panel (DISP_BW_V2).
+// When enabled, the frame shown on the panel is kept (compressed) in flash and
+// the next update only refreshes the region of the panel that changed, using
+// the panel's fast partial refresh. This avoids the flashing of a full refresh
+// and shortens the time the panel is powered. Partial refreshes slowly build up
+// ghosting, so a full refresh is made after PARTIAL_REFRESH_LIMIT consecutive
+// partial refreshes (see config.cpp), and after every reset.
+//   0 : Disable (always full refresh)
+//   1 : Enable
+#define PARTIAL_REFRESH 0
+
+// FAST FULL REFRESH
+// Only supported by the 7.5in e-Paper (v2) panel (DISP_BW_V2).
+// When enabled, full refreshes use the panel's fast full refresh waveform,
+// which takes a fraction of the time (and energy) of the standard waveform.
+// The fast waveform does not clean the panel as thoroughly, so a standard full
+// refresh is made after FAST_FULL_REFRESH_LIMIT consecutive fast refreshes (see
+// config.cpp), and after every reset.
+// Can be combined with PARTIAL_REFRESH, in which case the full refreshes that
+// follow a series of partial refreshes are fast full refreshes.
+//   0 : Disable (always standard full refresh)
+//   1 : Enable
+#define FAST_FULL_REFRESH 0
+
+// SLEEP DURING REFRESH
+// A full refresh keeps the panel busy for several seconds (~15 seconds for the
+// 3-color panel). Instead of waiting for the panel at full active current, the
+// esp32 can sleep until the panel releases its BUSY pin.
+//   0 : Disable (wait while awake)
+//   1 : Light sleep while the panel is busy.
+//   2 : Deep sleep during full refreshes. The esp32 only wakes to power off
+//       the panel and then sleeps until the next update. Requires PIN_EPD_BUSY
+//       to be an RTC GPIO, otherwise light sleep is used instead.
+//       Light sleep is used for all other waits.
+#define SLEEP_DURING_REFRESH 0
+
+// DISPLAY LIST
+// A frame is drawn in pages when its buffer does not fit in the memory that is
+// free at the time, typically 2 pages for the 3-color (DISP_3C_B) and 4 for the
+// 7-color (DISP_7C_F) panel. Boards with PSRAM always draw in one page. Without
+// a display list all of the layout code (formatting, measuring text, choosing
+// icons) is run again for every page. When enabled, the drawing operations are
+// recorded while the first page is drawn, and the remaining pages are drawn
+// from the recording. Has no effect on frames drawn in one page.
+//   0 : Disable
+//   1 : Enable (default)
+#define DISPLAY_LIST 1
+
+// DUAL CORE RASTER
+// Drawing the frame otherwise runs on one core while the other idles. When
+// enabled, the frame is only recorded in the display list while the layout
+// code runs, and then each page is drawn from the display list by both cores,
+// each drawing half of the page's rows. Applies to all panels, including the
+// single page black/white panels. Requires DISPLAY_LIST.
+//   0 : Disable (default)
+//   1 : Enable
+#define DUAL_CORE_RASTER 0
+
+// CHROME CACHE
+// The icons and labels of the current conditions widgets are the same on every
+// wake. When enabled, they are drawn once into a "chrome" layer that is kept
+// (compressed) in flash, and each frame starts from a copy of it, so that only
+// the weather values are drawn. The chrome layer is drawn and saved again
+// whenever the firmware (and so the configuration or locale) changes.
+//   0 : Disable (default)
+//   1 : Enable
+#define CHROME_CACHE 0
+
+// CPU FREQUENCY BOOST
+// The esp32 runs at the frequency set by board_build.f_cpu in platformio.ini
+// (80MHz), which suits waiting on the radio and the panel. The CPU bound parts
+// of a wake (TLS handshakes and JSON parsing of the API requests, and drawing
+// the frame) are run at this frequency instead, finishing sooner at a higher
+// current. Whether that saves energy depends on the board and the network, so
+// it is disabled by default. With the boost enabled and DEBUG_LEVEL >= 1, the
+// CPU energy of the wake is estimated for boosting and for either frequency
+// alone; keep the boost only if it shows a saving, ideally confirmed by
+// measuring the current of a wake.
+//   0   : Disabled (default)
+//   160 : 160MHz
+//   240 : 240MHz
+#define CPU_BOOST_FREQ_MHZ 0
+
 // INDOOR ENVIRONMENT SENSOR
 // Uncomment the macro that identifies your sensor.
 #define SENSOR_BME280
@@ -51,6 +135,28 @@
 // add a small delay before reading it's value. 300ms seems to work for most people
 // #define SENSOR_INIT_DELAY_MS 300
 
+// INDOOR SENSOR MEASUREMENT
+// How the indoor sensor is read on each wake.
+//   0 : Library defaults. Continuous measurement with heavy oversampling (and
+//       the BME680 gas heater). (default)
+//   1 : A single forced mode measurement without oversampling, so the sensor
+//       is powered for only a few milliseconds. The extra noise is filtered
+//       across wakes, by averaging each reading with the filtered value of the
+//       previous wake, so the indoor values lag behind changes by about one
+//       update interval.
+#define SENSOR_FAST_MEASUREMENT 0
+
+// INDOOR SENSOR SAMPLING DURING SLEEP
+// When enabled, the ULP coprocessor keeps sampling the indoor temperature and
+// humidity while the esp32 is in deep sleep, and the display shows the range
+// and trend of the indoor temperature since the last update. Costs a few
+// microamps on average.
+//   0 : Disabled (default)
+//   1 : Enabled. Requires SENSOR_BME280 wired to the RTC I2C pins, SCL to GPIO
+//       4 or 2 and SDA to GPIO 0 or 15 (i.e. SDA 15, SCL 2), and PIN_BME_PWR
+//       to be an RTC GPIO. Otherwise the sensor is only read when awake.
+#define SENSOR_ULP_SAMPLING 0
+
 // 3 COLOR E-INK ACCENT COLOR
 // Defines the 3rd color to be used when a 3+ color display is selected.
 #if defined(DISP_3C_B) || defined(DISP_7C_F)
@@ -300,6 +406,9 @@
 #define STATUS_BAR_EXTRAS_BAT_VOLTAGE    0
 #define STATUS_BAR_EXTRAS_WIFI_STRENGTH  1
 #define STATUS_BAR_EXTRAS_WIFI_RSSI      0
+// Projected days of battery remaining, once enough voltage history has been
+// recorded (requires BATTERY_MONITORING).
+#define STATUS_BAR_EXTRAS_BAT_DAYS       0
 
 // BATTERY MONITORING
 //   You may choose to power your weather display with or without a battery.
@@ -312,6 +421,8 @@
 
 // DEBUG
 //   If defined, enables increase verbosity over the serial port.
+//   level -1: no serial output, the UART is not started (for a display with
+//             no host attached)
 //   level 0: basic status information, assists troubleshooting (default)
 //   level 1: increased verbosity for debugging
 //   level 2: print api responses to serial monitor
@@ -353,6 +464,10 @@ extern const int SLEEP_DURATION;
 extern const int BED_TIME;
 extern const int WAKE_TIME;
 extern const int HOURLY_GRAPH_MAX;
+extern const int PARTIAL_REFRESH_LIMIT;
+extern const int FAST_FULL_REFRESH_LIMIT;
+extern const int CACHE_MAX_AGE;
+extern const int ALERTS_PROBE_INTERVAL;
 extern const uint32_t WARN_BATTERY_VOLTAGE;
 extern const uint32_t LOW_BATTERY_VOLTAGE;
 extern const uint32_t VERY_LOW_BATTERY_VOLTAGE;
@@ -361,6 +476,8 @@ extern const unsigned long LOW_BATTERY_SLEEP_INTERVAL;
 extern const unsigned long VERY_LOW_BATTERY_SLEEP_INTERVAL;
 extern const uint32_t MAX_BATTERY_VOLTAGE;
 extern const uint32_t MIN_BATTERY_VOLTAGE;
+extern const int BATTERY_TARGET_DAYS;
+extern const int MAX_SLEEP_DURATION;
 
 // CONFIG VALIDATION - DO NOT MODIFY
 #if !(  defined(DISP_BW_V2)  \
@@ -373,10 +490,74 @@ extern const uint32_t MIN_BATTERY_VOLTAGE;
       ^ defined(DRIVER_DESPI_C02))
   #error Invalid configuration. Exactly one driver board must be selected.
 #endif
+#if !(defined(PARTIAL_REFRESH))
+  #error Invalid configuration. PARTIAL_REFRESH not defined.
+#endif
+#if PARTIAL_REFRESH && !defined(DISP_BW_V2)
+  #error Invalid configuration. PARTIAL_REFRESH is only supported by DISP_BW_V2.
+#endif
+#if !(defined(FAST_FULL_REFRESH))
+  #error Invalid configuration. FAST_FULL_REFRESH not defined.
+#endif
+#if FAST_FULL_REFRESH && !defined(DISP_BW_V2)
+  #error Invalid configuration. FAST_FULL_REFRESH is only supported by DISP_BW_V2.
+#endif
+#if !(defined(SLEEP_DURING_REFRESH))
+  #error Invalid configuration. SLEEP_DURING_REFRESH not defined.
+#endif
+#if !(  SLEEP_DURING_REFRESH == 0 \
+     || SLEEP_DURING_REFRESH == 1 \
+     || SLEEP_DURING_REFRESH == 2)
+  #error Invalid configuration. Illegal value of SLEEP_DURING_REFRESH.
+#endif
+#if !(defined(DISPLAY_LIST))
+  #error Invalid configuration. DISPLAY_LIST not defined.
+#endif
+#if !(DISPLAY_LIST == 0 || DISPLAY_LIST == 1)
+  #error Invalid configuration. Illegal value of DISPLAY_LIST.
+#endif
+#if !(defined(DUAL_CORE_RASTER))
+  #error Invalid configuration. DUAL_CORE_RASTER not defined.
+#endif
+#if !(DUAL_CORE_RASTER == 0 || DUAL_CORE_RASTER == 1)
+  #error Invalid configuration. Illegal value of DUAL_CORE_RASTER.
+#endif
+#if DUAL_CORE_RASTER && !DISPLAY_LIST
+  #error Invalid configuration. DUAL_CORE_RASTER requires DISPLAY_LIST.
+#endif
+#if !(defined(CHROME_CACHE))
+  #error Invalid configuration. CHROME_CACHE not defined.
+#endif
+#if !(CHROME_CACHE == 0 || CHROME_CACHE == 1)
+  #error Invalid configuration. Illegal value of CHROME_CACHE.
+#endif
 #if !(  defined(SENSOR_BME280) \
       ^ defined(SENSOR_BME680))
   #error Invalid configuration. Exactly one sensor must be selected.
 #endif
+#if !(defined(CPU_BOOST_FREQ_MHZ))
+  #error Invalid configuration. CPU_BOOST_FREQ_MHZ not defined.
+#endif
+#if !(  CPU_BOOST_FREQ_MHZ == 0   \
+     || CPU_BOOST_FREQ_MHZ == 160 \
+     || CPU_BOOST_FREQ_MHZ == 240)
+  #error Invalid configuration. Illegal value of CPU_BOOST_FREQ_MHZ.
+#endif
+#if !(defined(SENSOR_FAST_MEASUREMENT))
+  #error Invalid configuration. SENSOR_FAST_MEASUREMENT not defined.
+#endif
+#if !(SENSOR_FAST_MEASUREMENT == 0 || SENSOR_FAST_MEASUREMENT == 1)
+  #error Invalid configuration. Illegal value of SENSOR_FAST_MEASUREMENT.
+#endif
+#if !(defined(SENSOR_ULP_SAMPLING))
+  #error Invalid configuration. SENSOR_ULP_SAMPLING not defined.
+#endif
+#if !(SENSOR_ULP_SAMPLING == 0 || SENSOR_ULP_SAMPLING == 1)
+  #error Invalid configuration. Illegal value of SENSOR_ULP_SAMPLING.
+#endif
+#if SENSOR_ULP_SAMPLING && !defined(SENSOR_BME280)
+  #error Invalid configuration. SENSOR_ULP_SAMPLING requires SENSOR_BME280.
+#endif
 #if !(defined(LOCALE))
   #error Invalid configuration. Locale not selected.
 #endif
@@ -465,6 +646,9 @@ extern const uint32_t MIN_BATTERY_VOLTAGE;
 #if !(defined(DEBUG_LEVEL))
   #error Invalid configuration. DEBUG_LEVEL not defined.
 #endif
+#if DEBUG_LEVEL < -1 || DEBUG_LEVEL > 2
+  #error Invalid configuration. Illegal value of DEBUG_LEVEL.
+#endif
 #if !(  defined(MOONPHASE_PRIMARY)  \
       ^ defined(MOONPHASE_ALTERNATIVE))
   #error Invalid configuration. Exactly one moon phase style must be selected.
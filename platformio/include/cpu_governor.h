@@ -0,0 +1,36 @@
+/* CPU frequency governor declarations for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CPU_GOVERNOR_H__
+#define __CPU_GOVERNOR_H__
+
+void initCpuGovernor();
+void boostCpu();
+void releaseCpu();
+void printCpuEnergy();
+
+// Boosts the CPU frequency for the lifetime of the object.
+class CpuBoost
+{
+public:
+  CpuBoost()  { boostCpu(); }
+  ~CpuBoost() { releaseCpu(); }
+  CpuBoost(const CpuBoost &) = delete;
+  CpuBoost &operator=(const CpuBoost &) = delete;
+}; // end class CpuBoost
+
+#endif
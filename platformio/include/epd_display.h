@@ -0,0 +1,209 @@
+/* E-paper display declarations for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __EPD_DISPLAY_H__
+#define __EPD_DISPLAY_H__
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include "config.h"
+#include "frame_diff.h"
+#if CHROME_CACHE
+  #include <FS.h>
+#endif
+
+// The panel driver (GxEPD2) is used for controller I/O only. The frame buffer
+// is owned here, so that the renderer can inspect what it has drawn (e.g. to
+// compare it against the frame that is currently shown on the panel).
+// The page buffer is allocated for each frame, with pages as tall as fit in
+// memory at the time (see EpdDisplay::allocBuffer()).
+#ifdef DISP_BW_V2
+  #include <GxEPD2_BW.h>
+  typedef GxEPD2_750_GDEY075T7 epd_driver_t;
+  #define EPD_FORMAT_BW
+#endif
+#ifdef DISP_3C_B
+  #include <GxEPD2_3C.h>
+  typedef GxEPD2_750c_GDEY075Z08 epd_driver_t;
+  #define EPD_FORMAT_3C
+#endif
+#ifdef DISP_7C_F
+  #include <GxEPD2_7C.h>
+  typedef GxEPD2_730c_GDEY073D46 epd_driver_t;
+  #define EPD_FORMAT_7C
+#endif
+#ifdef DISP_BW_V1
+  #include <GxEPD2_BW.h>
+  typedef GxEPD2_750 epd_driver_t;
+  #define EPD_FORMAT_BW
+#endif
+
+// Bytes per row of a page
+#if defined(EPD_FORMAT_BW) || defined(EPD_FORMAT_3C)
+  #define EPD_ROW_BYTES (epd_driver_t::WIDTH / 8)
+#endif
+#ifdef EPD_FORMAT_7C
+  #define EPD_ROW_BYTES (epd_driver_t::WIDTH / 2)
+#endif
+// Bytes per buffer plane of a whole frame
+#define EPD_FRAME_SIZE (EPD_ROW_BYTES * epd_driver_t::HEIGHT)
+
+// A band of rows of the page buffer. Drawing into a band writes only the
+// buffer bytes of its rows, so disjoint bands of a page can be drawn at the
+// same time. Coordinates are panel coordinates (rotation 0).
+typedef struct epd_band
+{
+  uint8_t *buffer;
+  uint8_t *color_buffer; // 3-color panels only
+  int16_t page_ys;       // first row of the page held by the buffer
+  int16_t ys;            // first row of the band
+  int16_t ye;            // last row of the band
+} epd_band_t;
+
+#if DISPLAY_LIST
+typedef enum dl_op_type : uint8_t
+{
+  DL_PTR,         // sets the font or bitmap of the operations that follow
+  DL_GLYPH,       // arg: character, x,y: cursor
+  DL_PIXELS,      // w: count, h: x step
+  DL_LINE,        // x,y to w,h
+  DL_FILL_RECT,
+  DL_BITMAP,      // inverted bitmap
+  DL_FILL_SCREEN,
+  DL_PATTERN,     // pattern filled rectangle, pattern set by DL_PTR
+  DL_THICK_LINE   // x,y to w,h
+} dl_op_type_t;
+
+// A recorded drawing operation, in the coordinates it was drawn with
+typedef struct dl_op
+{
+  dl_op_type_t type;
+  uint8_t      arg;
+  uint16_t     color;
+  int16_t      x;
+  int16_t      y;
+  union
+  {
+    struct
+    {
+      int16_t w;
+      int16_t h;
+    } size;
+    const void *ptr;
+  };
+} dl_op_t;
+#endif
+
+class EpdDisplay : public Adafruit_GFX
+{
+public:
+  epd_driver_t epd2;
+
+  EpdDisplay(epd_driver_t epd2_instance);
+  void init(uint32_t serial_diag_bitrate, bool initial,
+            uint16_t reset_duration, bool pulldown_rst_mode);
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void fillScreen(uint16_t color) override;
+#if DISPLAY_LIST
+  void writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                 uint16_t color) override;
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                uint16_t color) override;
+  size_t write(uint8_t c) override;
+  using Adafruit_GFX::write;
+#endif
+  void drawInvertedBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+                          int16_t w, int16_t h, uint16_t color);
+  void fillPattern(int16_t x, int16_t y, int16_t w, int16_t h,
+                   const uint8_t pattern[8], uint16_t color);
+  void drawDottedHLine(int16_t x, int16_t y, int16_t w, int16_t step,
+                       uint16_t color);
+  void drawThickLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                     uint16_t color);
+  const GFXfont *getFont() const { return gfxFont; }
+  bool isOnPage(const epd_rect_t &bounds);
+  void setFullWindow();
+  void firstPage();
+  bool nextPage();
+  void powerOff();
+  void hibernate();
+  uint16_t pages() const;
+  bool allocFailed() const;
+  uint16_t pageHeight() const;
+  bool preparePartialRefresh();
+  bool resumePendingRefresh();
+#if CHROME_CACHE
+  bool restoreChrome(uint32_t key);
+  bool saveChrome(uint32_t key, void (*draw)());
+#endif
+
+private:
+  uint8_t *_buffer;
+#ifdef EPD_FORMAT_3C
+  uint8_t *_color_buffer;
+#endif
+  uint8_t *_prev_frame;
+  uint16_t _page_height;
+  uint16_t _pages;
+  uint16_t _current_page;
+  unsigned long _frame_start; // ms
+  bool _partial;
+  bool _fast_full;
+  bool _alloc_failed;   // the last frame could not be drawn
+#if DEBUG_LEVEL >= 1
+  uint8_t _skipped;     // widgets skipped on the current page
+#endif
+#if DISPLAY_LIST
+  dl_op_t *_dl;
+  uint16_t _dl_len;
+  uint16_t _dl_cap;
+  uint8_t _dl_depth;    // nesting of the operation being drawn
+  bool _dl_recording;
+  bool _dl_record_only; // the frame is drawn from the recording alone
+  const void *_dl_ptr;  // pointer set by the last DL_PTR operation
+
+  bool recording() const { return _dl_recording && _dl_depth == 0; }
+  bool drawing() const { return !(_dl_recording && _dl_record_only); }
+  void advanceCursor(uint8_t c);
+  void record(dl_op_t op);
+  void recordPtr(const void *ptr);
+  void recordGlyph(uint8_t c);
+  void freeDisplayList();
+  void replayPage();
+#endif
+#if CHROME_CACHE
+  File _chrome;         // chrome layer being read, one page at a time
+  uint32_t _chrome_key;
+
+  void loadChromePage();
+#endif
+
+  size_t planeSize() const;
+  bool allocPlanes(int16_t page_height, bool psram, size_t reserve);
+  bool allocBuffer();
+  void freeBuffer();
+#if PARTIAL_REFRESH
+  bool loadPrevFrame();
+#endif
+  epd_band_t pageBand();
+  void writePage(int16_t page_ys, int16_t page_h);
+  void refreshFrame();
+}; // end class EpdDisplay
+
+#endif
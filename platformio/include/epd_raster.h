@@ -0,0 +1,48 @@
+/* Page buffer rasterization declarations for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __EPD_RASTER_H__
+#define __EPD_RASTER_H__
+
+#include <cstdint>
+#include <Adafruit_GFX.h>
+#include "config.h"
+#include "epd_display.h"
+
+void rasterFill(const epd_band_t &band, uint16_t color);
+void rasterPixel(const epd_band_t &band, int16_t x, int16_t y, uint16_t color);
+void rasterLine(const epd_band_t &band, int16_t x0, int16_t y0,
+                int16_t x1, int16_t y1, uint16_t color);
+void rasterThickLine(const epd_band_t &band, int16_t x0, int16_t y0,
+                     int16_t x1, int16_t y1, uint16_t color);
+void rasterDottedHLine(const epd_band_t &band, int16_t x, int16_t y,
+                       int16_t w, int16_t step, uint16_t color);
+void rasterRect(const epd_band_t &band, int16_t x, int16_t y,
+                int16_t w, int16_t h, uint16_t color);
+void rasterPattern(const epd_band_t &band, int16_t x, int16_t y,
+                   int16_t w, int16_t h, const uint8_t pattern[8],
+                   uint16_t color);
+void rasterBitmap(const epd_band_t &band, int16_t x, int16_t y,
+                  const uint8_t bitmap[], int16_t w, int16_t h,
+                  uint16_t color);
+void rasterGlyph(const epd_band_t &band, const GFXfont *font, uint8_t c,
+                 int16_t x, int16_t y, uint16_t color);
+#if DISPLAY_LIST
+void rasterOps(const epd_band_t &band, const dl_op_t *ops, uint16_t len);
+#endif
+
+#endif
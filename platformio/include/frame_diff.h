@@ -0,0 +1,41 @@
+/* Frame comparison declarations for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FRAME_DIFF_H__
+#define __FRAME_DIFF_H__
+
+#include <cstdint>
+
+typedef struct epd_rect
+{
+  int16_t x;
+  int16_t y;
+  int16_t w;
+  int16_t h;
+} epd_rect_t;
+
+// Frames are compared in tiles of 64x16px. Tile edges fall on the
+// controller's 8px window alignment.
+#define DIRTY_TILE_BYTES 8
+#define DIRTY_TILE_ROWS  16
+#define DIRTY_MAX_WIDTH  (32 * DIRTY_TILE_BYTES * 8) // px
+
+int findDirtyRects(const uint8_t *prev, const uint8_t *cur,
+                   int16_t width, int16_t height,
+                   epd_rect_t *rects, int max_rects);
+
+#endif
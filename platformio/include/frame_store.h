@@ -0,0 +1,34 @@
+/* Frame storage declarations for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FRAME_STORE_H__
+#define __FRAME_STORE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <FS.h>
+
+bool readPacked(File &file, uint8_t *data, size_t len);
+size_t writePacked(File &file, const uint8_t *data, size_t len);
+bool loadFrame(uint8_t *frame, size_t len);
+bool saveFrame(const uint8_t *frame, size_t len);
+File openChrome(uint32_t key, size_t len);
+File createChrome(uint32_t key, size_t len);
+bool commitChrome(File &file, bool ok);
+void removeChrome();
+
+#endif
@@ -0,0 +1,45 @@
+/* Logging declarations for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __LOGGING_H__
+#define __LOGGING_H__
+
+#include "config.h"
+
+// Each macro logs one line, formatted like printf. The format must be a string
+// literal. Below the macro's DEBUG_LEVEL the arguments are not evaluated, and
+// the message is compiled out, but the format is still checked.
+#define LOG_DISABLED(format, ...) \
+  do { if (0) logPrintf(format, ##__VA_ARGS__); } while (0)
+#if DEBUG_LEVEL >= 0
+  #define LOG_INFO(format, ...) logPrintf(format "\n", ##__VA_ARGS__)
+#else
+  #define LOG_INFO(format, ...) LOG_DISABLED(format, ##__VA_ARGS__)
+#endif
+#if DEBUG_LEVEL >= 1
+  #define LOG_DEBUG(format, ...) \
+    logPrintf("[debug] " format "\n", ##__VA_ARGS__)
+#else
+  #define LOG_DEBUG(format, ...) LOG_DISABLED(format, ##__VA_ARGS__)
+#endif
+
+void initLogging();
+void logPrintf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+void flushLog();
+void printLogStats();
+
+#endif
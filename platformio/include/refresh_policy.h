@@ -0,0 +1,50 @@
+/* Data refresh policy declarations for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __REFRESH_POLICY_H__
+#define __REFRESH_POLICY_H__
+
+#include <cstddef>
+#include <cstdint>
+
+// sections of the weather data, as a bitmask
+#define DATA_CURRENT       (1 << 0) // One Call
+#define DATA_HOURLY        (1 << 1) // One Call
+#define DATA_DAILY         (1 << 2) // One Call
+#define DATA_ALERTS        (1 << 3) // One Call
+#define DATA_AIR_POLLUTION (1 << 4) // Air Pollution
+#define DATA_ONECALL       (DATA_CURRENT | DATA_HOURLY | DATA_DAILY \
+                            | DATA_ALERTS)
+
+typedef struct refresh_policy
+{
+  uint8_t section; // DATA_*
+  int     maxAge;  // minutes, 0 to refresh on every update
+} refresh_policy_t;
+
+// Set the below constants in "config.cpp"
+extern const refresh_policy_t REFRESH_POLICY[];
+extern const size_t NUM_REFRESH_POLICIES;
+extern const int API_CALL_BUDGET;
+
+uint8_t getUsedSections();
+uint8_t getStaleSections(int64_t now);
+void recordApiCall(uint8_t sections, size_t bytes, int64_t now);
+void recordSkippedSections(uint8_t sections);
+void printApiUsage();
+
+#endif
@@ -23,36 +23,27 @@
 #include <time.h>
 #include "api_response.h"
 #include "config.h"
+#include "epd_display.h"
 
 #ifdef DISP_BW_V2
   #define DISP_WIDTH  800
   #define DISP_HEIGHT 480
-  #include <GxEPD2_BW.h>
-  extern GxEPD2_BW<GxEPD2_750_GDEY075T7,
-                   GxEPD2_750_GDEY075T7::HEIGHT> display;
 #endif
 #ifdef DISP_3C_B
   #define DISP_WIDTH  800
   #define DISP_HEIGHT 480
-  #include <GxEPD2_3C.h>
-  extern GxEPD2_3C<GxEPD2_750c_GDEY075Z08,
-                   GxEPD2_750c_GDEY075Z08::HEIGHT / 2> display;
 #endif
 #ifdef DISP_7C_F
   #define DISP_WIDTH  800
   #define DISP_HEIGHT 480
-  #include <GxEPD2_7C.h>
-  extern GxEPD2_7C<GxEPD2_730c_GDEY073D46, 
-                   GxEPD2_730c_GDEY073D46::HEIGHT / 4> display;
 #endif
 #ifdef DISP_BW_V1
   #define DISP_WIDTH  640
   #define DISP_HEIGHT 384
-  #include <GxEPD2_BW.h>
-  extern GxEPD2_BW<GxEPD2_750,
-                   GxEPD2_750::HEIGHT> display;
 #endif
 
+extern EpdDisplay display;
+
 typedef enum alignment
 {
   LEFT,
@@ -60,6 +51,13 @@ typedef enum alignment
   CENTER
 } alignment_t;
 
+// A font for drawFitString(), and the baseline of a single line drawn in it
+typedef struct fit_font
+{
+  const GFXfont *font;
+  int16_t y;
+} fit_font_t;
+
 uint16_t getStringWidth(const String &text);
 uint16_t getStringHeight(const String &text);
 void drawString(int16_t x, int16_t y, const String &text, alignment_t alignment,
@@ -68,8 +66,14 @@ void drawMultiLnString(int16_t x, int16_t y, const String &text,
                        alignment_t alignment, uint16_t max_width,
                        uint16_t max_lines, int16_t line_spacing,
                        uint16_t color=GxEPD_BLACK);
+void drawFitString(int16_t x, const String &text, alignment_t alignment,
+                   int max_width, const fit_font_t *fonts, size_t num_fonts,
+                   int16_t wrap_y, uint16_t max_lines, int16_t line_spacing,
+                   uint16_t color=GxEPD_BLACK);
 void initDisplay();
+bool finishPendingRefresh();
 void powerOffDisplay();
+void restoreChrome();
 void drawCurrentConditions(const owm_current_t &current,
                            const owm_daily_t &today,
                            const owm_resp_air_pollution_t &owm_air_pollution,
@@ -81,7 +85,7 @@ void drawLocationDate(const String &city, const String &date);
 void drawOutlookGraph(const owm_hourly_t *hourly, const owm_daily_t *daily,
                       tm timeInfo);
 void drawStatusBar(const String &statusStr, const String &refreshTimeStr,
-                   int rssi, uint32_t batVoltage);
+                   int rssi, uint32_t batVoltage, bool stale);
 void drawError(const uint8_t *bitmap_196x196,
                const String &errMsgLn1, const String &errMsgLn2="");
 void drawCurrentSunrise(const owm_current_t &current);
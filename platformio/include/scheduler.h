@@ -0,0 +1,64 @@
+/* Sleep scheduler declarations for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <time.h>
+
+// days of the week, as a bitmask indexed by tm_wday
+#define SCHED_SUN      (1 << 0)
+#define SCHED_MON      (1 << 1)
+#define SCHED_TUE      (1 << 2)
+#define SCHED_WED      (1 << 3)
+#define SCHED_THU      (1 << 4)
+#define SCHED_FRI      (1 << 5)
+#define SCHED_SAT      (1 << 6)
+#define SCHED_WEEKDAYS (SCHED_MON | SCHED_TUE | SCHED_WED | SCHED_THU \
+                        | SCHED_FRI)
+#define SCHED_WEEKENDS (SCHED_SAT | SCHED_SUN)
+#define SCHED_EVERYDAY (SCHED_WEEKDAYS | SCHED_WEEKENDS)
+
+typedef enum sched_anchor
+{
+  SCHED_MIDNIGHT,
+  SCHED_SUNRISE,
+  SCHED_SUNSET
+} sched_anchor_t;
+
+typedef struct sleep_rule
+{
+  uint8_t        days;     // days of the week the window starts on
+  sched_anchor_t anchor;   // start and end are relative to this time of day
+  int16_t        start;    // minutes, first update of the window
+  int16_t        end;      // minutes, exclusive
+  uint16_t       interval; // minutes between updates
+} sleep_rule_t;
+
+// Set the below constants in "config.cpp"
+extern const sleep_rule_t SLEEP_RULES[];
+extern const size_t NUM_SLEEP_RULES;
+
+void setSunTimes(time_t sunrise, time_t sunset);
+void setIntervalScale(float scale);
+time_t getNextWakeTime(time_t now, const sleep_rule_t *rules,
+                       size_t numRules);
+time_t getNextWakeTime(time_t now);
+
+#endif
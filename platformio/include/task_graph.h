@@ -0,0 +1,43 @@
+/* Task graph declarations for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TASK_GRAPH_H__
+#define __TASK_GRAPH_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <freertos/FreeRTOS.h>
+
+// Returns the dependency bit of the task at index i of a task graph
+#define TASK_DEP(i) (1UL << (i))
+
+typedef struct graph_task
+{
+  const char *name;
+  void (*run)();
+  uint32_t deps;      // TASK_DEP() of each task that must complete first
+  BaseType_t core;
+  uint32_t stackSize; // bytes
+  // set by runTaskGraph
+  unsigned long start; // ms
+  unsigned long end;   // ms
+} graph_task_t;
+
+void runTaskGraph(graph_task_t *tasks, size_t count);
+void printCriticalPath(const graph_task_t *tasks, size_t count);
+
+#endif
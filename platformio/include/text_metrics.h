@@ -0,0 +1,46 @@
+/* Text metrics declarations for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TEXT_METRICS_H__
+#define __TEXT_METRICS_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <Adafruit_GFX.h>
+
+// Bounding box of text drawn with the cursor at 0,0 (on the baseline)
+typedef struct text_bounds
+{
+  int16_t  x1;
+  int16_t  y1;
+  uint16_t w;
+  uint16_t h;
+} text_bounds_t;
+
+// A line of text, see breakLine()
+typedef struct text_line
+{
+  size_t len;    // characters on the line
+  size_t next;   // start of the next line
+  bool ellipsis; // the line ends with "..."
+} text_line_t;
+
+text_bounds_t measureText(const GFXfont *font, const char *text);
+text_line_t breakLine(const GFXfont *font, const char *text,
+                      uint16_t max_width, bool last_line);
+
+#endif
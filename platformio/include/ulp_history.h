@@ -0,0 +1,51 @@
+/* ULP sample conversion declarations for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ULP_HISTORY_H__
+#define __ULP_HISTORY_H__
+
+#include <cstdint>
+#include <Adafruit_BME280.h>
+
+// Layout of the samples the ULP coprocessor stores in RTC slow memory, in
+// 32-bit words from the start of its data (the ULP only stores 16 bits each):
+//   0             index of the next sample
+//   1             number of samples stored
+//   2 + 2i        raw temperature of sample i (adc_T >> 4)
+//   3 + 2i        raw humidity of sample i
+#define ULP_NUM_SAMPLES 16 // must be a power of 2
+#define ULP_DATA_WORDS  (2 + 2 * ULP_NUM_SAMPLES)
+
+// Indoor conditions over the last sleep, sampled by the ULP coprocessor
+typedef struct indoor_history
+{
+  int   samples;
+  float minTemp;     // Celsius
+  float maxTemp;     // Celsius
+  float tempTrend;   // Celsius per hour
+  float minHumidity; // %
+  float maxHumidity; // %
+} indoor_history_t;
+
+int ulpSampleIndex(uint32_t next, int count, int n);
+float bme280Temperature(const bme280_calib_data &c, int32_t adcT,
+                        int32_t *tFine);
+float bme280Humidity(const bme280_calib_data &c, int32_t adcH, int32_t tFine);
+indoor_history_t convertUlpSamples(const uint32_t *data, uint32_t periodS,
+                                   const bme280_calib_data &c);
+
+#endif
@@ -0,0 +1,41 @@
+/* ULP indoor sensor sampling declarations for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ULP_SENSOR_H__
+#define __ULP_SENSOR_H__
+
+#include "config.h"
+
+#if SENSOR_ULP_SAMPLING
+#include <cstdint>
+#include <Adafruit_BME280.h>
+#include "ulp_history.h"
+
+// Adafruit_BME280 with access to its calibration data, which is needed to
+// convert the raw samples taken by the ULP.
+class UlpBME280 : public Adafruit_BME280
+{
+public:
+  void loadUlpHistory();
+}; // end class UlpBME280
+
+void startUlpSampling(uint64_t sleepDuration);
+void stopUlpSampling();
+const indoor_history_t *getIndoorHistory();
+#endif
+
+#endif
@@ -0,0 +1,64 @@
+/* Weather data cache declarations for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __WEATHER_CACHE_H__
+#define __WEATHER_CACHE_H__
+
+#include <cstdint>
+#include <Arduino.h>
+#include <FS.h>
+#include "api_response.h"
+
+extern const char *AIR_POLLUTION_CACHE_PATH;
+
+// Reads a response from the source stream while saving a copy of it to the
+// cache. The copy only replaces the cached response once committed, so a
+// response that failed to parse is never cached. fetched is the time the
+// response was requested, which orders the cached responses.
+class CacheStream : public Stream
+{
+public:
+  CacheStream(Stream &source, const String &path, int64_t fetched);
+  ~CacheStream();
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t readBytes(char *buffer, size_t length) override;
+  size_t write(uint8_t b) override;
+  bool commit();
+  size_t received() const;
+
+private:
+  Stream &_source;
+  File _file;
+  String _path;
+  uint8_t _buf[256];
+  size_t _len;
+  size_t _received;
+  bool _ok;
+
+  void append(const uint8_t *data, size_t len);
+  bool flushBuffer();
+}; // end class CacheStream
+
+String oneCallCachePath(uint8_t sections);
+void pruneOneCallCache(uint8_t sections);
+bool loadOneCallCache(owm_resp_onecall_t &r, int64_t now, int64_t &dt,
+                      bool shiftCurrent);
+bool loadAirPollutionCache(owm_resp_air_pollution_t &r, int64_t now);
+
+#endif
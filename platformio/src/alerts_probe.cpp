@@ -0,0 +1,110 @@
+/* Alerts probe for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <Arduino.h>
+#include <esp_sleep.h>
+#include "alerts_probe.h"
+#include "config.h"
+
+// Between updates, the esp32 may wake every ALERTS_PROBE_INTERVAL minutes
+// just to request the alerts. The alerts shown on the display are kept as a
+// set of hashes in RTC memory, and only if the alerts received differ is the
+// wake turned into a full update.
+
+// at most this many alerts are remembered, the rest are ignored
+static const int MAX_PROBE_ALERTS = 8;
+
+RTC_DATA_ATTR static bool     probeWake = false;
+RTC_DATA_ATTR static uint8_t  numAlertHashes = 0;
+RTC_DATA_ATTR static uint32_t alertHashes[MAX_PROBE_ALERTS] = {};
+
+/* Returns the 32-bit FNV-1a hash of the data, continuing from hash.
+ */
+static uint32_t fnv1a(uint32_t hash, const void *data, size_t len)
+{
+  const uint8_t *p = static_cast<const uint8_t *>(data);
+  for (size_t i = 0; i < len; ++i)
+  {
+    hash = (hash ^ p[i]) * 16777619UL;
+  }
+  return hash;
+} // end fnv1a
+
+/* Returns a hash identifying an alert, from its event name and time span.
+ */
+static uint32_t hashAlert(const owm_alerts_t &alert)
+{
+  uint32_t hash = 2166136261UL;
+  hash = fnv1a(hash, alert.event.c_str(), alert.event.length());
+  hash = fnv1a(hash, &alert.start, sizeof(alert.start));
+  hash = fnv1a(hash, &alert.end, sizeof(alert.end));
+  return hash;
+} // end hashAlert
+
+/* Computes the sorted set of hashes of the alerts. Returns the number of
+ * hashes.
+ */
+static int hashAlerts(const std::vector<owm_alerts_t> &alerts,
+                      uint32_t hashes[MAX_PROBE_ALERTS])
+{
+  int n = std::min(static_cast<int>(alerts.size()), MAX_PROBE_ALERTS);
+  for (int i = 0; i < n; ++i)
+  {
+    hashes[i] = hashAlert(alerts[i]);
+  }
+  std::sort(hashes, hashes + n);
+  return n;
+} // end hashAlerts
+
+/* Returns the time to wake at: nextUpdate, or the time of an alerts probe if
+ * one is due before. Which of them it is, is remembered for the next wake.
+ */
+time_t scheduleAlertsProbe(time_t now, time_t nextUpdate)
+{
+  const time_t interval = ALERTS_PROBE_INTERVAL * 60;
+  // no probe if the update follows soon after it anyway
+  probeWake = DISPLAY_ALERTS && interval > 0
+              && now + interval <= nextUpdate - interval / 2;
+  return probeWake ? now + interval : nextUpdate;
+} // end scheduleAlertsProbe
+
+/* Returns true if the esp32 woke to probe the alerts, rather than to update
+ * the display.
+ */
+bool isAlertsProbeWake()
+{
+  return probeWake && esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER;
+} // end isAlertsProbeWake
+
+/* Remembers the alerts on the display.
+ */
+void rememberAlerts(const std::vector<owm_alerts_t> &alerts)
+{
+  numAlertHashes = hashAlerts(alerts, alertHashes);
+  return;
+} // end rememberAlerts
+
+/* Returns true if the alerts differ from the alerts on the display.
+ */
+bool alertsChanged(const std::vector<owm_alerts_t> &alerts)
+{
+  uint32_t hashes[MAX_PROBE_ALERTS];
+  const int n = hashAlerts(alerts, hashes);
+  return n != numAlertHashes
+         || !std::equal(hashes, hashes + n, alertHashes);
+} // end alertsChanged
@@ -19,8 +19,9 @@
 #include <ArduinoJson.h>
 #include "api_response.h"
 #include "config.h"
+#include "logging.h"
 
-DeserializationError deserializeOneCall(WiFiClient &json,
+DeserializationError deserializeOneCall(Stream &json,
                                         owm_resp_onecall_t &r)
 {
   int i;
@@ -50,10 +51,7 @@ DeserializationError deserializeOneCall(WiFiClient &json,
 
   DeserializationError error = deserializeJson(doc, json,
                                          DeserializationOption::Filter(filter));
-#if DEBUG_LEVEL >= 1
-  Serial.println("[debug] doc.overflowed() : "
-                 + String(doc.overflowed()));
-#endif
+  LOG_DEBUG("doc.overflowed() : %d", doc.overflowed());
 #if DEBUG_LEVEL >= 2
   serializeJsonPretty(doc, Serial);
 #endif
@@ -66,28 +64,32 @@ DeserializationError deserializeOneCall(WiFiClient &json,
   r.timezone        = doc["timezone"]       .as<const char *>();
   r.timezone_offset = doc["timezone_offset"].as<int>();
 
+  // sections that were excluded from the request are left unchanged
   JsonObject current = doc["current"];
-  r.current.dt         = current["dt"]        .as<int64_t>();
-  r.current.sunrise    = current["sunrise"]   .as<int64_t>();
-  r.current.sunset     = current["sunset"]    .as<int64_t>();
-  r.current.temp       = current["temp"]      .as<float>();
-  r.current.feels_like = current["feels_like"].as<float>();
-  r.current.pressure   = current["pressure"]  .as<int>();
-  r.current.humidity   = current["humidity"]  .as<int>();
-  r.current.dew_point  = current["dew_point"] .as<float>();
-  r.current.clouds     = current["clouds"]    .as<int>();
-  r.current.uvi        = current["uvi"]       .as<float>();
-  r.current.visibility = current["visibility"].as<int>();
-  r.current.wind_speed = current["wind_speed"].as<float>();
-  r.current.wind_gust  = current["wind_gust"] .as<float>();
-  r.current.wind_deg   = current["wind_deg"]  .as<int>();
-  r.current.rain_1h    = current["rain"]["1h"].as<float>();
-  r.current.snow_1h    = current["snow"]["1h"].as<float>();
-  JsonObject current_weather = current["weather"][0];
-  r.current.weather.id          = current_weather["id"]         .as<int>();
-  r.current.weather.main        = current_weather["main"]       .as<const char *>();
-  r.current.weather.description = current_weather["description"].as<const char *>();
-  r.current.weather.icon        = current_weather["icon"]       .as<const char *>();
+  if (!current.isNull())
+  {
+    r.current.dt         = current["dt"]        .as<int64_t>();
+    r.current.sunrise    = current["sunrise"]   .as<int64_t>();
+    r.current.sunset     = current["sunset"]    .as<int64_t>();
+    r.current.temp       = current["temp"]      .as<float>();
+    r.current.feels_like = current["feels_like"].as<float>();
+    r.current.pressure   = current["pressure"]  .as<int>();
+    r.current.humidity   = current["humidity"]  .as<int>();
+    r.current.dew_point  = current["dew_point"] .as<float>();
+    r.current.clouds     = current["clouds"]    .as<int>();
+    r.current.uvi        = current["uvi"]       .as<float>();
+    r.current.visibility = current["visibility"].as<int>();
+    r.current.wind_speed = current["wind_speed"].as<float>();
+    r.current.wind_gust  = current["wind_gust"] .as<float>();
+    r.current.wind_deg   = current["wind_deg"]  .as<int>();
+    r.current.rain_1h    = current["rain"]["1h"].as<float>();
+    r.current.snow_1h    = current["snow"]["1h"].as<float>();
+    JsonObject current_weather = current["weather"][0];
+    r.current.weather.id          = current_weather["id"]         .as<int>();
+    r.current.weather.main        = current_weather["main"]       .as<const char *>();
+    r.current.weather.description = current_weather["description"].as<const char *>();
+    r.current.weather.icon        = current_weather["icon"]       .as<const char *>();
+  }
 
   // minutely forecast is currently unused
   // i = 0;
@@ -204,7 +206,7 @@ DeserializationError deserializeOneCall(WiFiClient &json,
   return error;
 } // end deserializeOneCall
 
-DeserializationError deserializeAirQuality(WiFiClient &json,
+DeserializationError deserializeAirQuality(Stream &json,
                                            owm_resp_air_pollution_t &r)
 {
   int i = 0;
@@ -212,10 +214,7 @@ DeserializationError deserializeAirQuality(WiFiClient &json,
   JsonDocument doc;
 
   DeserializationError error = deserializeJson(doc, json);
-#if DEBUG_LEVEL >= 1
-  Serial.println("[debug] doc.overflowed() : "
-                 + String(doc.overflowed()));
-#endif
+  LOG_DEBUG("doc.overflowed() : %d", doc.overflowed());
 #if DEBUG_LEVEL >= 2
   serializeJsonPretty(doc, Serial);
 #endif
@@ -0,0 +1,185 @@
+/* Battery discharge model for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <Arduino.h>
+#include <Preferences.h>
+#include <time.h>
+#include "battery_model.h"
+#include "config.h"
+#include "logging.h"
+#include "scheduler.h"
+
+// The battery voltage is sampled every few hours into a history kept in NVS.
+// The discharge rate (in percent per day) is the least squares slope of the
+// battery percentage over the history. Nearly all of the energy is spent
+// awake, so the discharge rate is taken to be proportional to the number of
+// wakes, which in turn is inversely proportional to the sleep interval scale.
+
+static const int      BAT_HISTORY_SIZE    = 48;
+static const uint32_t BAT_SAMPLE_INTERVAL = 3 * 3600; // seconds
+// a rise in voltage larger than this means the battery has been charged
+static const uint32_t BAT_CHARGE_DELTA    = 150; // millivolts
+// history needed for an estimate
+static const int      BAT_MIN_SAMPLES     = 3;
+static const uint32_t BAT_MIN_SPAN        = 12 * 3600; // seconds
+// weight of a new target in the moving average of the sleep interval scale,
+// so that the interval changes gradually
+static const float    BAT_SCALE_ALPHA     = 0.25f;
+
+RTC_DATA_ATTR static float intervalScale = 1.0f;
+static float daysRemaining = NAN;
+
+/* Returns battery percentage, rounded to the nearest integer.
+ * Takes a voltage in millivolts and uses a sigmoidal approximation to find an
+ * approximation of the battery life percentage remaining.
+ *
+ * This function contains LGPLv3 code from
+ * <https://github.com/rlogiacco/BatterySense>.
+ *
+ * Symmetric sigmoidal approximation
+ * <https://www.desmos.com/calculator/7m9lu26vpy>
+ *
+ * c - c / (1 + k*x/v)^3
+ */
+uint32_t calcBatPercent(uint32_t v, uint32_t minv, uint32_t maxv)
+{
+  // slow
+  //uint32_t p = 110 - (110 / (1 + pow(1.468 * (v - minv)/(maxv - minv), 6)));
+
+  // steep
+  //uint32_t p = 102 - (102 / (1 + pow(1.621 * (v - minv)/(maxv - minv), 8.1)));
+
+  // normal
+  uint32_t p = 105 - (105 / (1 + pow(1.724 * (v - minv)/(maxv - minv), 5.5)));
+  return p >= 100 ? 100 : p;
+} // end calcBatPercent
+
+/* Returns the least squares slope of battery percentage over the history, in
+ * percent per day.
+ */
+static float dischargeSlope(const bat_sample_t *hist, int n)
+{
+  float sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+  for (int i = 0; i < n; ++i)
+  {
+    float x = (hist[i].time - hist[0].time) / 86400.0f;
+    float y = calcBatPercent(hist[i].millivolts, MIN_BATTERY_VOLTAGE,
+                             MAX_BATTERY_VOLTAGE);
+    sumX  += x;
+    sumY  += y;
+    sumXX += x * x;
+    sumXY += x * y;
+  }
+  float denom = n * sumXX - sumX * sumX;
+  return denom > 0 ? (n * sumXY - sumX * sumY) / denom : 0.0f;
+} // end dischargeSlope
+
+/* Records the battery voltage and updates the estimated runtime remaining.
+ * If BATTERY_TARGET_DAYS is set, the sleep interval is stretched gradually to
+ * make the charge last that long.
+ */
+void updateBatteryModel(Preferences &prefs, uint32_t batteryVoltage,
+                        time_t now)
+{
+  if (now < 1600000000)
+  { // time has never been set
+    return;
+  }
+
+  bat_sample_t hist[BAT_HISTORY_SIZE];
+  int n = prefs.getBytes("batHist", hist, sizeof(hist)) / sizeof(hist[0]);
+  uint32_t chargeTime = prefs.getUInt("batChgTime", 0);
+  if (n == 0 || batteryVoltage > hist[n - 1].millivolts + BAT_CHARGE_DELTA
+   || hist[n - 1].time > now)
+  { // new charge, or the clock was reset
+    n = 0;
+    chargeTime = now;
+    prefs.putUInt("batChgTime", chargeTime);
+    intervalScale = 1.0f;
+  }
+  if (n == 0 || now - hist[n - 1].time >= BAT_SAMPLE_INTERVAL)
+  {
+    if (n == BAT_HISTORY_SIZE)
+    {
+      memmove(hist, hist + 1, sizeof(hist) - sizeof(hist[0]));
+      --n;
+    }
+    hist[n].time = now;
+    hist[n].millivolts = batteryVoltage;
+    hist[n].scale = static_cast<uint16_t>(intervalScale * 100);
+    ++n;
+    prefs.putBytes("batHist", hist, n * sizeof(hist[0]));
+  }
+
+  // discharge rate at a sleep interval scale of 1
+  const float drain = -dischargeSlope(hist, n);
+  float meanScale = 0;
+  for (int i = 0; i < n; ++i)
+  {
+    meanScale += hist[i].scale / 100.0f;
+  }
+  meanScale /= n;
+  const float baseDrain = drain * meanScale;
+  setIntervalScale(intervalScale);
+  if (n < BAT_MIN_SAMPLES || hist[n - 1].time - hist[0].time < BAT_MIN_SPAN
+   || baseDrain <= 0)
+  { // not enough history, or not discharging
+    daysRemaining = NAN;
+    return;
+  }
+
+  const float percent = calcBatPercent(batteryVoltage, MIN_BATTERY_VOLTAGE,
+                                       MAX_BATTERY_VOLTAGE);
+  const float lowPercent = calcBatPercent(LOW_BATTERY_VOLTAGE,
+                                          MIN_BATTERY_VOLTAGE,
+                                          MAX_BATTERY_VOLTAGE);
+  const float remaining = std::max(0.0f, percent - lowPercent);
+  if (BATTERY_TARGET_DAYS > 0)
+  {
+    const float elapsedDays = (now - chargeTime) / 86400.0f;
+    const float targetDays = std::max(1.0f, BATTERY_TARGET_DAYS - elapsedDays);
+    const float maxScale = std::max(1.0f, static_cast<float>(MAX_SLEEP_DURATION)
+                                          / SLEEP_DURATION);
+    float target = remaining > 0 ? baseDrain * targetDays / remaining
+                                 : maxScale;
+    target = std::min(std::max(target, 1.0f), maxScale);
+    intervalScale += BAT_SCALE_ALPHA * (target - intervalScale);
+    setIntervalScale(intervalScale);
+  }
+  daysRemaining = remaining / (baseDrain / intervalScale);
+
+#if DEBUG_LEVEL >= 1
+  // wakes per day at a scale of 1, ignoring bed time
+  const float wakesPerDay = 1440.0f / SLEEP_DURATION;
+  LOG_DEBUG("Battery drain   : %.2f%%/day (%.3f%%/wake)", baseDrain,
+            baseDrain / wakesPerDay);
+  LOG_DEBUG("Battery runtime : %.1f days, interval x%.2f", daysRemaining,
+            intervalScale);
+#endif
+  return;
+} // end updateBatteryModel
+
+/* Returns the estimated number of days until the battery reaches
+ * LOW_BATTERY_VOLTAGE, or NAN if there is not enough history yet.
+ */
+float getBatteryDaysRemaining()
+{
+  return daysRemaining;
+} // end getBatteryDaysRemaining
@@ -16,12 +16,18 @@
  */
 
 // built-in C++ libraries
+#include <algorithm>
 #include <cstring>
 #include <vector>
 
 // arduino/esp32 libraries
 #include <Arduino.h>
+#include <esp_pm.h>
 #include <esp_sntp.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/task.h>
 #include <HTTPClient.h>
 #include <SPI.h>
 #include <time.h>
@@ -37,8 +43,13 @@
 #include "aqi.h"
 #include "client_utils.h"
 #include "config.h"
+#include "cpu_governor.h"
 #include "display_utils.h"
+#include "logging.h"
+#include "refresh_policy.h"
 #include "renderer.h"
+#include "rtc_drift.h"
+#include "weather_cache.h"
 #ifndef USE_HTTP
   #include <WiFiClientSecure.h>
 #endif
@@ -49,6 +60,93 @@
   static const uint16_t OWM_PORT = 443;
 #endif
 
+// Network events are waited on through an event group, so that the CPU idles
+// while the radio is busy, instead of polling.
+static EventGroupHandle_t netEvents = nullptr;
+static const EventBits_t WIFI_GOT_IP_BIT = 1 << 0;
+static const EventBits_t SNTP_SYNC_BIT   = 1 << 1;
+
+/* Returns the event group for network events, creating it on first use.
+ */
+static EventGroupHandle_t getNetEvents()
+{
+  if (netEvents == nullptr)
+  {
+    netEvents = xEventGroupCreate();
+  }
+  return netEvents;
+} // end getNetEvents
+
+/* Called by the WiFi driver once an IP address has been assigned.
+ */
+static void onWiFiGotIP(WiFiEvent_t event, WiFiEventInfo_t info)
+{
+  xEventGroupSetBits(getNetEvents(), WIFI_GOT_IP_BIT);
+} // end onWiFiGotIP
+
+/* Called by the SNTP client once the system time has been synchronized.
+ */
+static void onSNTPSync(struct timeval *tv)
+{
+  recordTimeSync(tv);
+  xEventGroupSetBits(getNetEvents(), SNTP_SYNC_BIT);
+} // end onSNTPSync
+
+/* Allows the esp32 to automatically enter light sleep while all tasks are
+ * blocked. This needs a framework built with power management
+ * (CONFIG_PM_ENABLE) and tickless idle. The stock Arduino framework is built
+ * without them, so there the CPU stays awake in the idle task instead.
+ *
+ * Returns true if light sleep is allowed.
+ */
+static bool allowLightSleep(bool enable)
+{
+#ifdef CONFIG_PM_ENABLE
+  esp_pm_config_esp32_t pmConfig = {};
+  pmConfig.max_freq_mhz = getCpuFrequencyMhz();
+  pmConfig.min_freq_mhz = getCpuFrequencyMhz();
+  pmConfig.light_sleep_enable = enable;
+  return esp_pm_configure(&pmConfig) == ESP_OK && enable;
+#else
+  return false;
+#endif
+} // end allowLightSleep
+
+/* Blocks until any of the given network event bits is set, or until timeout
+ * milliseconds have passed. Light sleep is allowed while blocked, where the
+ * framework supports it (see allowLightSleep()).
+ *
+ * With DEBUG_LEVEL >= 1 the length of the wait is printed, whether the esp32
+ * could light sleep during it, and the fraction of the wait that this core was
+ * awake, i.e. not in its idle task, where light sleep is entered. The fraction
+ * needs FreeRTOS run time stats (configGENERATE_RUN_TIME_STATS).
+ */
+static void waitForNetEvent(EventBits_t bits, unsigned long timeout)
+{
+  const int64_t startTime = esp_timer_get_time();
+#if DEBUG_LEVEL >= 1 && configGENERATE_RUN_TIME_STATS
+  const uint32_t idleStart = ulTaskGetIdleRunTimeCounter();
+  const uint32_t runStart = portGET_RUN_TIME_COUNTER_VALUE();
+#endif
+  const bool lightSleep = allowLightSleep(true);
+  xEventGroupWaitBits(getNetEvents(), bits, pdFALSE, pdFALSE,
+                      pdMS_TO_TICKS(timeout));
+  allowLightSleep(false);
+  const unsigned long waitMs = (esp_timer_get_time() - startTime) / 1000;
+#if DEBUG_LEVEL >= 1 && configGENERATE_RUN_TIME_STATS
+  const uint32_t run = portGET_RUN_TIME_COUNTER_VALUE() - runStart;
+  const uint32_t idle = std::min(ulTaskGetIdleRunTimeCounter() - idleStart,
+                                 run);
+  LOG_DEBUG("Network wait    : %lums, CPU awake %.1f%% (light sleep %s)",
+            waitMs, run > 0 ? 100.0f * (run - idle) / run : 0.0f,
+            lightSleep ? "on" : "unavailable");
+#else
+  LOG_DEBUG("Network wait    : %lums, CPU awake n/a (light sleep %s)",
+            waitMs, lightSleep ? "on" : "unavailable");
+#endif
+  return;
+} // end waitForNetEvent
+
 /* Power-on and connect WiFi.
  * Takes int parameter to store WiFi RSSI, or “Received Signal Strength
  * Indicator"
@@ -57,31 +155,27 @@
  */
 wl_status_t startWiFi(int &wifiRSSI)
 {
+  xEventGroupClearBits(getNetEvents(), WIFI_GOT_IP_BIT);
+  wifi_event_id_t eventId = WiFi.onEvent(onWiFiGotIP,
+                                         ARDUINO_EVENT_WIFI_STA_GOT_IP);
   WiFi.mode(WIFI_STA);
-  Serial.printf("%s '%s'", TXT_CONNECTING_TO, WIFI_SSID);
+  LOG_INFO("%s '%s'", TXT_CONNECTING_TO, WIFI_SSID);
   WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
 
   // timeout if WiFi does not connect in WIFI_TIMEOUT ms from now
-  unsigned long timeout = millis() + WIFI_TIMEOUT;
+  waitForNetEvent(WIFI_GOT_IP_BIT, WIFI_TIMEOUT);
+  WiFi.removeEvent(eventId);
   wl_status_t connection_status = WiFi.status();
 
-  while ((connection_status != WL_CONNECTED) && (millis() < timeout))
-  {
-    Serial.print(".");
-    delay(50);
-    connection_status = WiFi.status();
-  }
-  Serial.println();
-
   if (connection_status == WL_CONNECTED)
   {
     wifiRSSI = WiFi.RSSI(); // get WiFi signal strength now, because the WiFi
                             // will be turned off to save power!
-    Serial.println("IP: " + WiFi.localIP().toString());
+    LOG_INFO("IP: %s", WiFi.localIP().toString().c_str());
   }
   else
   {
-    Serial.printf("%s '%s'\n", TXT_COULD_NOT_CONNECT_TO, WIFI_SSID);
+    LOG_INFO("%s '%s'", TXT_COULD_NOT_CONNECT_TO, WIFI_SSID);
   }
   return connection_status;
 } // startWiFi
@@ -103,10 +197,14 @@ bool printLocalTime(tm *timeInfo)
   int attempts = 0;
   while (!getLocalTime(timeInfo) && attempts++ < 3)
   {
-    Serial.println(TXT_FAILED_TO_GET_TIME);
+    LOG_INFO("%s", TXT_FAILED_TO_GET_TIME);
     return false;
   }
-  Serial.println(timeInfo, "%A, %B %d, %Y %H:%M:%S");
+#if DEBUG_LEVEL >= 0
+  char timeStr[64];
+  strftime(timeStr, sizeof(timeStr), "%A, %B %d, %Y %H:%M:%S", timeInfo);
+  LOG_INFO("%s", timeStr);
+#endif
   return true;
 } // printLocalTime
 
@@ -119,34 +217,48 @@ bool printLocalTime(tm *timeInfo)
  */
 bool waitForSNTPSync(tm *timeInfo)
 {
-  // Wait for SNTP synchronization to complete
-  unsigned long timeout = millis() + NTP_TIMEOUT;
-  if ((sntp_get_sync_status() == SNTP_SYNC_STATUS_RESET)
-      && (millis() < timeout))
+  xEventGroupClearBits(getNetEvents(), SNTP_SYNC_BIT);
+  sntp_set_time_sync_notification_cb(onSNTPSync);
+  // Wait for SNTP synchronization to complete. The callback is registered
+  // first, so a sync that completes in between is still seen.
+  if (sntp_get_sync_status() == SNTP_SYNC_STATUS_RESET)
   {
-    Serial.print(TXT_WAITING_FOR_SNTP);
-    delay(100); // ms
-    while ((sntp_get_sync_status() == SNTP_SYNC_STATUS_RESET)
-        && (millis() < timeout))
-    {
-      Serial.print(".");
-      delay(100); // ms
-    }
-    Serial.println();
+    LOG_INFO("%s", TXT_WAITING_FOR_SNTP);
+    waitForNetEvent(SNTP_SYNC_BIT, NTP_TIMEOUT);
   }
+  sntp_set_time_sync_notification_cb(nullptr);
   return printLocalTime(timeInfo);
 } // waitForSNTPSync
 
-/* Perform an HTTP GET request to OpenWeatherMap's "One Call" API
- * If data is received, it will be parsed and stored in the global variable
- * owm_onecall.
+/* Connects the client to the API server with the CPU boosted, as the TLS
+ * handshake is CPU bound. HTTPClient then reuses the connection, so that the
+ * request and the wait for the response run at the base frequency.
+ *
+ * Returns true if connected.
+ */
+#ifdef USE_HTTP
+  static bool connectBoosted(WiFiClient &client)
+#else
+  static bool connectBoosted(WiFiClientSecure &client)
+#endif
+{
+  CpuBoost boost;
+  return client.connect(OWM_ENDPOINT.c_str(), OWM_PORT,
+                        HTTP_CLIENT_TCP_TIMEOUT);
+} // end connectBoosted
+
+/* Perform an HTTP GET request to OpenWeatherMap's "One Call" API for the given
+ * sections (DATA_*). If data is received, it will be parsed and stored in the
+ * global variable owm_onecall, leaving the other sections unchanged.
  *
  * Returns the HTTP Status Code.
  */
 #ifdef USE_HTTP
-  int getOWMonecall(WiFiClient &client, owm_resp_onecall_t &r)
+  int getOWMonecall(WiFiClient &client, owm_resp_onecall_t &r,
+                    uint8_t sections)
 #else
-  int getOWMonecall(WiFiClientSecure &client, owm_resp_onecall_t &r)
+  int getOWMonecall(WiFiClientSecure &client, owm_resp_onecall_t &r,
+                    uint8_t sections)
 #endif
 {
   int attempts = 0;
@@ -155,10 +267,100 @@ bool waitForSNTPSync(tm *timeInfo)
   String uri = "/data/" + OWM_ONECALL_VERSION
                + "/onecall?lat=" + LAT + "&lon=" + LON + "&lang=" + OWM_LANG
                + "&units=standard&exclude=minutely";
-#if !DISPLAY_ALERTS
-  // exclude alerts
-  uri += ",alerts";
+  // exclude the sections that are still fresh in the cache
+  if (!(sections & DATA_CURRENT))
+  {
+    uri += ",current";
+  }
+  if (!(sections & DATA_HOURLY))
+  {
+    uri += ",hourly";
+  }
+  if (!(sections & DATA_DAILY))
+  {
+    uri += ",daily";
+  }
+  if (!(sections & DATA_ALERTS))
+  {
+    uri += ",alerts";
+  }
+
+  // This string is printed to terminal to help with debugging. The API key is
+  // censored to reduce the risk of users exposing their key.
+  String sanitizedUri = OWM_ENDPOINT + uri + "&appid={API key}";
+
+  uri += "&appid=" + OWM_APIKEY;
+
+  LOG_INFO("%s: %s", TXT_ATTEMPTING_HTTP_REQ, sanitizedUri.c_str());
+  int httpResponse = 0;
+  while (!rxSuccess && attempts < 3)
+  {
+    wl_status_t connection_status = WiFi.status();
+    if (connection_status != WL_CONNECTED)
+    {
+      // -512 offset distinguishes these errors from httpClient errors
+      return -512 - static_cast<int>(connection_status);
+    }
+
+    HTTPClient http;
+    http.setConnectTimeout(HTTP_CLIENT_TCP_TIMEOUT); // default 5000ms
+    http.setTimeout(HTTP_CLIENT_TCP_TIMEOUT); // default 5000ms
+    http.begin(client, OWM_ENDPOINT, OWM_PORT, uri);
+    httpResponse = connectBoosted(client) ? http.GET()
+                                          : HTTPC_ERROR_CONNECTION_REFUSED;
+    if (httpResponse == HTTP_CODE_OK)
+    {
+      CpuBoost boost; // parsing is CPU bound
+      CacheStream stream(http.getStream(), oneCallCachePath(sections),
+                         time(nullptr));
+      if (sections & DATA_ALERTS)
+      {
+        r.alerts.clear();
+      }
+      jsonErr = deserializeOneCall(stream, r);
+      if (jsonErr)
+      {
+        // -256 offset distinguishes these errors from httpClient errors
+        httpResponse = -256 - static_cast<int>(jsonErr.code());
+      }
+      else
+      {
+        if (stream.commit())
+        {
+          pruneOneCallCache(sections);
+        }
+        recordApiCall(sections, stream.received(), time(nullptr));
+      }
+      rxSuccess = !jsonErr;
+    }
+    client.stop();
+    http.end();
+    LOG_INFO("  %d %s", httpResponse,
+             getHttpResponsePhrase(httpResponse));
+    ++attempts;
+  }
+
+  return httpResponse;
+} // getOWMonecall
+
+/* Perform an HTTP GET request to OpenWeatherMap's "One Call" API for only the
+ * weather alerts. If data is received, only r.alerts is meaningful. The
+ * response is not cached.
+ *
+ * Returns the HTTP Status Code.
+ */
+#ifdef USE_HTTP
+  int getOWMalerts(WiFiClient &client, owm_resp_onecall_t &r)
+#else
+  int getOWMalerts(WiFiClientSecure &client, owm_resp_onecall_t &r)
 #endif
+{
+  int attempts = 0;
+  bool rxSuccess = false;
+  DeserializationError jsonErr = {};
+  String uri = "/data/" + OWM_ONECALL_VERSION
+               + "/onecall?lat=" + LAT + "&lon=" + LON + "&lang=" + OWM_LANG
+               + "&units=standard&exclude=current,minutely,hourly,daily";
 
   // This string is printed to terminal to help with debugging. The API key is
   // censored to reduce the risk of users exposing their key.
@@ -166,8 +368,7 @@ bool waitForSNTPSync(tm *timeInfo)
 
   uri += "&appid=" + OWM_APIKEY;
 
-  Serial.print(TXT_ATTEMPTING_HTTP_REQ);
-  Serial.println(": " + sanitizedUri);
+  LOG_INFO("%s: %s", TXT_ATTEMPTING_HTTP_REQ, sanitizedUri.c_str());
   int httpResponse = 0;
   while (!rxSuccess && attempts < 3)
   {
@@ -182,26 +383,33 @@ bool waitForSNTPSync(tm *timeInfo)
     http.setConnectTimeout(HTTP_CLIENT_TCP_TIMEOUT); // default 5000ms
     http.setTimeout(HTTP_CLIENT_TCP_TIMEOUT); // default 5000ms
     http.begin(client, OWM_ENDPOINT, OWM_PORT, uri);
-    httpResponse = http.GET();
+    httpResponse = connectBoosted(client) ? http.GET()
+                                          : HTTPC_ERROR_CONNECTION_REFUSED;
     if (httpResponse == HTTP_CODE_OK)
     {
+      CpuBoost boost; // parsing is CPU bound
+      r.alerts.clear();
       jsonErr = deserializeOneCall(http.getStream(), r);
       if (jsonErr)
       {
         // -256 offset distinguishes these errors from httpClient errors
         httpResponse = -256 - static_cast<int>(jsonErr.code());
       }
+      else
+      {
+        recordApiCall(0, std::max(http.getSize(), 0), time(nullptr));
+      }
       rxSuccess = !jsonErr;
     }
     client.stop();
     http.end();
-    Serial.println("  " + String(httpResponse, DEC) + " "
-                   + getHttpResponsePhrase(httpResponse));
+    LOG_INFO("  %d %s", httpResponse,
+             getHttpResponsePhrase(httpResponse));
     ++attempts;
   }
 
   return httpResponse;
-} // getOWMonecall
+} // getOWMalerts
 
 /* Perform an HTTP GET request to OpenWeatherMap's "Air Pollution" API
  * If data is received, it will be parsed and stored in the global variable
@@ -239,8 +447,7 @@ bool waitForSNTPSync(tm *timeInfo)
                + "&start=" + startStr + "&end=" + endStr
                + "&appid={API key}";
 
-  Serial.print(TXT_ATTEMPTING_HTTP_REQ);
-  Serial.println(": " + sanitizedUri);
+  LOG_INFO("%s: %s", TXT_ATTEMPTING_HTTP_REQ, sanitizedUri.c_str());
   int httpResponse = 0;
   while (!rxSuccess && attempts < 3)
   {
@@ -255,21 +462,30 @@ bool waitForSNTPSync(tm *timeInfo)
     http.setConnectTimeout(HTTP_CLIENT_TCP_TIMEOUT); // default 5000ms
     http.setTimeout(HTTP_CLIENT_TCP_TIMEOUT); // default 5000ms
     http.begin(client, OWM_ENDPOINT, OWM_PORT, uri);
-    httpResponse = http.GET();
+    httpResponse = connectBoosted(client) ? http.GET()
+                                          : HTTPC_ERROR_CONNECTION_REFUSED;
     if (httpResponse == HTTP_CODE_OK)
     {
-      jsonErr = deserializeAirQuality(http.getStream(), r);
+      CpuBoost boost; // parsing is CPU bound
+      CacheStream stream(http.getStream(), AIR_POLLUTION_CACHE_PATH,
+                         time(nullptr));
+      jsonErr = deserializeAirQuality(stream, r);
       if (jsonErr)
       {
         // -256 offset to distinguishes these errors from httpClient errors
         httpResponse = -256 - static_cast<int>(jsonErr.code());
       }
+      else
+      {
+        stream.commit();
+        recordApiCall(DATA_AIR_POLLUTION, stream.received(), time(nullptr));
+      }
       rxSuccess = !jsonErr;
     }
     client.stop();
     http.end();
-    Serial.println("  " + String(httpResponse, DEC) + " "
-                   + getHttpResponsePhrase(httpResponse));
+    LOG_INFO("  %d %s", httpResponse,
+             getHttpResponsePhrase(httpResponse));
     ++attempts;
   }
 
@@ -279,14 +495,10 @@ bool waitForSNTPSync(tm *timeInfo)
 /* Prints debug information about heap usage.
  */
 void printHeapUsage() {
-  Serial.println("[debug] Heap Size       : "
-                 + String(ESP.getHeapSize()) + " B");
-  Serial.println("[debug] Available Heap  : "
-                 + String(ESP.getFreeHeap()) + " B");
-  Serial.println("[debug] Min Free Heap   : "
-                 + String(ESP.getMinFreeHeap()) + " B");
-  Serial.println("[debug] Max Allocatable : "
-                 + String(ESP.getMaxAllocHeap()) + " B");
+  LOG_DEBUG("Heap Size       : %u B", ESP.getHeapSize());
+  LOG_DEBUG("Available Heap  : %u B", ESP.getFreeHeap());
+  LOG_DEBUG("Min Free Heap   : %u B", ESP.getMinFreeHeap());
+  LOG_DEBUG("Max Allocatable : %u B", ESP.getMaxAllocHeap());
   return;
 }
 
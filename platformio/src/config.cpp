@@ -17,6 +17,8 @@
 
 #include <Arduino.h>
 #include "config.h"
+#include "refresh_policy.h"
+#include "scheduler.h"
 
 // PINS
 // The configuration below is intended for use with the project's official 
@@ -134,10 +136,91 @@ const int WAKE_TIME = 06; // Hour of first update after BED_TIME, 06:00.
 // SLEEP_DURATION = 1440, and you can set the time it should update each day by
 // setting both BED_TIME and WAKE_TIME to the hour you want it to update.
 
+// SLEEP SCHEDULE
+// Update windows. Each rule applies to the days of the week (SCHED_*) on
+// which its window begins. Within the window, updates are made every interval
+// minutes, starting at start. start and end are in minutes after the anchor:
+// local midnight (SCHED_MIDNIGHT), or today's sunrise/sunset (SCHED_SUNRISE,
+// SCHED_SUNSET). end is exclusive and may be on the next day; if start == end
+// the window lasts the whole day. When several windows overlap, the earliest
+// update of any of them is used.
+// The first rule is the schedule described by SLEEP_DURATION, BED_TIME and
+// WAKE_TIME above. For example, add
+//   {SCHED_WEEKENDS, SCHED_MIDNIGHT, 8 * 60, 23 * 60, 60},
+// for hourly updates on weekends (alongside, not instead of the first rule),
+// or
+//   {SCHED_EVERYDAY, SCHED_SUNRISE, -30, 60, 10},
+// for updates every 10 minutes around sunrise.
+const sleep_rule_t SLEEP_RULES[] = {
+  {SCHED_EVERYDAY, SCHED_MIDNIGHT, WAKE_TIME * 60, BED_TIME * 60,
+   SLEEP_DURATION},
+};
+const size_t NUM_SLEEP_RULES = sizeof(SLEEP_RULES) / sizeof(SLEEP_RULES[0]);
+
 // HOURLY OUTLOOK GRAPH
 // Number of hours to display on the outlook graph. (range: [8-48])
 const int HOURLY_GRAPH_MAX = 24;
 
+// PARTIAL REFRESH
+// Maximum number of consecutive partial refreshes before a full refresh is made
+// to clear ghosting. Only used if PARTIAL_REFRESH is enabled in config.h.
+// For example, with SLEEP_DURATION = 30 and PARTIAL_REFRESH_LIMIT = 7 the
+// panel gets a full refresh every 4 hours. (range: [0-65535])
+const int PARTIAL_REFRESH_LIMIT = 7;
+
+// FAST FULL REFRESH
+// Number of consecutive fast full refreshes before a standard full refresh is
+// made to clean the panel. Only used if FAST_FULL_REFRESH is enabled in
+// config.h.
+// For example, with SLEEP_DURATION = 30 and FAST_FULL_REFRESH_LIMIT = 11 the
+// panel gets a standard full refresh every 6 hours. (range: [0-65534])
+const int FAST_FULL_REFRESH_LIMIT = 11;
+
+// OFFLINE CACHE
+// The last weather data received is kept in flash. If WiFi, time
+// synchronization or an API request fails, the display is drawn from this data
+// (shifted to the current time) instead of an error screen, as long as the
+// data is no older than CACHE_MAX_AGE. The status bar shows the error and when
+// the data was received. Set to 0 to disable. (range: [0-24])
+const int CACHE_MAX_AGE = 6; // hours
+
+// REFRESH POLICY
+// Sections of the weather data that change slowly don't need to be requested
+// on every update. Each section is requested again once it is older than its
+// maximum age (0 = on every update); until then it is taken from the offline
+// cache. Requesting fewer One Call sections saves bandwidth and energy; when
+// the Air Pollution history is fresh the request is skipped, saving an API
+// call. Sections are always requested if CACHE_MAX_AGE is 0.
+// By default every section is requested on every update. To enable the policy,
+// raise the maximum ages of the sections that can be shown a little out of
+// date, e.g. 60 for DATA_HOURLY and DATA_AIR_POLLUTION, and 360 for
+// DATA_DAILY. The maximum ages should not exceed CACHE_MAX_AGE (in hours).
+const refresh_policy_t REFRESH_POLICY[] = {
+  // section           max age (minutes)
+  {DATA_CURRENT,         0},
+  {DATA_HOURLY,          0},
+  {DATA_DAILY,           0},
+  {DATA_ALERTS,          0},
+  {DATA_AIR_POLLUTION,   0},
+};
+const size_t NUM_REFRESH_POLICIES = sizeof(REFRESH_POLICY)
+                                    / sizeof(REFRESH_POLICY[0]);
+// Once this many API calls have been made in a day (UTC), the display is drawn
+// from the cache, as long as it is no older than CACHE_MAX_AGE, until the next
+// day. Set to 0 for no limit.
+// Note: The free tier of OpenWeatherMap's One Call API 3.0 allows 1000 calls
+//       per day.
+const int API_CALL_BUDGET = 900; // calls per day
+
+// ALERTS PROBE
+// Between updates, the esp32 can wake every ALERTS_PROBE_INTERVAL minutes just
+// to check for new weather alerts. These probe wakes only request the alerts
+// and skip time synchronization and the display, so they cost a fraction of
+// an update. If the alerts have changed, the display is updated immediately.
+// Only used if DISPLAY_ALERTS is enabled in config.h. Set to 0 to disable.
+// Note: Each probe counts as an API call. (range: [0-1440])
+const int ALERTS_PROBE_INTERVAL = 0; // minutes
+
 // BATTERY
 // To protect the battery upon LOW_BATTERY_VOLTAGE, the display will cease to
 // update until battery is charged again. The ESP32 will deep-sleep (consuming
@@ -154,9 +237,19 @@ const unsigned long VERY_LOW_BATTERY_SLEEP_INTERVAL = 120; // (minutes)
 // Battery voltage calculations are based on a typical 3.7v LiPo.
 const uint32_t MAX_BATTERY_VOLTAGE = 4200; // (millivolts)
 const uint32_t MIN_BATTERY_VOLTAGE = 3000; // (millivolts)
+// Battery runtime target. The battery voltage is recorded every few hours to
+// estimate how fast the battery is discharging. If a charge would not last
+// BATTERY_TARGET_DAYS (counted from when the battery was last charged) the
+// sleep intervals are gradually stretched, up to MAX_SLEEP_DURATION, to make
+// it last. Set to 0 to always update at the configured intervals.
+const int BATTERY_TARGET_DAYS = 0;  // (days)
+const int MAX_SLEEP_DURATION  = 120; // (minutes)
 
 // See config.h for the below options
 // E-PAPER PANEL
+// PARTIAL REFRESH
+// FAST FULL REFRESH
+// SLEEP DURING REFRESH
 // LOCALE
 // UNITS
 // WIND ICON PRECISION
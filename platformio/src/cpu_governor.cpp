@@ -0,0 +1,144 @@
+/* CPU frequency governor for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "config.h"
+#include "cpu_governor.h"
+#include "logging.h"
+
+// The CPU frequency is shared by both cores, so boosts are counted: the CPU
+// runs at CPU_BOOST_FREQ_MHZ while any task holds a boost. The APB clock stays
+// at 80MHz at any of these frequencies, so peripherals are unaffected.
+
+// Typical current of the esp32 with both cores active and the radio off, by
+// CPU frequency, from the datasheet. The radio draws the same current whatever
+// the frequency, so it is left out of the estimates.
+static const float CPU_CURRENT_80MHZ  = 25.0f; // mA
+static const float CPU_CURRENT_160MHZ = 40.0f; // mA
+static const float CPU_CURRENT_240MHZ = 60.0f; // mA
+static const float CPU_SUPPLY_VOLTAGE = 3.3f;  // V
+
+static SemaphoreHandle_t governorMutex = nullptr;
+static uint32_t baseFreqMhz = 0;
+static int      boostCount  = 0;
+static int64_t  boostStart  = 0; // us
+static int64_t  boostedUs   = 0;
+
+/* Returns the typical current drawn at the given CPU frequency, in mA.
+ */
+static float cpuCurrent(uint32_t freqMhz)
+{
+  if (freqMhz >= 240)
+  {
+    return CPU_CURRENT_240MHZ;
+  }
+  if (freqMhz >= 160)
+  {
+    return CPU_CURRENT_160MHZ;
+  }
+  return CPU_CURRENT_80MHZ;
+} // end cpuCurrent
+
+/* Returns true if boosting raises the CPU frequency.
+ */
+static bool boostEnabled()
+{
+  return governorMutex != nullptr
+         && static_cast<uint32_t>(CPU_BOOST_FREQ_MHZ) > baseFreqMhz;
+} // end boostEnabled
+
+/* Records the base CPU frequency. Must be called before any task boosts the
+ * CPU.
+ */
+void initCpuGovernor()
+{
+  baseFreqMhz = getCpuFrequencyMhz();
+  governorMutex = xSemaphoreCreateMutex();
+  return;
+} // end initCpuGovernor
+
+/* Raises the CPU frequency to CPU_BOOST_FREQ_MHZ until the matching call to
+ * releaseCpu().
+ */
+void boostCpu()
+{
+  if (!boostEnabled())
+  {
+    return;
+  }
+  xSemaphoreTake(governorMutex, portMAX_DELAY);
+  if (boostCount++ == 0)
+  {
+    setCpuFrequencyMhz(CPU_BOOST_FREQ_MHZ);
+    boostStart = esp_timer_get_time();
+  }
+  xSemaphoreGive(governorMutex);
+  return;
+} // end boostCpu
+
+/* Returns the CPU to its base frequency, once no task holds a boost.
+ */
+void releaseCpu()
+{
+  if (!boostEnabled())
+  {
+    return;
+  }
+  xSemaphoreTake(governorMutex, portMAX_DELAY);
+  if (boostCount > 0 && --boostCount == 0)
+  {
+    boostedUs += esp_timer_get_time() - boostStart;
+    setCpuFrequencyMhz(baseFreqMhz);
+  }
+  xSemaphoreGive(governorMutex);
+  return;
+} // end releaseCpu
+
+/* Prints an estimate of the energy used by the CPU since boot, and what it
+ * would have been at the base or the boost frequency alone. The boosted parts
+ * are assumed to be CPU bound, taking longer in proportion at the base
+ * frequency, and the rest to take as long at either frequency.
+ */
+void printCpuEnergy()
+{
+#if DEBUG_LEVEL >= 1
+  const float total = esp_timer_get_time() / 1e6f; // s
+  const float boosted = boostedUs / 1e6f;          // s
+  const uint32_t boostMhz = std::max<uint32_t>(CPU_BOOST_FREQ_MHZ,
+                                               baseFreqMhz);
+  const float baseI  = cpuCurrent(baseFreqMhz);
+  const float boostI = cpuCurrent(boostMhz);
+  // mA * s * V = mJ
+  const float actual = (boostI * boosted + baseI * (total - boosted))
+                       * CPU_SUPPLY_VOLTAGE;
+  const float baseOnly = baseI * (total - boosted
+                                  + boosted * boostMhz / baseFreqMhz)
+                         * CPU_SUPPLY_VOLTAGE;
+  const float boostOnly = boostI * total * CPU_SUPPLY_VOLTAGE;
+  LOG_DEBUG("CPU boosted     : %lums at %uMHz",
+            static_cast<unsigned long>(boostedUs / 1000),
+            static_cast<unsigned>(boostMhz));
+  LOG_DEBUG("CPU energy      : %.0fmJ (%uMHz only %.0fmJ, %uMHz only %.0fmJ)",
+            actual, static_cast<unsigned>(baseFreqMhz), baseOnly,
+            static_cast<unsigned>(boostMhz), boostOnly);
+#endif
+  return;
+} // end printCpuEnergy
@@ -28,6 +28,7 @@
 #include "api_response.h"
 #include "config.h"
 #include "display_utils.h"
+#include "logging.h"
 
 // icon header files
 #include "icons/icons.h"
@@ -54,15 +55,15 @@ uint32_t readBatteryVoltage()
 #if DEBUG_LEVEL >= 1
   if (val_type == ESP_ADC_CAL_VAL_EFUSE_VREF)
   {
-    Serial.println("[debug] ADC Cal eFuse Vref");
+    LOG_DEBUG("ADC Cal eFuse Vref");
   }
   else if (val_type == ESP_ADC_CAL_VAL_EFUSE_TP)
   {
-    Serial.println("[debug] ADC Cal Two Point");
+    LOG_DEBUG("ADC Cal Two Point");
   }
   else
   {
-    Serial.println("[debug] ADC Cal Default");
+    LOG_DEBUG("ADC Cal Default");
   }
 #endif
 
@@ -73,31 +74,6 @@ uint32_t readBatteryVoltage()
   return batteryVoltage;
 } // end readBatteryVoltage
 
-/* Returns battery percentage, rounded to the nearest integer.
- * Takes a voltage in millivolts and uses a sigmoidal approximation to find an
- * approximation of the battery life percentage remaining.
- *
- * This function contains LGPLv3 code from
- * <https://github.com/rlogiacco/BatterySense>.
- *
- * Symmetric sigmoidal approximation
- * <https://www.desmos.com/calculator/7m9lu26vpy>
- *
- * c - c / (1 + k*x/v)^3
- */
-uint32_t calcBatPercent(uint32_t v, uint32_t minv, uint32_t maxv)
-{
-  // slow
-  //uint32_t p = 110 - (110 / (1 + pow(1.468 * (v - minv)/(maxv - minv), 6)));
-
-  // steep
-  //uint32_t p = 102 - (102 / (1 + pow(1.621 * (v - minv)/(maxv - minv), 8.1)));
-
-  // normal
-  uint32_t p = 105 - (105 / (1 + pow(1.724 * (v - minv)/(maxv - minv), 5.5)));
-  return p >= 100 ? 100 : p;
-} // end calcBatPercent
-
 /* Returns 24x24 bitmap incidcating battery status.
  */
 const uint8_t *getBatBitmap24(uint32_t batPercent)
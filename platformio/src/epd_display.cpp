@@ -0,0 +1,1416 @@
+/* E-paper display for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <Arduino.h>
+#include <driver/gpio.h>
+#include <driver/rtc_io.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "config.h"
+#include "cpu_governor.h"
+#include "epd_display.h"
+#include "epd_raster.h"
+#include "frame_store.h"
+#include "logging.h"
+
+// The page buffer is allocated when a frame is started, after the network
+// requests have freed their memory. With PSRAM the whole frame is drawn in one
+// page. Otherwise the frame is split into the fewest pages whose buffer fits
+// in internal memory, leaving PAGE_HEAP_RESERVE bytes for the display list and
+// the layout code. If not even MAX_PAGES pages fit that way, the reserve is
+// given up for pages of the smallest height, and the frame is drawn again for
+// every page if the display list does not fit either.
+#define PAGE_HEAP_RESERVE 32768 // bytes
+#define MAX_PAGES         16
+
+#if defined(EPD_FORMAT_BW)
+  #define EPD_FORMAT_NAME "BW"
+#elif defined(EPD_FORMAT_3C)
+  #define EPD_FORMAT_NAME "3C"
+#else
+  #define EPD_FORMAT_NAME "7C"
+#endif
+
+#if PARTIAL_REFRESH
+#define MAX_DIRTY_RECTS  16
+static_assert(epd_driver_t::WIDTH <= DIRTY_MAX_WIDTH,
+              "dirty tile mask must fit in 32 bits");
+
+// Survives deep sleep, but not a reset. After a reset the stored frame can not
+// be trusted to match what the panel is showing, so a full refresh is made.
+RTC_DATA_ATTR static bool frameStored = false;
+RTC_DATA_ATTR static uint16_t partialRefreshCount = 0;
+#endif
+
+#if FAST_FULL_REFRESH
+// Number of fast full refreshes since the last standard full refresh. Starts
+// saturated so that the first refresh after a reset is a standard refresh.
+RTC_DATA_ATTR static uint16_t fastRefreshCount = UINT16_MAX;
+#endif
+
+#if DISPLAY_LIST
+// The display list starts with room for DL_INITIAL_OPS operations and doubles
+// as needed, up to DL_MAX_OPS. If it would grow beyond that, or memory runs
+// out, the recording is dropped and the layout code is run again for each
+// page instead.
+#define DL_INITIAL_OPS 512
+#define DL_MAX_OPS     4096
+#endif
+
+#if DUAL_CORE_RASTER && portNUM_PROCESSORS > 1
+// Pages are drawn from the display list by both cores, one band each.
+#define EPD_RASTER_CORES  2
+#define RASTER_TASK_STACK 3072 // bytes
+#else
+#define EPD_RASTER_CORES  1
+#endif
+
+#if SLEEP_DURING_REFRESH
+// The BUSY pin of all supported panels is held LOW while the panel is busy.
+#define EPD_BUSY_LEVEL LOW
+// The esp32 checks on a refresh that it is sleeping through after this long,
+// in case the BUSY pin is never released. The refresh is given up on after
+// EPD_REFRESH_SLEEP_MAX_TIMEOUTS such checks find the panel still busy.
+#define EPD_REFRESH_SLEEP_TIMEOUT_S    60
+#define EPD_REFRESH_SLEEP_MAX_TIMEOUTS 3
+// Time at which the current full refresh was started, 0 if none is running.
+static unsigned long fullRefreshStart = 0;
+#endif
+#if SLEEP_DURING_REFRESH == 2
+RTC_DATA_ATTR static bool refreshPending = false;
+RTC_DATA_ATTR static uint8_t refreshTimeouts = 0;
+
+/* Enters deep sleep until the panel releases its BUSY pin, or for at most
+ * EPD_REFRESH_SLEEP_TIMEOUT_S. The pins of the panel must be held.
+ */
+static void deepSleepWhileBusy()
+{
+  gpio_num_t busy = static_cast<gpio_num_t>(PIN_EPD_BUSY);
+  esp_sleep_enable_ext0_wakeup(busy, !EPD_BUSY_LEVEL);
+  esp_sleep_enable_timer_wakeup(EPD_REFRESH_SLEEP_TIMEOUT_S * 1000000ULL);
+  flushLog();
+  esp_deep_sleep_start();
+} // end deepSleepWhileBusy
+#endif
+
+#if SLEEP_DURING_REFRESH
+/* Busy callback, called repeatedly by the panel driver while it waits for the
+ * panel. Instead of polling the BUSY pin at full active current, the esp32
+ * sleeps until the panel releases the BUSY pin.
+ *
+ * With SLEEP_DURING_REFRESH 2, the esp32 enters deep sleep during a full
+ * refresh. The power and control pins of the panel are held, so the panel
+ * completes the refresh while the esp32 sleeps. The esp32 then wakes only to
+ * power off the panel and schedule the next update, see resumePendingRefresh().
+ * Deep sleep is entered once the refresh has been running for longer than the
+ * panel's power on time, so that the panel's power on (which also signals
+ * BUSY) is never mistaken for the refresh itself.
+ */
+static void sleepWhileBusy(const void *)
+{
+  gpio_num_t busy = static_cast<gpio_num_t>(PIN_EPD_BUSY);
+#if SLEEP_DURING_REFRESH == 2
+  if (fullRefreshStart != 0
+   && millis() - fullRefreshStart > 2UL * epd_driver_t::power_on_time
+   && rtc_gpio_is_valid_gpio(busy))
+  {
+    refreshPending = true;
+    refreshTimeouts = 0;
+    const uint8_t heldPins[] = {PIN_EPD_PWR, PIN_EPD_RST, PIN_EPD_CS};
+    for (uint8_t pin : heldPins)
+    {
+      gpio_hold_en(static_cast<gpio_num_t>(pin));
+    }
+    gpio_deep_sleep_hold_en();
+    deepSleepWhileBusy();
+  }
+#endif
+
+  gpio_hold_en(static_cast<gpio_num_t>(PIN_EPD_PWR));
+  gpio_wakeup_enable(busy, EPD_BUSY_LEVEL == LOW ? GPIO_INTR_HIGH_LEVEL
+                                                 : GPIO_INTR_LOW_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+  flushLog();
+  esp_light_sleep_start();
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+  gpio_wakeup_disable(busy);
+  gpio_hold_dis(static_cast<gpio_num_t>(PIN_EPD_PWR));
+  return;
+} // end sleepWhileBusy
+#endif
+
+#if DISPLAY_LIST
+/* Returns a display list operation.
+ */
+static dl_op_t dlOp(dl_op_type_t type, uint16_t color, int16_t x, int16_t y,
+                    int16_t w = 0, int16_t h = 0)
+{
+  dl_op_t op = {};
+  op.type = type;
+  op.color = color;
+  op.x = x;
+  op.y = y;
+  op.size.w = w;
+  op.size.h = h;
+  return op;
+} // end dlOp
+#endif
+
+#if EPD_RASTER_CORES > 1
+// A band of the page that is drawn from the display list by the other core
+typedef struct raster_job
+{
+  epd_band_t band;
+  const dl_op_t *ops;
+  uint16_t len;
+  TaskHandle_t caller; // notified once the band is drawn
+} raster_job_t;
+
+/* FreeRTOS task that draws a band of the page from the display list.
+ */
+static void rasterTask(void *param)
+{
+  raster_job_t *job = static_cast<raster_job_t *>(param);
+  rasterOps(job->band, job->ops, job->len);
+  xTaskNotifyGive(job->caller);
+  vTaskDelete(NULL);
+} // end rasterTask
+#endif
+
+EpdDisplay::EpdDisplay(epd_driver_t epd2_instance) :
+  Adafruit_GFX(epd_driver_t::WIDTH, epd_driver_t::HEIGHT),
+  epd2(epd2_instance),
+  _buffer(nullptr),
+#ifdef EPD_FORMAT_3C
+  _color_buffer(nullptr),
+#endif
+  _prev_frame(nullptr),
+  _page_height(0),
+  _pages(0),
+  _current_page(0),
+  _frame_start(0),
+  _partial(false),
+  _fast_full(false),
+  _alloc_failed(false)
+#if DEBUG_LEVEL >= 1
+  , _skipped(0)
+#endif
+#if DISPLAY_LIST
+  , _dl(nullptr),
+  _dl_len(0),
+  _dl_cap(0),
+  _dl_depth(0),
+  _dl_recording(false),
+  _dl_record_only(false),
+  _dl_ptr(nullptr)
+#endif
+#if CHROME_CACHE
+  , _chrome_key(0)
+#endif
+{
+}
+
+/* Initializes the panel driver and selects the full refresh waveform.
+ *
+ * The fast full refresh waveform takes a fraction of the time of the standard
+ * waveform, but does not drive the particles as thoroughly. Every
+ * FAST_FULL_REFRESH_LIMIT fast refreshes, a standard refresh is made to clean
+ * the panel.
+ */
+void EpdDisplay::init(uint32_t serial_diag_bitrate, bool initial,
+                      uint16_t reset_duration, bool pulldown_rst_mode)
+{
+  epd2.init(serial_diag_bitrate, initial, reset_duration, pulldown_rst_mode);
+#if SLEEP_DURING_REFRESH
+  epd2.setBusyCallback(sleepWhileBusy);
+#endif
+#if FAST_FULL_REFRESH
+  _fast_full = fastRefreshCount < FAST_FULL_REFRESH_LIMIT;
+  // the waveform is loaded when the controller is initialized for the first
+  // write, so it must be selected before any page is written
+  epd2.selectFastFullUpdate(_fast_full);
+#endif
+  _current_page = 0;
+  return;
+} // end init
+
+/* Returns the size of a buffer plane of one page, in bytes.
+ */
+size_t EpdDisplay::planeSize() const
+{
+  return static_cast<size_t>(EPD_ROW_BYTES) * _page_height;
+} // end planeSize
+
+/* Allocates the buffer planes for pages of page_height rows, in PSRAM or in
+ * internal memory. In internal memory, at least reserve bytes must be left
+ * free.
+ *
+ * Returns true if all of the planes were allocated.
+ */
+bool EpdDisplay::allocPlanes(int16_t page_height, bool psram, size_t reserve)
+{
+  const size_t len = static_cast<size_t>(EPD_ROW_BYTES) * page_height;
+#ifdef EPD_FORMAT_3C
+  const int planes = 2;
+#else
+  const int planes = 1;
+#endif
+  uint32_t caps = MALLOC_CAP_8BIT;
+  if (psram)
+  {
+    caps |= MALLOC_CAP_SPIRAM;
+  }
+  else
+  {
+    caps |= MALLOC_CAP_INTERNAL;
+    if (heap_caps_get_free_size(caps) < planes * len + reserve)
+    {
+      return false;
+    }
+  }
+
+  _buffer = static_cast<uint8_t *>(heap_caps_malloc(len, caps));
+#ifdef EPD_FORMAT_3C
+  _color_buffer = static_cast<uint8_t *>(heap_caps_malloc(len, caps));
+  if (_color_buffer == nullptr)
+  {
+    freeBuffer();
+  }
+#endif
+  if (_buffer == nullptr)
+  {
+    freeBuffer();
+    return false;
+  }
+  _page_height = page_height;
+  _pages = (HEIGHT + page_height - 1) / page_height;
+  return true;
+} // end allocPlanes
+
+/* Allocates the page buffer, unless it already is. The whole frame is drawn
+ * in one page if there is PSRAM, or enough internal memory. Otherwise the
+ * frame is drawn in as few pages as fit, each of them redrawn (or replayed
+ * from the display list) in turn. As a last resort, the pages of the smallest
+ * height are allocated without leaving PAGE_HEAP_RESERVE free.
+ *
+ * Returns true if the page buffer is allocated.
+ */
+bool EpdDisplay::allocBuffer()
+{
+  if (_buffer != nullptr)
+  {
+    return true;
+  }
+  const size_t heap = heap_caps_get_free_size(MALLOC_CAP_8BIT
+                                              | MALLOC_CAP_INTERNAL);
+  const int16_t min_height = (HEIGHT + MAX_PAGES - 1) / MAX_PAGES;
+  bool psram = psramFound() && allocPlanes(HEIGHT, true, 0);
+  for (int pages = 1; !psram && pages <= MAX_PAGES; ++pages)
+  {
+    if (allocPlanes((HEIGHT + pages - 1) / pages, false, PAGE_HEAP_RESERVE))
+    {
+      break;
+    }
+  }
+  if (_buffer == nullptr && allocPlanes(min_height, false, 0))
+  {
+    LOG_INFO("Low memory, drawing %u pages without the heap reserve", _pages);
+  }
+  if (_buffer == nullptr)
+  {
+    LOG_INFO("Page buffer allocation failed (%uB free)",
+             static_cast<unsigned>(heap));
+    return false;
+  }
+  LOG_DEBUG("Page buffer     : %u pages of %u rows (%s), " EPD_FORMAT_NAME
+            " panel, %uB free", _pages, _page_height,
+            psram ? "PSRAM" : "internal", static_cast<unsigned>(heap));
+  return true;
+} // end allocBuffer
+
+/* Frees the page buffer.
+ */
+void EpdDisplay::freeBuffer()
+{
+  free(_buffer);
+  _buffer = nullptr;
+#ifdef EPD_FORMAT_3C
+  free(_color_buffer);
+  _color_buffer = nullptr;
+#endif
+  _page_height = 0;
+  _pages = 0;
+  return;
+} // end freeBuffer
+
+/* Returns the rows of the current page, as a band of the page buffer. The band
+ * is empty if there is no page buffer.
+ */
+epd_band_t EpdDisplay::pageBand()
+{
+  epd_band_t band;
+  band.buffer = _buffer;
+#ifdef EPD_FORMAT_3C
+  band.color_buffer = _color_buffer;
+#else
+  band.color_buffer = nullptr;
+#endif
+  band.page_ys = _current_page * _page_height;
+  band.ys = band.page_ys;
+  band.ye = std::min<int16_t>(band.page_ys + _page_height, HEIGHT) - 1;
+  return band;
+} // end pageBand
+
+/* Sets a single pixel in the page buffer. Pixels outside of the current page
+ * are discarded.
+ */
+void EpdDisplay::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+#if DISPLAY_LIST
+  if (recording())
+  {
+    record(dlOp(DL_PIXELS, color, x, y, 1, 1));
+  }
+  if (!drawing())
+  {
+    return;
+  }
+#endif
+  if ((x < 0) || (x >= width()) || (y < 0) || (y >= height()))
+  {
+    return;
+  }
+  switch (getRotation())
+  {
+  case 1:
+    std::swap(x, y);
+    x = WIDTH - x - 1;
+    break;
+  case 2:
+    x = WIDTH - x - 1;
+    y = HEIGHT - y - 1;
+    break;
+  case 3:
+    std::swap(x, y);
+    y = HEIGHT - y - 1;
+    break;
+  }
+  rasterPixel(pageBand(), x, y, color);
+  return;
+} // end drawPixel
+
+/* Fills the page buffer with a single color.
+ */
+void EpdDisplay::fillScreen(uint16_t color)
+{
+#if DISPLAY_LIST
+  if (recording())
+  {
+    record(dlOp(DL_FILL_SCREEN, color, 0, 0));
+  }
+  if (!drawing())
+  {
+    return;
+  }
+#endif
+  rasterFill(pageBand(), color);
+  return;
+} // end fillScreen
+
+/* Draws a bitmap, setting pixels to color where the bitmap bit is 0.
+ *
+ * The bitmap is clipped to the current page once, and then copied into the
+ * page buffer directly (see rasterBitmap). Rotated displays are drawn pixel
+ * by pixel.
+ */
+void EpdDisplay::drawInvertedBitmap(int16_t x, int16_t y,
+                                    const uint8_t bitmap[],
+                                    int16_t w, int16_t h, uint16_t color)
+{
+#if DISPLAY_LIST
+  if (recording())
+  {
+    recordPtr(bitmap);
+    record(dlOp(DL_BITMAP, color, x, y, w, h));
+  }
+  if (!drawing())
+  {
+    return;
+  }
+  ++_dl_depth;
+#endif
+  if (getRotation() != 0)
+  {
+    int16_t byteWidth = (w + 7) / 8; // bitmap scanline pad = whole byte
+    uint8_t byte = 0;
+    for (int16_t j = 0; j < h; ++j)
+    {
+      for (int16_t i = 0; i < w; ++i)
+      {
+        if (i & 7)
+        {
+          byte <<= 1;
+        }
+        else
+        {
+          byte = pgm_read_byte(&bitmap[j * byteWidth + i / 8]);
+        }
+        if (!(byte & 0x80))
+        {
+          drawPixel(x + i, y + j, color);
+        }
+      }
+    }
+  }
+  else
+  {
+    rasterBitmap(pageBand(), x, y, bitmap, w, h, color);
+  }
+#if DISPLAY_LIST
+  --_dl_depth;
+#endif
+  return;
+} // end drawInvertedBitmap
+
+/* Fills a rectangle with a repeating 8x8 pattern. Row y of the screen uses
+ * pattern[y % 8], in which bit 7 is the pixel with x % 8 == 0, so that
+ * patterns line up across separate fills. Pixels whose bit is 0 are left as
+ * they are.
+ *
+ * Whole bytes of the page buffer are written at once (8 pixels for black and
+ * white or 3-color panels). The pattern must outlive the frame, it is kept in
+ * the display list.
+ */
+void EpdDisplay::fillPattern(int16_t x, int16_t y, int16_t w, int16_t h,
+                             const uint8_t pattern[8], uint16_t color)
+{
+#if DISPLAY_LIST
+  if (recording())
+  {
+    recordPtr(pattern);
+    record(dlOp(DL_PATTERN, color, x, y, w, h));
+  }
+  if (!drawing())
+  {
+    return;
+  }
+  ++_dl_depth;
+#endif
+  if (getRotation() != 0)
+  {
+    for (int16_t j = y; j < y + h; ++j)
+    {
+      for (int16_t i = x; i < x + w; ++i)
+      {
+        if (pattern[j & 7] & (0x80 >> (i & 7)))
+        {
+          drawPixel(i, j, color);
+        }
+      }
+    }
+  }
+  else
+  {
+    rasterPattern(pageBand(), x, y, w, h, pattern, color);
+  }
+#if DISPLAY_LIST
+  --_dl_depth;
+#endif
+  return;
+} // end fillPattern
+
+/* Draws every step-th pixel of a horizontal line of width w, starting at x.
+ */
+void EpdDisplay::drawDottedHLine(int16_t x, int16_t y, int16_t w, int16_t step,
+                                 uint16_t color)
+{
+  step = std::max<int16_t>(step, 1);
+#if DISPLAY_LIST
+  if (recording() && w > 0)
+  {
+    record(dlOp(DL_PIXELS, color, x, y, (w + step - 1) / step, step));
+  }
+  if (!drawing())
+  {
+    return;
+  }
+  ++_dl_depth;
+#endif
+  if (getRotation() != 0)
+  {
+    for (int16_t i = 0; i < w; i += step)
+    {
+      drawPixel(x + i, y, color);
+    }
+  }
+  else
+  {
+    rasterDottedHLine(pageBand(), x, y, w, step, color);
+  }
+#if DISPLAY_LIST
+  --_dl_depth;
+#endif
+  return;
+} // end drawDottedHLine
+
+/* Draws a 2 pixel thick line: the line from (x0, y0) to (x1, y1) together with
+ * its copies shifted one pixel down and one pixel left. The pixels are the
+ * same as those of the three lines drawn with drawLine, but the line is
+ * stepped through only once.
+ */
+void EpdDisplay::drawThickLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                               uint16_t color)
+{
+#if DISPLAY_LIST
+  if (recording())
+  {
+    record(dlOp(DL_THICK_LINE, color, x0, y0, x1, y1));
+  }
+  if (!drawing())
+  {
+    return;
+  }
+  ++_dl_depth;
+#endif
+  if (getRotation() != 0)
+  {
+    drawLine(x0    , y0    , x1    , y1    , color);
+    drawLine(x0    , y0 + 1, x1    , y1 + 1, color);
+    drawLine(x0 - 1, y0    , x1 - 1, y1    , color);
+  }
+  else
+  {
+    rasterThickLine(pageBand(), x0, y0, x1, y1, color);
+  }
+#if DISPLAY_LIST
+  --_dl_depth;
+#endif
+  return;
+} // end drawThickLine
+
+#if DISPLAY_LIST
+// Drawing operations are recorded at the highest level at which they enter
+// the display. Everything an operation draws in turn (e.g. the pixels of a
+// line) is nested, and not recorded again. The Adafruit_GFX shapes that are
+// not virtual (circles, triangles, ...) are recorded as the lines and fills
+// they are made of.
+
+/* Draws a line of any slope.
+ */
+void EpdDisplay::writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                           uint16_t color)
+{
+  if (recording())
+  {
+    record(dlOp(DL_LINE, color, x0, y0, x1, y1));
+  }
+  if (!drawing())
+  {
+    return;
+  }
+  ++_dl_depth;
+  Adafruit_GFX::writeLine(x0, y0, x1, y1, color);
+  --_dl_depth;
+  return;
+} // end writeLine
+
+/* Draws a vertical line.
+ */
+void EpdDisplay::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+{
+  if (recording())
+  { // Adafruit_GFX draws it as this line
+    record(dlOp(DL_LINE, color, x, y, x, y + h - 1));
+  }
+  if (!drawing())
+  {
+    return;
+  }
+  ++_dl_depth;
+  Adafruit_GFX::drawFastVLine(x, y, h, color);
+  --_dl_depth;
+  return;
+} // end drawFastVLine
+
+/* Draws a horizontal line.
+ */
+void EpdDisplay::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+  if (recording())
+  { // Adafruit_GFX draws it as this line
+    record(dlOp(DL_LINE, color, x, y, x + w - 1, y));
+  }
+  if (!drawing())
+  {
+    return;
+  }
+  ++_dl_depth;
+  Adafruit_GFX::drawFastHLine(x, y, w, color);
+  --_dl_depth;
+  return;
+} // end drawFastHLine
+
+/* Fills a rectangle.
+ */
+void EpdDisplay::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                          uint16_t color)
+{
+  if (recording())
+  {
+    record(dlOp(DL_FILL_RECT, color, x, y, w, h));
+  }
+  if (!drawing())
+  {
+    return;
+  }
+  ++_dl_depth;
+  Adafruit_GFX::fillRect(x, y, w, h, color);
+  --_dl_depth;
+  return;
+} // end fillRect
+
+/* Draws a character at the cursor and advances the cursor.
+ */
+size_t EpdDisplay::write(uint8_t c)
+{
+  if (recording())
+  {
+    recordGlyph(c);
+  }
+  if (!drawing())
+  {
+    advanceCursor(c);
+    return 1;
+  }
+  ++_dl_depth;
+  size_t n = Adafruit_GFX::write(c);
+  --_dl_depth;
+  return n;
+} // end write
+
+/* Appends an operation to the display list. Consecutive pixels of the same
+ * color, on the same row and evenly spaced, are merged into one operation.
+ */
+void EpdDisplay::record(dl_op_t op)
+{
+  if (!_dl_recording)
+  { // dropped
+    return;
+  }
+  if (op.type == DL_PIXELS && op.size.w == 1 && _dl_len > 0)
+  {
+    dl_op_t &last = _dl[_dl_len - 1];
+    if (last.type == DL_PIXELS && last.y == op.y && last.color == op.color)
+    {
+      if (last.size.w == 1 && op.x > last.x)
+      {
+        last.size.h = op.x - last.x;
+        ++last.size.w;
+        return;
+      }
+      if (op.x == last.x + last.size.w * last.size.h)
+      {
+        ++last.size.w;
+        return;
+      }
+    }
+  }
+
+  if (_dl_len == _dl_cap)
+  {
+    uint32_t cap = _dl_cap > 0 ? 2 * _dl_cap : DL_INITIAL_OPS;
+    dl_op_t *dl = nullptr;
+    if (cap <= DL_MAX_OPS)
+    {
+      dl = static_cast<dl_op_t *>(realloc(_dl, cap * sizeof(dl_op_t)));
+    }
+    if (dl == nullptr)
+    {
+      LOG_DEBUG("Display list    : dropped at %u ops", _dl_len);
+      freeDisplayList();
+      return;
+    }
+    _dl = dl;
+    _dl_cap = cap;
+  }
+  _dl[_dl_len++] = op;
+  return;
+} // end record
+
+/* Records the font or bitmap used by the operations that follow, if it
+ * differs from the last one recorded.
+ */
+void EpdDisplay::recordPtr(const void *ptr)
+{
+  if (ptr == _dl_ptr)
+  {
+    return;
+  }
+  dl_op_t op = dlOp(DL_PTR, 0, 0, 0);
+  op.ptr = ptr;
+  record(op);
+  _dl_ptr = ptr;
+  return;
+} // end recordPtr
+
+/* Records the glyph that write(c) is about to draw, if any. Only text in a
+ * custom font, without scaling or wrapping (as drawn by the renderer), can be
+ * recorded. Other text drops the recording.
+ */
+void EpdDisplay::recordGlyph(uint8_t c)
+{
+  if (gfxFont == nullptr || wrap || textsize_x != 1 || textsize_y != 1)
+  {
+    freeDisplayList();
+    return;
+  }
+  if (c == '\n' || c == '\r' || c < gfxFont->first || c > gfxFont->last)
+  {
+    return;
+  }
+  const GFXglyph &glyph = gfxFont->glyph[c - gfxFont->first];
+  if (glyph.width == 0 || glyph.height == 0)
+  {
+    return;
+  }
+  recordPtr(gfxFont);
+  dl_op_t op = dlOp(DL_GLYPH, textcolor, cursor_x, cursor_y);
+  op.arg = c;
+  record(op);
+  return;
+} // end recordGlyph
+
+/* Moves the cursor past character c without drawing it, as
+ * Adafruit_GFX::write() does. Only called for text that recordGlyph() could
+ * record: in a custom font, without scaling or wrapping.
+ */
+void EpdDisplay::advanceCursor(uint8_t c)
+{
+  if (c == '\n')
+  {
+    cursor_x = 0;
+    cursor_y += gfxFont->yAdvance;
+  }
+  else if (c != '\r' && c >= gfxFont->first && c <= gfxFont->last)
+  {
+    cursor_x += gfxFont->glyph[c - gfxFont->first].xAdvance;
+  }
+  return;
+} // end advanceCursor
+
+/* Stops recording, and frees the display list.
+ */
+void EpdDisplay::freeDisplayList()
+{
+  free(_dl);
+  _dl = nullptr;
+  _dl_len = 0;
+  _dl_cap = 0;
+  _dl_recording = false;
+  return;
+} // end freeDisplayList
+
+/* Draws the operations in the display list that touch the current page.
+ *
+ * With DUAL_CORE_RASTER, the other core draws the lower half of the page at
+ * the same time. The halves are disjoint rows of the page buffer and the
+ * display list is only read, so the cores need no locks while they draw.
+ */
+void EpdDisplay::replayPage()
+{
+  CpuBoost boost;
+  if (getRotation() == 0)
+  {
+    epd_band_t band = pageBand();
+#if EPD_RASTER_CORES > 1
+    raster_job_t job = {band, _dl, _dl_len, xTaskGetCurrentTaskHandle()};
+    job.band.ys = band.ys + (band.ye - band.ys + 1) / 2;
+    band.ye = job.band.ys - 1;
+    const bool split = xTaskCreatePinnedToCore(rasterTask, "raster",
+                                               RASTER_TASK_STACK, &job,
+                                               uxTaskPriorityGet(NULL), NULL,
+                                               xPortGetCoreID() ^ 1)
+                       == pdPASS;
+    if (!split)
+    { // draw the whole page on this core
+      band.ye = job.band.ye;
+    }
+#endif
+    rasterOps(band, _dl, _dl_len);
+#if EPD_RASTER_CORES > 1
+    if (split)
+    {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+#endif
+    return;
+  }
+
+  // rotated displays are drawn through the drawing functions, which map the
+  // coordinates to panel rows
+  GFXfont *font = gfxFont;
+  const void *ptr = nullptr;
+  for (uint16_t i = 0; i < _dl_len; ++i)
+  {
+    const dl_op_t &op = _dl[i];
+    switch (op.type)
+    {
+    case DL_PTR:
+      ptr = op.ptr;
+      break;
+    case DL_GLYPH:
+      gfxFont = static_cast<GFXfont *>(const_cast<void *>(ptr));
+      drawChar(op.x, op.y, op.arg, op.color, op.color, 1, 1);
+      break;
+    case DL_PIXELS:
+      drawDottedHLine(op.x, op.y, (op.size.w - 1) * op.size.h + 1, op.size.h,
+                      op.color);
+      break;
+    case DL_LINE:
+      startWrite();
+      writeLine(op.x, op.y, op.size.w, op.size.h, op.color);
+      endWrite();
+      break;
+    case DL_FILL_RECT:
+      fillRect(op.x, op.y, op.size.w, op.size.h, op.color);
+      break;
+    case DL_BITMAP:
+      drawInvertedBitmap(op.x, op.y, static_cast<const uint8_t *>(ptr),
+                         op.size.w, op.size.h, op.color);
+      break;
+    case DL_FILL_SCREEN:
+      fillScreen(op.color);
+      break;
+    case DL_PATTERN:
+      fillPattern(op.x, op.y, op.size.w, op.size.h,
+                  static_cast<const uint8_t *>(ptr), op.color);
+      break;
+    case DL_THICK_LINE:
+      drawThickLine(op.x, op.y, op.size.w, op.size.h, op.color);
+      break;
+    default:
+      break;
+    }
+  }
+  gfxFont = font;
+  return;
+} // end replayPage
+#endif
+
+/* Frames always cover the full screen. Kept for compatibility with the GxEPD2
+ * paged drawing interface.
+ */
+void EpdDisplay::setFullWindow()
+{
+  _current_page = 0;
+  return;
+} // end setFullWindow
+
+/* Begins paged drawing, allocates the page buffer and clears it to white.
+ * Must be called once the network requests are done, so that their memory is
+ * available for the page buffer.
+ *
+ * If the frame takes more than one page, the drawing operations of the first
+ * page are recorded in a display list (see DISPLAY_LIST). With
+ * DUAL_CORE_RASTER, the frame is only recorded, and every page is drawn from
+ * the display list by both cores.
+ *
+ * The frame shown on the panel is loaded for a partial refresh here, after
+ * the page buffer, so that the network requests have freed their memory.
+ */
+void EpdDisplay::firstPage()
+{
+  _current_page = 0;
+#if DISPLAY_LIST
+  freeDisplayList();
+#endif
+#if CHROME_CACHE
+  _chrome.close();
+#endif
+  _frame_start = millis();
+  _alloc_failed = !allocBuffer();
+  fillScreen(GxEPD_WHITE);
+#if PARTIAL_REFRESH
+  if (_partial && !loadPrevFrame())
+  { // a full refresh is made instead
+    _partial = false;
+  }
+#endif
+  if (_pages > 1)
+  {
+    epd2.setPaged();
+  }
+#if DISPLAY_LIST
+  if (_pages > 1 || DUAL_CORE_RASTER)
+  {
+    _dl_ptr = nullptr;
+    _dl_recording = true;
+    _dl_record_only = DUAL_CORE_RASTER;
+  }
+#endif
+  return;
+} // end firstPage
+
+/* Returns true if a widget within bounds must be drawn on the current page.
+ *
+ * Pages are bands of panel rows, so a widget that lies entirely above or
+ * below the band can be skipped. Nothing is skipped while the first page is
+ * recorded in the display list, which must hold the whole frame.
+ */
+bool EpdDisplay::isOnPage(const epd_rect_t &bounds)
+{
+#if DISPLAY_LIST
+  if (_dl_recording)
+  {
+    return true;
+  }
+#endif
+  const int16_t page_ys = _current_page * _page_height;
+  if (_pages == 1 || getRotation() != 0
+   || (bounds.y < page_ys + _page_height
+    && bounds.y + bounds.h > page_ys))
+  {
+    return true;
+  }
+#if DEBUG_LEVEL >= 1
+  ++_skipped;
+#endif
+  return false;
+} // end isOnPage
+
+#if CHROME_CACHE
+/* Fills the page buffer with the saved chrome layer, if it was saved with the
+ * same key. The chrome layer of each following page is read as the page is
+ * started. Must be called on the first page, before anything is drawn.
+ *
+ * Returns true if the chrome layer was restored.
+ */
+bool EpdDisplay::restoreChrome(uint32_t key)
+{
+  _chrome.close();
+  if (_buffer == nullptr)
+  {
+    return false;
+  }
+  _chrome = openChrome(key, planeSize());
+  _chrome_key = key;
+  _current_page = 0;
+  loadChromePage();
+  return static_cast<bool>(_chrome);
+} // end restoreChrome
+
+/* Draws the chrome layer of every page with draw, and saves it with the given
+ * key. The pages are drawn into the page buffer, but not written to the
+ * controller. The first page is then restored (see restoreChrome()).
+ *
+ * Returns true if the chrome layer was saved and restored.
+ */
+bool EpdDisplay::saveChrome(uint32_t key, void (*draw)())
+{
+  File file;
+  if (_buffer != nullptr)
+  {
+    file = createChrome(key, planeSize());
+  }
+  if (!file)
+  {
+    return false;
+  }
+#if DISPLAY_LIST
+  // drawn directly, whether or not the frame is being recorded
+  const bool recording = _dl_recording;
+  _dl_recording = false;
+#endif
+  bool ok = true;
+  for (_current_page = 0; ok && _current_page < _pages; ++_current_page)
+  {
+    fillScreen(GxEPD_WHITE);
+    draw();
+    ok = writePacked(file, _buffer, planeSize()) > 0;
+#ifdef EPD_FORMAT_3C
+    ok = ok && writePacked(file, _color_buffer, planeSize()) > 0;
+#endif
+  }
+  _current_page = 0;
+  fillScreen(GxEPD_WHITE);
+#if DISPLAY_LIST
+  _dl_recording = recording;
+#endif
+#if DEBUG_LEVEL >= 1
+  _skipped = 0;
+#endif
+  return commitChrome(file, ok) && restoreChrome(key);
+} // end saveChrome
+
+/* Reads the chrome layer of the current page into the page buffer. If it can
+ * not be read, the page is cleared and the saved chrome layer is deleted, to
+ * be drawn and saved again by the next frame.
+ */
+void EpdDisplay::loadChromePage()
+{
+  if (!_chrome)
+  {
+    return;
+  }
+  bool ok = readPacked(_chrome, _buffer, planeSize());
+#ifdef EPD_FORMAT_3C
+  ok = ok && readPacked(_chrome, _color_buffer, planeSize());
+#endif
+  if (!ok)
+  {
+    LOG_INFO("Chrome layer of page %u is corrupt", _current_page);
+    _chrome.close();
+    removeChrome();
+    rasterFill(pageBand(), GxEPD_WHITE);
+  }
+  return;
+} // end loadChromePage
+#endif
+
+/* Writes the current page to the controller. After the last page has been
+ * written the panel is refreshed, and the page buffer is freed.
+ *
+ * If the first page was recorded, the remaining pages are drawn from the
+ * display list here, and the frame is complete. If the frame was only
+ * recorded, the first page is drawn from the display list too, or, if the
+ * recording was dropped, must be drawn again.
+ *
+ * Returns true if another page must be drawn.
+ */
+bool EpdDisplay::nextPage()
+{
+  if (_buffer == nullptr)
+  { // nothing could be drawn, see allocBuffer()
+#if DISPLAY_LIST
+    freeDisplayList();
+    _dl_record_only = false;
+#endif
+    return false;
+  }
+#if DISPLAY_LIST
+  const bool replay = _dl_recording;
+  const bool record_only = _dl_record_only;
+  _dl_recording = false;
+  _dl_record_only = false;
+  if (replay)
+  {
+    LOG_DEBUG("Display list    : %u ops (%uB)", _dl_len,
+              static_cast<unsigned>(_dl_len * sizeof(dl_op_t)));
+  }
+  if (record_only && !replay)
+  { // dropped, and the page holds only what was drawn after that
+    fillScreen(GxEPD_WHITE);
+#if CHROME_CACHE
+    if (_chrome)
+    { // the page is drawn again on top of its chrome layer
+      restoreChrome(_chrome_key);
+    }
+#endif
+    return true;
+  }
+  if (record_only)
+  {
+    replayPage();
+  }
+#else
+  const bool replay = false;
+#endif
+#if DEBUG_LEVEL >= 1
+  if (_skipped > 0)
+  {
+    LOG_DEBUG("Page %u          : %u widgets skipped", _current_page,
+              _skipped);
+    _skipped = 0;
+  }
+#endif
+  while (true)
+  {
+    int16_t page_ys = _current_page * _page_height;
+    int16_t page_h = std::min<int16_t>(_page_height, HEIGHT - page_ys);
+    if (!_partial)
+    {
+      writePage(page_ys, page_h);
+    }
+
+    ++_current_page;
+    if (_current_page >= _pages)
+    {
+      break;
+    }
+    fillScreen(GxEPD_WHITE);
+#if CHROME_CACHE
+    loadChromePage();
+#endif
+    if (!replay)
+    {
+      return true;
+    }
+#if DISPLAY_LIST
+    replayPage();
+#endif
+  }
+
+#if DISPLAY_LIST
+  freeDisplayList();
+#endif
+#if CHROME_CACHE
+  _chrome.close();
+#endif
+  LOG_INFO("Frame drawn (%u pages): %.3fs", _pages,
+           (millis() - _frame_start) / 1000.0);
+  refreshFrame();
+  freeBuffer();
+  _current_page = 0;
+  return false;
+} // end nextPage
+
+/* Turns the panel's high voltage supply off.
+ */
+void EpdDisplay::powerOff()
+{
+  epd2.powerOff();
+  return;
+} // end powerOff
+
+/* Turns the panel off and puts the controller into deep sleep.
+ */
+void EpdDisplay::hibernate()
+{
+  epd2.hibernate();
+  return;
+} // end hibernate
+
+/* Returns the number of pages needed to draw one frame.
+ */
+uint16_t EpdDisplay::pages() const
+{
+  return _pages;
+} // end pages
+
+/* Returns true if the page buffer could not be allocated for the last frame,
+ * which was then not drawn.
+ */
+bool EpdDisplay::allocFailed() const
+{
+  return _alloc_failed;
+} // end allocFailed
+
+/* Returns the height of a page in pixels.
+ */
+uint16_t EpdDisplay::pageHeight() const
+{
+  return _page_height;
+} // end pageHeight
+
+/* Writes a page from the page buffer to the controller's frame memory.
+ */
+void EpdDisplay::writePage(int16_t page_ys, int16_t page_h)
+{
+#ifdef EPD_FORMAT_BW
+  epd2.writeImageForFullRefresh(_buffer, 0, page_ys, WIDTH, page_h);
+#endif
+#ifdef EPD_FORMAT_3C
+  epd2.writeImage(_buffer, _color_buffer, 0, page_ys, WIDTH, page_h);
+#endif
+#ifdef EPD_FORMAT_7C
+  epd2.writeNative(_buffer, nullptr, 0, page_ys, WIDTH, page_h);
+#endif
+  return;
+} // end writePage
+
+
+/* Decides whether the next refresh can update only the regions that changed.
+ * A full refresh is required when no trustworthy copy of the shown frame is
+ * available or after PARTIAL_REFRESH_LIMIT consecutive partial refreshes,
+ * since each partial refresh leaves a little more ghosting behind.
+ *
+ * Must be called before init(). Returns true if the next refresh will be a
+ * partial refresh, unless the shown frame cannot be loaded when the frame is
+ * drawn (see firstPage()).
+ */
+bool EpdDisplay::preparePartialRefresh()
+{
+#if PARTIAL_REFRESH
+  _partial = frameStored && partialRefreshCount < PARTIAL_REFRESH_LIMIT;
+  return _partial;
+#else
+  return false;
+#endif
+} // end preparePartialRefresh
+
+#if PARTIAL_REFRESH
+/* Loads the frame that is currently shown on the panel, to compare the new
+ * frame against.
+ *
+ * Returns false if it could not be loaded, or the new frame takes more than
+ * one page, since frames are compared whole.
+ */
+bool EpdDisplay::loadPrevFrame()
+{
+  if (_prev_frame != nullptr)
+  {
+    return true;
+  }
+  if (_pages != 1)
+  {
+    return false;
+  }
+  _prev_frame = static_cast<uint8_t *>(malloc(EPD_FRAME_SIZE));
+  if (_prev_frame == nullptr)
+  {
+    LOG_INFO("No memory for the shown frame, making a full refresh");
+    return false;
+  }
+  if (!loadFrame(_prev_frame, EPD_FRAME_SIZE))
+  {
+    free(_prev_frame);
+    _prev_frame = nullptr;
+    return false;
+  }
+  return true;
+} // end loadPrevFrame
+#endif
+
+/* Returns true if the esp32 woke up from a deep sleep it entered during a
+ * refresh (SLEEP_DURING_REFRESH 2). Releases the pins that were held during
+ * the refresh; the panel must then be initialized again and powered off.
+ *
+ * If the esp32 was woken by the timeout while the panel is still busy, it
+ * goes back to sleep instead, since resetting the panel would abort the
+ * refresh.
+ */
+bool EpdDisplay::resumePendingRefresh()
+{
+#if SLEEP_DURING_REFRESH == 2
+  if (!refreshPending)
+  {
+    return false;
+  }
+  pinMode(PIN_EPD_BUSY, INPUT);
+  if (digitalRead(PIN_EPD_BUSY) == EPD_BUSY_LEVEL)
+  {
+    if (refreshTimeouts < EPD_REFRESH_SLEEP_MAX_TIMEOUTS)
+    {
+      ++refreshTimeouts;
+      LOG_INFO("Panel refresh still running, sleeping until it completes");
+      deepSleepWhileBusy();
+    }
+    LOG_INFO("Panel refresh did not complete, giving up");
+  }
+  refreshPending = false;
+  // drive the pins to their held levels before releasing them
+  pinMode(PIN_EPD_PWR, OUTPUT);
+  digitalWrite(PIN_EPD_PWR, HIGH);
+  pinMode(PIN_EPD_RST, OUTPUT);
+  digitalWrite(PIN_EPD_RST, HIGH);
+  pinMode(PIN_EPD_CS, OUTPUT);
+  digitalWrite(PIN_EPD_CS, HIGH);
+  const uint8_t heldPins[] = {PIN_EPD_PWR, PIN_EPD_RST, PIN_EPD_CS};
+  for (uint8_t pin : heldPins)
+  {
+    gpio_hold_dis(static_cast<gpio_num_t>(pin));
+  }
+  gpio_deep_sleep_hold_dis();
+  return true;
+#else
+  return false;
+#endif
+} // end resumePendingRefresh
+
+/* Refreshes the panel after the frame has been written.
+ *
+ * With partial refresh the frame is compared against the frame that is shown
+ * on the panel. Both frames are loaded into the controller's old/new frame
+ * memories, then only the bounding window of the dirty rectangles is
+ * refreshed with the fast partial waveform. The dirty rectangles are merged
+ * into one window because the waveform takes the same time regardless of the
+ * window's size.
+ */
+void EpdDisplay::refreshFrame()
+{
+  unsigned long refreshStart = millis();
+  const char *mode = _fast_full ? "fast full" : "full";
+#if PARTIAL_REFRESH
+  if (_partial)
+  {
+    mode = "partial";
+    epd_rect_t rects[MAX_DIRTY_RECTS];
+    int n = findDirtyRects(_prev_frame, _buffer, WIDTH, HEIGHT,
+                           rects, MAX_DIRTY_RECTS);
+    int16_t x0 = WIDTH, y0 = HEIGHT, x1 = 0, y1 = 0;
+    int32_t area = 0;
+    for (int i = 0; i < n; ++i)
+    {
+      x0 = std::min(x0, rects[i].x);
+      y0 = std::min(y0, rects[i].y);
+      x1 = std::max<int16_t>(x1, rects[i].x + rects[i].w);
+      y1 = std::max<int16_t>(y1, rects[i].y + rects[i].h);
+      area += static_cast<int32_t>(rects[i].w) * rects[i].h;
+    }
+#if DEBUG_LEVEL >= 1
+    LOG_DEBUG("Dirty rects     : %d (%.1f%%)", n,
+              100.0f * area / (WIDTH * HEIGHT));
+    for (int i = 0; i < n; ++i)
+    {
+      LOG_DEBUG("  %3d,%3d %3dx%3d",
+                rects[i].x, rects[i].y, rects[i].w, rects[i].h);
+    }
+#endif
+
+    if (n > 0)
+    {
+      epd2.writeImageAgain(_prev_frame, 0, 0, WIDTH, HEIGHT); // old
+      epd2.writeImage(_buffer, 0, 0, WIDTH, HEIGHT);          // new
+      epd2.refresh(x0, y0, x1 - x0, y1 - y0);
+      frameStored = saveFrame(_buffer, EPD_FRAME_SIZE);
+      ++partialRefreshCount;
+    }
+    else
+    {
+      mode = "none";
+    }
+    free(_prev_frame);
+    _prev_frame = nullptr;
+    _partial = false;
+  }
+  else
+#endif
+  { // the esp32 may not return from the refresh (SLEEP_DURING_REFRESH 2), so
+    // the bookkeeping is done first
+#if PARTIAL_REFRESH
+    // only a frame drawn in one page can be kept
+    frameStored = _pages == 1 && saveFrame(_buffer, EPD_FRAME_SIZE);
+    partialRefreshCount = 0;
+#endif
+#if FAST_FULL_REFRESH
+    fastRefreshCount = _fast_full ? fastRefreshCount + 1 : 0;
+#endif
+#if SLEEP_DURING_REFRESH
+    fullRefreshStart = millis();
+#endif
+    epd2.refresh(false);
+#if SLEEP_DURING_REFRESH
+    fullRefreshStart = 0;
+#endif
+  }
+
+  LOG_INFO("Panel refresh (%s): %.3fs", mode,
+           (millis() - refreshStart) / 1000.0);
+  return;
+} // end refreshFrame
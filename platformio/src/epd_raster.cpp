@@ -0,0 +1,573 @@
+/* Page buffer rasterization for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <Arduino.h>
+#include "epd_raster.h"
+
+// Each primitive is clipped to the band once, and then written straight into
+// the page buffer. The pixels drawn are the same as those of the Adafruit_GFX
+// drawing functions that EpdDisplay records them from. Nothing here touches
+// the state of the display, so that bands can be drawn on both cores.
+
+static const int16_t EPD_WIDTH = epd_driver_t::WIDTH;
+
+// Pixels drawn at each step along a line, as x, y offsets
+static const int8_t LINE_PEN[1][2]       = {{0, 0}};
+// The 2 pixel pen of the outlook graph: the line, and its copies shifted one
+// pixel down and one pixel left
+static const int8_t THICK_LINE_PEN[3][2] = {{0, 0}, {0, 1}, {-1, 0}};
+
+static const uint8_t SOLID_PATTERN[8] = {0xFF, 0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF, 0xFF};
+
+#ifdef EPD_FORMAT_7C
+/* Returns the controller's native 4-bit color code for a GxEPD color.
+ */
+static uint8_t toColor7(uint16_t color)
+{
+  switch (color)
+  {
+  case GxEPD_WHITE:  return 0x01;
+  case GxEPD_GREEN:  return 0x02;
+  case GxEPD_BLUE:   return 0x03;
+  case GxEPD_RED:    return 0x04;
+  case GxEPD_YELLOW: return 0x05;
+  case GxEPD_ORANGE: return 0x06;
+  default:           return 0x00; // black
+  }
+} // end toColor7
+#endif
+
+/* Clips a rectangle, given by its corners, to the band.
+ *
+ * Returns false if nothing of the rectangle is left.
+ */
+static bool clipToBand(const epd_band_t &band, int16_t &x0, int16_t &y0,
+                       int16_t &x1, int16_t &y1)
+{
+  x0 = std::max<int16_t>(x0, 0);
+  x1 = std::min<int16_t>(x1, EPD_WIDTH - 1);
+  y0 = std::max(y0, band.ys);
+  y1 = std::min(y1, band.ye);
+  return x0 <= x1 && y0 <= y1;
+} // end clipToBand
+
+/* Returns true if the pixel is within the band.
+ */
+static inline bool inBand(const epd_band_t &band, int16_t x, int16_t y)
+{
+  return x >= 0 && x < EPD_WIDTH && y >= band.ys && y <= band.ye;
+} // end inBand
+
+/* Returns the index in the page buffer of the first byte of row y.
+ */
+static inline uint32_t rowIndex(const epd_band_t &band, int16_t y)
+{
+  return static_cast<uint32_t>(y - band.page_ys) * EPD_ROW_BYTES;
+} // end rowIndex
+
+#if defined(EPD_FORMAT_BW) || defined(EPD_FORMAT_3C)
+/* Sets the pixels of byte i of the page buffer whose bits are set in mask.
+ */
+static inline void setBits(const epd_band_t &band, uint32_t i, uint8_t mask,
+                           uint16_t color)
+{
+#ifdef EPD_FORMAT_BW
+  // as in GxEPD2_BW, every color but black is drawn white
+  if (color != GxEPD_BLACK)
+  {
+    band.buffer[i] |= mask;
+  }
+  else
+  {
+    band.buffer[i] &= ~mask;
+  }
+#endif
+#ifdef EPD_FORMAT_3C
+  if (color == GxEPD_WHITE)
+  {
+    band.buffer[i] |= mask;
+    band.color_buffer[i] |= mask;
+  }
+  else if (color == GxEPD_BLACK)
+  {
+    band.buffer[i] &= ~mask;
+    band.color_buffer[i] |= mask;
+  }
+  else
+  {
+    band.buffer[i] |= mask;
+    band.color_buffer[i] &= ~mask;
+  }
+#endif
+  return;
+} // end setBits
+#endif
+
+/* Sets a pixel of the page buffer. The pixel must be within the band.
+ */
+static inline void setPixel(const epd_band_t &band, int16_t x, int16_t y,
+                            uint16_t color)
+{
+#if defined(EPD_FORMAT_BW) || defined(EPD_FORMAT_3C)
+  setBits(band, rowIndex(band, y) + x / 8, 1 << (7 - x % 8), color);
+#endif
+#ifdef EPD_FORMAT_7C
+  uint32_t i = rowIndex(band, y) + x / 2;
+  uint8_t c = toColor7(color);
+  if (x & 1)
+  {
+    band.buffer[i] = (band.buffer[i] & 0xF0) | c;
+  }
+  else
+  {
+    band.buffer[i] = (band.buffer[i] & 0x0F) | (c << 4);
+  }
+#endif
+  return;
+} // end setPixel
+
+/* Draws a line from (x0, y0) to (x1, y1), stamping the pen at each step. The
+ * steps are the same as those of Adafruit_GFX::writeLine.
+ */
+static void strokeLine(const epd_band_t &band, int16_t x0, int16_t y0,
+                       int16_t x1, int16_t y1, const int8_t (*pen)[2],
+                       int pen_len, uint16_t color)
+{
+  // pens reach at most one row down
+  if (std::max(y0, y1) + 1 < band.ys || std::min(y0, y1) > band.ye)
+  {
+    return;
+  }
+  const bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep)
+  {
+    std::swap(x0, y0);
+    std::swap(x1, y1);
+  }
+  if (x0 > x1)
+  {
+    std::swap(x0, x1);
+    std::swap(y0, y1);
+  }
+  const int16_t dx = x1 - x0;
+  const int16_t dy = abs(y1 - y0);
+  const int16_t ystep = (y0 < y1) ? 1 : -1;
+  int16_t err = dx / 2;
+  for (; x0 <= x1; ++x0)
+  {
+    const int16_t px = steep ? y0 : x0;
+    const int16_t py = steep ? x0 : y0;
+    for (int p = 0; p < pen_len; ++p)
+    {
+      const int16_t sx = px + pen[p][0];
+      const int16_t sy = py + pen[p][1];
+      if (inBand(band, sx, sy))
+      {
+        setPixel(band, sx, sy, color);
+      }
+    }
+    err -= dy;
+    if (err < 0)
+    {
+      y0 += ystep;
+      err += dx;
+    }
+  }
+  return;
+} // end strokeLine
+
+/* Fills the rows of the band with a single color.
+ */
+void rasterFill(const epd_band_t &band, uint16_t color)
+{
+  if (band.ye < band.ys)
+  {
+    return;
+  }
+  const uint32_t i = rowIndex(band, band.ys);
+  const size_t len = static_cast<size_t>(band.ye - band.ys + 1)
+                     * EPD_ROW_BYTES;
+#ifdef EPD_FORMAT_BW
+  memset(band.buffer + i, (color == GxEPD_BLACK) ? 0x00 : 0xFF, len);
+#endif
+#ifdef EPD_FORMAT_3C
+  memset(band.buffer + i, (color == GxEPD_BLACK) ? 0x00 : 0xFF, len);
+  memset(band.color_buffer + i, (color == GxEPD_WHITE || color == GxEPD_BLACK)
+                                ? 0xFF : 0x00, len);
+#endif
+#ifdef EPD_FORMAT_7C
+  uint8_t c = toColor7(color);
+  memset(band.buffer + i, (c << 4) | c, len);
+#endif
+  return;
+} // end rasterFill
+
+/* Sets a single pixel. Pixels outside of the band are discarded.
+ */
+void rasterPixel(const epd_band_t &band, int16_t x, int16_t y, uint16_t color)
+{
+  if (inBand(band, x, y))
+  {
+    setPixel(band, x, y, color);
+  }
+  return;
+} // end rasterPixel
+
+/* Draws a line of any slope.
+ */
+void rasterLine(const epd_band_t &band, int16_t x0, int16_t y0,
+                int16_t x1, int16_t y1, uint16_t color)
+{
+  strokeLine(band, x0, y0, x1, y1, LINE_PEN, 1, color);
+  return;
+} // end rasterLine
+
+/* Draws a 2 pixel thick line: the line from (x0, y0) to (x1, y1) together with
+ * its copies shifted one pixel down and one pixel left.
+ */
+void rasterThickLine(const epd_band_t &band, int16_t x0, int16_t y0,
+                     int16_t x1, int16_t y1, uint16_t color)
+{
+  strokeLine(band, x0, y0, x1, y1, THICK_LINE_PEN, 3, color);
+  return;
+} // end rasterThickLine
+
+/* Draws every step-th pixel of a horizontal line of width w, starting at x.
+ */
+void rasterDottedHLine(const epd_band_t &band, int16_t x, int16_t y,
+                       int16_t w, int16_t step, uint16_t color)
+{
+  step = std::max<int16_t>(step, 1);
+  int16_t x0 = x;
+  int16_t y0 = y;
+  int16_t x1 = x + w - 1;
+  int16_t y1 = y;
+  if (w <= 0 || !clipToBand(band, x0, y0, x1, y1))
+  {
+    return;
+  }
+  // first dot on the screen
+  x0 = x + (x0 - x + step - 1) / step * step;
+  for (int16_t i = x0; i <= x1; i += step)
+  {
+    setPixel(band, i, y0, color);
+  }
+  return;
+} // end rasterDottedHLine
+
+/* Fills a rectangle. Covers the same pixels as Adafruit_GFX::fillRect, which
+ * for a height of 0 or less draws the rows from y + h - 1 to y.
+ */
+void rasterRect(const epd_band_t &band, int16_t x, int16_t y,
+                int16_t w, int16_t h, uint16_t color)
+{
+  const int16_t y0 = std::min<int16_t>(y, y + h - 1);
+  const int16_t y1 = std::max<int16_t>(y, y + h - 1);
+  rasterPattern(band, x, y0, w, y1 - y0 + 1, SOLID_PATTERN, color);
+  return;
+} // end rasterRect
+
+/* Fills a rectangle with a repeating 8x8 pattern. Row y of the screen uses
+ * pattern[y % 8], in which bit 7 is the pixel with x % 8 == 0. Pixels whose
+ * bit is 0 are left as they are.
+ *
+ * On black and white and 3-color panels, 8 pixels are written at once, and on
+ * 7-color panels 2.
+ */
+void rasterPattern(const epd_band_t &band, int16_t x, int16_t y,
+                   int16_t w, int16_t h, const uint8_t pattern[8],
+                   uint16_t color)
+{
+  int16_t x0 = x;
+  int16_t y0 = y;
+  int16_t x1 = x + w - 1;
+  int16_t y1 = y + h - 1;
+  if (w <= 0 || h <= 0 || !clipToBand(band, x0, y0, x1, y1))
+  {
+    return;
+  }
+#ifdef EPD_FORMAT_7C
+  const uint8_t colors = toColor7(color) * 0x11;
+#endif
+  for (int16_t j = y0; j <= y1; ++j)
+  {
+    const uint8_t bits = pattern[j & 7];
+    if (bits == 0)
+    {
+      continue;
+    }
+#if defined(EPD_FORMAT_BW) || defined(EPD_FORMAT_3C)
+    const uint32_t row = rowIndex(band, j);
+    const uint32_t end = row + x1 / 8;
+    uint8_t mask = 0xFF >> (x0 % 8);
+    for (uint32_t i = row + x0 / 8; i <= end; ++i)
+    {
+      if (i == end)
+      {
+        mask &= static_cast<uint8_t>(0xFF << (7 - x1 % 8));
+      }
+      setBits(band, i, bits & mask, color);
+      mask = 0xFF;
+    }
+#endif
+#ifdef EPD_FORMAT_7C
+    const uint32_t row = rowIndex(band, j);
+    for (int16_t i = x0 & ~1; i <= x1; i += 2)
+    {
+      uint8_t mask = 0;
+      if (i >= x0 && (bits & (0x80 >> (i & 7))))
+      {
+        mask |= 0xF0;
+      }
+      if (i + 1 <= x1 && (bits & (0x40 >> (i & 7))))
+      {
+        mask |= 0x0F;
+      }
+      uint8_t &pair = band.buffer[row + i / 2];
+      pair = (pair & ~mask) | (colors & mask);
+    }
+#endif
+  }
+  return;
+} // end rasterPattern
+
+/* Draws a bitmap, setting pixels to color where the bitmap bit is 0.
+ *
+ * On black and white and 3-color panels the bitmap is copied a byte at a
+ * time, shifted into place when x is not a multiple of 8. On 7-color panels
+ * it is drawn a pixel pair at a time.
+ */
+void rasterBitmap(const epd_band_t &band, int16_t x, int16_t y,
+                  const uint8_t bitmap[], int16_t w, int16_t h,
+                  uint16_t color)
+{
+  const int16_t byteWidth = (w + 7) / 8; // bitmap scanline pad = whole byte
+  int16_t x0 = x;
+  int16_t y0 = y;
+  int16_t x1 = x + w - 1;
+  int16_t y1 = y + h - 1;
+  if (w <= 0 || h <= 0 || !clipToBand(band, x0, y0, x1, y1))
+  {
+    return;
+  }
+#if defined(EPD_FORMAT_BW) || defined(EPD_FORMAT_3C)
+  // bitmap byte k is drawn over buffer bytes dst0 + k and dst0 + k + 1
+  const uint8_t shift = x & 7;
+  const int16_t dst0 = (x - shift) / 8;
+  const int16_t dst_bytes = byteWidth + (shift != 0);
+  // the padding bits of the last byte of each row are not drawn
+  const uint8_t pad_mask = 0xFF << (byteWidth * 8 - w);
+#endif
+#ifdef EPD_FORMAT_7C
+  const uint8_t colors = toColor7(color) * 0x11;
+#endif
+  for (int16_t j = y0; j <= y1; ++j)
+  {
+    const uint8_t *src = &bitmap[(j - y) * byteWidth];
+#if defined(EPD_FORMAT_BW) || defined(EPD_FORMAT_3C)
+    const uint32_t row = rowIndex(band, j);
+    uint8_t carry = 0;
+    for (int16_t k = 0; k < dst_bytes; ++k)
+    {
+      uint8_t ink = 0; // pixels to set, where the bitmap bit is 0
+      if (k < byteWidth)
+      {
+        ink = ~pgm_read_byte(&src[k]);
+        if (k == byteWidth - 1)
+        {
+          ink &= pad_mask;
+        }
+      }
+      const uint8_t bits = static_cast<uint8_t>(carry << (8 - shift))
+                           | (ink >> shift);
+      carry = ink;
+      const int16_t d = dst0 + k;
+      if (bits != 0 && d >= 0 && d < EPD_ROW_BYTES)
+      {
+        setBits(band, row + d, bits, color);
+      }
+    }
+#endif
+#ifdef EPD_FORMAT_7C
+    const uint32_t row = rowIndex(band, j);
+    uint8_t mask = 0; // nibbles of the pixel pair at i / 2 to set
+    for (int16_t i = x0; i <= x1;)
+    {
+      // the pixels from i to the end of bitmap byte b / 8
+      const int16_t b = i - x;
+      const int16_t end = std::min<int16_t>(x1, i + 7 - (b & 7));
+      const uint8_t ink = ~pgm_read_byte(&src[b / 8]) & (0xFF >> (b & 7));
+      if (ink == 0)
+      {
+        // skip the byte, setting the pair left over from the one before
+        if (mask != 0)
+        {
+          uint8_t &pair = band.buffer[row + i / 2];
+          pair = (pair & ~mask) | (colors & mask);
+          mask = 0;
+        }
+        i = end + 1;
+        continue;
+      }
+      for (; i <= end; ++i)
+      {
+        if (ink & (0x80 >> ((i - x) & 7)))
+        {
+          mask |= (i & 1) ? 0x0F : 0xF0;
+        }
+        if (((i & 1) || i == x1) && mask != 0)
+        {
+          uint8_t &pair = band.buffer[row + i / 2];
+          pair = (pair & ~mask) | (colors & mask);
+          mask = 0;
+        }
+      }
+    }
+#endif
+  }
+  return;
+} // end rasterBitmap
+
+/* Draws character c of a custom font with its baseline origin at (x, y), as
+ * Adafruit_GFX::drawChar does without scaling. Rows of the glyph outside of
+ * the band are skipped.
+ */
+void rasterGlyph(const epd_band_t &band, const GFXfont *font, uint8_t c,
+                 int16_t x, int16_t y, uint16_t color)
+{
+  if (c < font->first || c > font->last)
+  {
+    return;
+  }
+  const GFXglyph &glyph = font->glyph[c - font->first];
+  const uint8_t *bitmap = font->bitmap + glyph.bitmapOffset;
+  const int16_t gx = x + glyph.xOffset;
+  const int16_t gy = y + glyph.yOffset;
+  // rows of the glyph within the band
+  const int16_t r0 = std::max(0, band.ys - gy);
+  const int16_t r1 = std::min(glyph.height - 1, band.ye - gy);
+  // glyph bitmaps are packed, rows are not padded to whole bytes
+  uint32_t bit = static_cast<uint32_t>(r0) * glyph.width;
+  for (int16_t r = r0; r <= r1; ++r)
+  {
+    for (int16_t i = 0; i < glyph.width; ++i, ++bit)
+    {
+      if ((pgm_read_byte(&bitmap[bit / 8]) & (0x80 >> (bit & 7)))
+       && gx + i >= 0 && gx + i < EPD_WIDTH)
+      {
+        setPixel(band, gx + i, gy + r, color);
+      }
+    }
+  }
+  return;
+} // end rasterGlyph
+
+#if DISPLAY_LIST
+/* Draws the operations of a display list that touch the band. The list is
+ * only read, so that several bands can be drawn from it at the same time.
+ */
+void rasterOps(const epd_band_t &band, const dl_op_t *ops, uint16_t len)
+{
+  const void *ptr = nullptr;
+  for (uint16_t i = 0; i < len; ++i)
+  {
+    const dl_op_t &op = ops[i];
+    // rows drawn by the operation
+    int16_t y0 = op.y;
+    int16_t y1 = op.y;
+    switch (op.type)
+    {
+    case DL_PTR:
+      ptr = op.ptr;
+      continue;
+    case DL_GLYPH:
+    {
+      const GFXfont *f = static_cast<const GFXfont *>(ptr);
+      const GFXglyph &glyph = f->glyph[op.arg - f->first];
+      y0 = op.y + glyph.yOffset;
+      y1 = y0 + glyph.height - 1;
+      break;
+    }
+    case DL_LINE:
+      y0 = std::min(op.y, op.size.h);
+      y1 = std::max(op.y, op.size.h);
+      break;
+    case DL_FILL_RECT:
+      y0 = std::min<int16_t>(op.y, op.y + op.size.h - 1);
+      y1 = std::max<int16_t>(op.y, op.y + op.size.h - 1);
+      break;
+    case DL_BITMAP:
+    case DL_PATTERN:
+      y1 = op.y + op.size.h - 1;
+      break;
+    case DL_FILL_SCREEN:
+      y0 = band.ys;
+      y1 = band.ye;
+      break;
+    case DL_THICK_LINE:
+      y0 = std::min(op.y, op.size.h);
+      y1 = std::max(op.y, op.size.h) + 1;
+      break;
+    default:
+      break;
+    }
+    if (y1 < band.ys || y0 > band.ye)
+    {
+      continue;
+    }
+
+    switch (op.type)
+    {
+    case DL_GLYPH:
+      rasterGlyph(band, static_cast<const GFXfont *>(ptr), op.arg,
+                  op.x, op.y, op.color);
+      break;
+    case DL_PIXELS:
+      rasterDottedHLine(band, op.x, op.y, (op.size.w - 1) * op.size.h + 1,
+                        op.size.h, op.color);
+      break;
+    case DL_LINE:
+      rasterLine(band, op.x, op.y, op.size.w, op.size.h, op.color);
+      break;
+    case DL_FILL_RECT:
+      rasterRect(band, op.x, op.y, op.size.w, op.size.h, op.color);
+      break;
+    case DL_BITMAP:
+      rasterBitmap(band, op.x, op.y, static_cast<const uint8_t *>(ptr),
+                   op.size.w, op.size.h, op.color);
+      break;
+    case DL_FILL_SCREEN:
+      rasterFill(band, op.color);
+      break;
+    case DL_PATTERN:
+      rasterPattern(band, op.x, op.y, op.size.w, op.size.h,
+                    static_cast<const uint8_t *>(ptr), op.color);
+      break;
+    case DL_THICK_LINE:
+      rasterThickLine(band, op.x, op.y, op.size.w, op.size.h, op.color);
+      break;
+    default:
+      break;
+    }
+  }
+  return;
+} // end rasterOps
+#endif
@@ -0,0 +1,122 @@
+/* Frame comparison for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include "frame_diff.h"
+
+/* Compares two 1-bit frames of the given size in tiles and collects the
+ * regions that differ as rectangles. Horizontally adjacent dirty tiles are
+ * joined into one rectangle, which grows downwards while the tiles below span
+ * the same columns. If there are more than max_rects rectangles, a single
+ * rectangle bounding all dirty tiles is returned instead.
+ *
+ * Frames may be at most DIRTY_MAX_WIDTH pixels wide.
+ *
+ * Returns the number of rectangles.
+ */
+int findDirtyRects(const uint8_t *prev, const uint8_t *cur,
+                   int16_t width, int16_t height,
+                   epd_rect_t *rects, int max_rects)
+{
+  const size_t row_bytes = width / 8;
+  const int tile_cols = (row_bytes + DIRTY_TILE_BYTES - 1) / DIRTY_TILE_BYTES;
+  const int16_t tile_w = DIRTY_TILE_BYTES * 8;
+  int16_t x0 = width, y0 = height, x1 = 0, y1 = 0;
+  bool overflow = false;
+  int n = 0;
+
+  for (int16_t ty = 0; ty < height; ty += DIRTY_TILE_ROWS)
+  {
+    int16_t th = std::min<int16_t>(DIRTY_TILE_ROWS, height - ty);
+    uint32_t mask = 0;
+    for (int16_t row = ty; row < ty + th; ++row)
+    {
+      size_t offset = static_cast<size_t>(row) * row_bytes;
+      for (int col = 0; col < tile_cols; ++col)
+      {
+        size_t start = col * DIRTY_TILE_BYTES;
+        size_t len = std::min<size_t>(DIRTY_TILE_BYTES, row_bytes - start);
+        if (!(mask & (1UL << col))
+         && memcmp(prev + offset + start, cur + offset + start, len) != 0)
+        {
+          mask |= 1UL << col;
+        }
+      }
+    }
+
+    int col = 0;
+    while (col < tile_cols)
+    {
+      if (!(mask & (1UL << col)))
+      {
+        ++col;
+        continue;
+      }
+      int run_start = col;
+      while (col < tile_cols && (mask & (1UL << col)))
+      {
+        ++col;
+      }
+      epd_rect_t r;
+      r.x = run_start * tile_w;
+      r.w = std::min<int16_t>(col * tile_w, width) - r.x;
+      r.y = ty;
+      r.h = th;
+      x0 = std::min(x0, r.x);
+      y0 = std::min(y0, r.y);
+      x1 = std::max<int16_t>(x1, r.x + r.w);
+      y1 = std::max<int16_t>(y1, r.y + r.h);
+      if (overflow)
+      {
+        continue;
+      }
+
+      bool merged = false;
+      for (int i = 0; i < n; ++i)
+      {
+        if (rects[i].x == r.x && rects[i].w == r.w
+         && rects[i].y + rects[i].h == r.y)
+        {
+          rects[i].h += r.h;
+          merged = true;
+          break;
+        }
+      }
+      if (!merged)
+      {
+        if (n < max_rects)
+        {
+          rects[n++] = r;
+        }
+        else
+        {
+          overflow = true;
+        }
+      }
+    }
+  }
+
+  if (overflow)
+  {
+    rects[0] = {x0, y0, static_cast<int16_t>(x1 - x0),
+                static_cast<int16_t>(y1 - y0)};
+    n = 1;
+  }
+  return n;
+} // end findDirtyRects
@@ -0,0 +1,268 @@
+/* Frame storage for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "config.h"
+#include "frame_store.h"
+#include "logging.h"
+#include "storage.h"
+
+// Frames are stored PackBits compressed. A rendered frame is mostly long runs
+// of white (0xFF) bytes, so a 48kB frame typically compresses to a few kB.
+static const char *FRAME_PATH = "/frame.bin";
+static const uint32_t FRAME_MAGIC = 0x46445045; // "EPDF"
+// The chrome layer (see CHROME_CACHE) is stored the same way, as a sequence of
+// buffer planes that are each compressed separately, so that they can be read
+// one page at a time while the frame is drawn.
+static const char *CHROME_PATH = "/chrome.bin";
+static const char *CHROME_TMP_PATH = "/chrome.tmp";
+static const uint32_t CHROME_MAGIC = 0x43445045; // "EPDC"
+
+/* Reads the next len bytes of PackBits compressed data from the file.
+ *
+ * Returns true if exactly len bytes were decompressed.
+ */
+bool readPacked(File &file, uint8_t *data, size_t len)
+{
+  size_t pos = 0;
+  while (pos < len)
+  {
+    int n = file.read();
+    if (n < 0)
+    {
+      break;
+    }
+    if (n < 128)
+    { // literal run of n + 1 bytes
+      size_t count = n + 1;
+      if (pos + count > len || file.read(data + pos, count) != count)
+      {
+        break;
+      }
+      pos += count;
+    }
+    else if (n > 128)
+    { // single byte repeated 257 - n times
+      size_t count = 257 - n;
+      int value = file.read();
+      if (value < 0 || pos + count > len)
+      {
+        break;
+      }
+      memset(data + pos, value, count);
+      pos += count;
+    }
+  }
+  return pos == len;
+} // end readPacked
+
+/* Writes len bytes of data to the file, PackBits compressed. Runs never span
+ * two calls, so the data can be read back by the same sequence of calls to
+ * readPacked().
+ *
+ * Returns the number of bytes written, or 0 if the write failed.
+ */
+size_t writePacked(File &file, const uint8_t *data, size_t len)
+{
+  uint8_t out[512];
+  size_t n = 0;
+  size_t i = 0;
+  size_t written = 0;
+  bool ok = true;
+  while (ok && i < len)
+  {
+    size_t run = 1;
+    while (i + run < len && run < 128 && data[i + run] == data[i])
+    {
+      ++run;
+    }
+    if (run >= 2)
+    {
+      out[n++] = static_cast<uint8_t>(257 - run);
+      out[n++] = data[i];
+      i += run;
+    }
+    else
+    { // literal bytes continue until the next repeated byte
+      size_t start = i;
+      size_t count = 0;
+      do
+      {
+        ++i;
+        ++count;
+      } while (i < len && count < 128
+               && !(i + 1 < len && data[i + 1] == data[i]));
+      out[n++] = static_cast<uint8_t>(count - 1);
+      memcpy(out + n, data + start, count);
+      n += count;
+    }
+
+    // flush before the next packet (at most 129 bytes) could overflow
+    if (n > sizeof(out) - 129 || i >= len)
+    {
+      ok = file.write(out, n) == n;
+      written += n;
+      n = 0;
+    }
+  }
+  return ok ? written : 0;
+} // end writePacked
+
+/* Reads the last saved frame into the given buffer.
+ *
+ * Returns true if a frame of exactly len bytes was restored.
+ */
+bool loadFrame(uint8_t *frame, size_t len)
+{
+  if (!mountStorage() || !LittleFS.exists(FRAME_PATH))
+  {
+    return false;
+  }
+  File file = LittleFS.open(FRAME_PATH, "r");
+  if (!file)
+  {
+    return false;
+  }
+
+  uint32_t header[2] = {};
+  bool ok = file.read(reinterpret_cast<uint8_t *>(header), sizeof(header))
+            == sizeof(header)
+         && header[0] == FRAME_MAGIC
+         && header[1] == len
+         && readPacked(file, frame, len);
+  file.close();
+
+  LOG_DEBUG("Frame restored  : %s", ok ? "true" : "false");
+  return ok;
+} // end loadFrame
+
+/* Saves the given frame, replacing the previously saved frame.
+ *
+ * Returns true if the frame was written successfully.
+ */
+bool saveFrame(const uint8_t *frame, size_t len)
+{
+  if (!mountStorage())
+  {
+    return false;
+  }
+  File file = LittleFS.open(FRAME_PATH, "w");
+  if (!file)
+  {
+    return false;
+  }
+
+  const uint32_t header[2] = {FRAME_MAGIC, static_cast<uint32_t>(len)};
+  bool ok = file.write(reinterpret_cast<const uint8_t *>(header),
+                       sizeof(header)) == sizeof(header);
+  size_t written = sizeof(header);
+  if (ok)
+  {
+    size_t n = writePacked(file, frame, len);
+    ok = n > 0;
+    written += n;
+  }
+  file.close();
+
+  LOG_DEBUG("Frame saved     : %uB (%uB raw)", static_cast<unsigned>(written),
+            static_cast<unsigned>(len));
+  return ok;
+} // end saveFrame
+
+/* Opens the saved chrome layer for reading with readPacked(), if it was saved
+ * with the same key and buffer planes of len bytes.
+ *
+ * Returns a closed file if there is no such chrome layer.
+ */
+File openChrome(uint32_t key, size_t len)
+{
+  if (!mountStorage() || !LittleFS.exists(CHROME_PATH))
+  {
+    return File();
+  }
+  File file = LittleFS.open(CHROME_PATH, "r");
+  uint32_t header[3] = {};
+  if (file
+   && (file.read(reinterpret_cast<uint8_t *>(header), sizeof(header))
+       != sizeof(header)
+    || header[0] != CHROME_MAGIC
+    || header[1] != len
+    || header[2] != key))
+  {
+    file.close();
+  }
+  return file;
+} // end openChrome
+
+/* Creates a chrome layer of buffer planes of len bytes, to be written with
+ * writePacked(). It only replaces the saved chrome layer once committed.
+ *
+ * Returns a closed file if the chrome layer could not be created.
+ */
+File createChrome(uint32_t key, size_t len)
+{
+  if (!mountStorage())
+  {
+    return File();
+  }
+  File file = LittleFS.open(CHROME_TMP_PATH, "w");
+  const uint32_t header[3] = {CHROME_MAGIC, static_cast<uint32_t>(len), key};
+  if (file
+   && file.write(reinterpret_cast<const uint8_t *>(header), sizeof(header))
+      != sizeof(header))
+  {
+    file.close();
+    LittleFS.remove(CHROME_TMP_PATH);
+  }
+  return file;
+} // end createChrome
+
+/* Closes a chrome layer created by createChrome(). If ok, it replaces the
+ * saved chrome layer, otherwise it is discarded.
+ *
+ * Returns true if the chrome layer was saved.
+ */
+bool commitChrome(File &file, bool ok)
+{
+  const size_t size = file.size();
+  file.close();
+  if (ok)
+  {
+    LittleFS.remove(CHROME_PATH);
+    ok = LittleFS.rename(CHROME_TMP_PATH, CHROME_PATH);
+  }
+  if (!ok)
+  {
+    LittleFS.remove(CHROME_TMP_PATH);
+  }
+  LOG_DEBUG("Chrome saved    : %uB %s", static_cast<unsigned>(size),
+            ok ? "true" : "false");
+  return ok;
+} // end commitChrome
+
+/* Deletes the saved chrome layer, so that it is drawn and saved again.
+ */
+void removeChrome()
+{
+  if (mountStorage())
+  {
+    LittleFS.remove(CHROME_PATH);
+  }
+  return;
+} // end removeChrome
@@ -0,0 +1,101 @@
+/* Logging for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdarg>
+#include <cstdio>
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "config.h"
+#include "logging.h"
+
+// Log lines are formatted on the stack and written to the UART driver's
+// transmit buffer, which the UART interrupt drains in the background. The
+// wake only blocks if the buffer fills up, instead of on every line once the
+// 128 byte hardware FIFO is full.
+
+static const unsigned long LOG_BAUD_RATE = 115200;
+static const size_t LOG_TX_BUFFER_SIZE   = 4096; // bytes
+static const size_t LOG_LINE_MAX         = 256;  // bytes, longer is truncated
+
+static size_t  logBytes     = 0;
+static int64_t logBlockedUs = 0;
+
+/* Starts the serial port, unless logging is disabled (DEBUG_LEVEL -1).
+ */
+void initLogging()
+{
+#if DEBUG_LEVEL >= 0
+  Serial.setTxBufferSize(LOG_TX_BUFFER_SIZE); // must precede begin()
+  Serial.begin(LOG_BAUD_RATE);
+#endif
+  return;
+} // end initLogging
+
+/* Formats and writes a log message. Use the LOG_* macros instead.
+ */
+void logPrintf(const char *format, ...)
+{
+  char line[LOG_LINE_MAX];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  if (len < 0)
+  {
+    return;
+  }
+  if (static_cast<size_t>(len) >= sizeof(line))
+  { // truncated, keep the line break
+    len = sizeof(line) - 1;
+    line[len - 1] = '\n';
+  }
+
+  const int64_t start = esp_timer_get_time();
+  Serial.write(reinterpret_cast<const uint8_t *>(line), len);
+  logBlockedUs += esp_timer_get_time() - start;
+  logBytes += len;
+  return;
+} // end logPrintf
+
+/* Waits until all log output has been sent. Must be called before deep sleep,
+ * which would discard it.
+ */
+void flushLog()
+{
+#if DEBUG_LEVEL >= 0
+  Serial.flush();
+#endif
+  return;
+} // end flushLog
+
+/* Prints how long logging has blocked the wake, and how long writing the same
+ * output without a transmit buffer would have.
+ */
+void printLogStats()
+{
+#if DEBUG_LEVEL >= 1
+  // 10 bits per byte, less what fits in the hardware FIFO
+  const unsigned long unbufferedMs = logBytes > 128
+                                     ? (logBytes - 128) * 10000UL
+                                       / LOG_BAUD_RATE
+                                     : 0;
+  LOG_DEBUG("Log output      : %uB, blocked %lums (unbuffered ~%lums)",
+            static_cast<unsigned>(logBytes),
+            static_cast<unsigned long>(logBlockedUs / 1000), unbufferedMs);
+#endif
+  return;
+} // end printLogStats
@@ -16,6 +16,7 @@
  */
 
 #include "config.h"
+#include <algorithm>
 #include <Arduino.h>
 #include <Adafruit_Sensor.h>
 #include <Preferences.h>
@@ -25,11 +26,21 @@
 
 #include "_locale.h"
 #include "api_response.h"
+#include "battery_model.h"
 #include "client_utils.h"
+#include "alerts_probe.h"
 #include "config.h"
+#include "cpu_governor.h"
 #include "display_utils.h"
 #include "icons/icons_196x196.h"
+#include "logging.h"
+#include "refresh_policy.h"
 #include "renderer.h"
+#include "rtc_drift.h"
+#include "scheduler.h"
+#include "task_graph.h"
+#include "ulp_sensor.h"
+#include "weather_cache.h"
 
 #if defined(SENSOR_BME280)
   #include <Adafruit_BME280.h>
@@ -44,91 +55,431 @@
   #include "cert.h"
 #endif
 
+// If the frame could not be drawn for lack of memory, the next wake is brought
+// forward to this many minutes from now, so that it is drawn again soon.
+#define DRAW_RETRY_DELAY 5 // minutes
+
 // too large to allocate locally on stack
 static owm_resp_onecall_t       owm_onecall;
 static owm_resp_air_pollution_t owm_air_pollution;
 
 Preferences prefs;
 
+// results of the wake sequence tasks
+static uint32_t    wakeBatteryVoltage     = UINT32_MAX;
+static int         wakeWiFiRSSI           = 0; // “Received Signal Strength Indicator"
+static wl_status_t wakeWiFiStatus         = WL_IDLE_STATUS;
+static bool        wakeTimeConfigured     = false;
+static tm          wakeTimeInfo           = {};
+static int         wakeOnecallStatus      = HTTP_CODE_OK;
+static int         wakeAirPollutionStatus = HTTP_CODE_OK;
+static float       wakeInTemp             = NAN;
+static float       wakeInHumidity         = NAN;
+static String      wakeSensorStatus       = {};
+static bool        wakeDrawFailed         = false;
+
 /* Put esp32 into ultra low-power deep sleep (<11μA).
- * Aligns wake time to the minute. Sleep times defined in config.cpp.
+ * Wakes at the next update of the sleep schedule defined in config.cpp.
  */
 void beginDeepSleep(unsigned long startTime, tm *timeInfo)
 {
   if (!getLocalTime(timeInfo))
   {
-    Serial.println(TXT_REFERENCING_OLDER_TIME_NOTICE);
+    LOG_INFO("%s", TXT_REFERENCING_OLDER_TIME_NOTICE);
   }
 
-  // To simplify sleep time calculations, the current time stored by timeInfo
-  // will be converted to time relative to the WAKE_TIME. This way if a
-  // SLEEP_DURATION is not a multiple of 60 minutes it can be more trivially,
-  // aligned and it can easily be deterimined whether we must sleep for
-  // additional time due to bedtime.
-  // i.e. when curHour == 0, then timeInfo->tm_hour == WAKE_TIME
-  int bedtimeHour = INT_MAX;
-  if (BED_TIME != WAKE_TIME)
+  // wake at the next update of the sleep schedule (see SLEEP_RULES),
+  // compensating for the drift of the RTC that times the sleep
+  const time_t now = mktime(timeInfo);
+  time_t nextUpdate = getNextWakeTime(now);
+  if (wakeDrawFailed)
   {
-    bedtimeHour = (BED_TIME - WAKE_TIME + 24) % 24;
+    LOG_INFO("Frame not drawn, retrying in %d minutes", DRAW_RETRY_DELAY);
+    nextUpdate = std::min<time_t>(nextUpdate, now + DRAW_RETRY_DELAY * 60);
   }
+  const time_t wakeTime = scheduleAlertsProbe(now, nextUpdate);
+  uint64_t sleepDuration = getSleepTimerDuration(wakeTime, wakeInTemp);
 
-  // time is relative to wake time
-  int curHour = (timeInfo->tm_hour - WAKE_TIME + 24) % 24;
-  const int curMinute = curHour * 60 + timeInfo->tm_min;
-  const int curSecond = curHour * 3600
-                      + timeInfo->tm_min * 60
-                      + timeInfo->tm_sec;
-  const int desiredSleepSeconds = SLEEP_DURATION * 60;
-  const int offsetMinutes = curMinute % SLEEP_DURATION;
-  const int offsetSeconds = curSecond % desiredSleepSeconds;
-
-  // align wake time to nearest multiple of SLEEP_DURATION
-  int sleepMinutes = SLEEP_DURATION - offsetMinutes;
-  if (desiredSleepSeconds - offsetSeconds < 120
-   || offsetSeconds / (float)desiredSleepSeconds > 0.95f)
-  { // if we have a sleep time less than 2 minutes OR less 5% SLEEP_DURATION,
-    // skip to next alignment
-    sleepMinutes += SLEEP_DURATION;
+#if DEBUG_LEVEL >= 1
+  printHeapUsage();
+  printCpuEnergy();
+  printLogStats();
+#endif
+
+  esp_sleep_enable_timer_wakeup(sleepDuration);
+#if SENSOR_ULP_SAMPLING
+  startUlpSampling(sleepDuration);
+#endif
+  LOG_INFO("%s %.3fs", TXT_AWAKE_FOR, (millis() - startTime) / 1000.0);
+  LOG_INFO("%s %lus", TXT_ENTERING_DEEP_SLEEP_FOR,
+           static_cast<unsigned long>(sleepDuration / 1000000ULL));
+  flushLog();
+  esp_deep_sleep_start();
+} // end beginDeepSleep
+
+/* Wake sequence task. Connects to WiFi, synchronizes the time and makes the
+ * API requests. Stops at the first step that fails; renderTask() then shows
+ * the corresponding error screen.
+ */
+static void networkTask()
+{
+  // START WIFI
+  wakeWiFiStatus = startWiFi(wakeWiFiRSSI);
+  if (wakeWiFiStatus != WL_CONNECTED)
+  { // WiFi Connection Failed
+    killWiFi();
+    return;
   }
 
-  // estimated wake time, if this falls in a sleep period then sleepDuration
-  // must be adjusted
-  const int predictedWakeHour = ((curMinute + sleepMinutes) / 60) % 24;
+  // TIME SYNCHRONIZATION
+  configTzTime(TIMEZONE, NTP_SERVER_1, NTP_SERVER_2);
+  wakeTimeConfigured = waitForSNTPSync(&wakeTimeInfo);
+  if (!wakeTimeConfigured)
+  {
+    killWiFi();
+    return;
+  }
+  updateRtcDrift();
 
-  uint64_t sleepDuration;
-  if (predictedWakeHour < bedtimeHour)
+  // MAKE API REQUESTS
+#ifdef USE_HTTP
+  WiFiClient client;
+#elif defined(USE_HTTPS_NO_CERT_VERIF)
+  WiFiClientSecure client;
+  client.setInsecure();
+#elif defined(USE_HTTPS_WITH_CERT_VERIF)
+  WiFiClientSecure client;
+  client.setCACert(cert_Sectigo_Public_Server_Authentication_Root_R46);
+#endif
+  // only the sections that are no longer fresh are requested, the rest is
+  // taken from the cache (see REFRESH_POLICY)
+  const int64_t now = time(nullptr);
+  const uint8_t oneCall = getUsedSections() & DATA_ONECALL;
+  uint8_t sections = getStaleSections(now);
+  int64_t dt = now;
+  if ((sections & oneCall) != oneCall
+   && !loadOneCallCache(owm_onecall, now, dt, false))
+  {
+    sections |= oneCall;
+  }
+  if (!(sections & DATA_AIR_POLLUTION)
+   && !loadAirPollutionCache(owm_air_pollution, now))
   {
-    sleepDuration = sleepMinutes * 60 - timeInfo->tm_sec;
+    sections |= DATA_AIR_POLLUTION;
+  }
+  LOG_DEBUG("Stale sections  : 0x%02x", sections);
+
+  if (sections & DATA_ONECALL)
+  {
+    wakeOnecallStatus = getOWMonecall(client, owm_onecall,
+                                      sections & oneCall);
+  }
+  if (wakeOnecallStatus != HTTP_CODE_OK)
+  {
+    killWiFi();
+    return;
+  }
+  setSunTimes(owm_onecall.current.sunrise, owm_onecall.current.sunset);
+  rememberAlerts(owm_onecall.alerts);
+  if (sections & DATA_AIR_POLLUTION)
+  {
+    wakeAirPollutionStatus = getOWMairpollution(client, owm_air_pollution);
+  }
+  killWiFi(); // WiFi no longer needed
+  recordSkippedSections(~sections);
+#if DEBUG_LEVEL >= 1
+  printApiUsage();
+#endif
+  return;
+} // end networkTask
+
+/* Checks the weather alerts, without synchronizing the time.
+ *
+ * Returns true if the alerts have changed since the display was last updated,
+ * and the display should be updated now.
+ */
+static bool probeAlerts()
+{
+  int wifiRSSI = 0;
+  if (startWiFi(wifiRSSI) != WL_CONNECTED)
+  {
+    killWiFi();
+    return false;
+  }
+#ifdef USE_HTTP
+  WiFiClient client;
+#elif defined(USE_HTTPS_NO_CERT_VERIF)
+  WiFiClientSecure client;
+  client.setInsecure();
+#elif defined(USE_HTTPS_WITH_CERT_VERIF)
+  WiFiClientSecure client;
+  client.setCACert(cert_Sectigo_Public_Server_Authentication_Root_R46);
+#endif
+  const int status = getOWMalerts(client, owm_onecall);
+  killWiFi();
+  const bool changed = status == HTTP_CODE_OK
+                       && alertsChanged(owm_onecall.alerts);
+  LOG_DEBUG("Alerts changed  : %s", changed ? "true" : "false");
+  return changed;
+} // end probeAlerts
+
+#if SENSOR_FAST_MEASUREMENT
+// Single measurements without oversampling are noisier, so the readings are
+// smoothed across wakes by an exponential moving average kept in RTC memory.
+// A change larger than the noise is taken as real and restarts the average.
+static const float SENSOR_FILTER_WEIGHT   = 0.5f; // weight of a new reading
+static const float SENSOR_RESET_TEMP      = 0.5f; // Celsius
+static const float SENSOR_RESET_HUMIDITY  = 3.0f; // %
+RTC_DATA_ATTR static float filteredInTemp     = NAN;
+RTC_DATA_ATTR static float filteredInHumidity = NAN;
+
+/* Smooths a sensor reading with the readings of previous wakes.
+ */
+static float filterReading(float reading, float &filtered, float resetDelta)
+{
+  if (std::isnan(filtered) || std::abs(reading - filtered) > resetDelta)
+  {
+    filtered = reading;
   }
   else
   {
-    const int hoursUntilWake = 24 - curHour;
-    sleepDuration = hoursUntilWake * 3600ULL
-                    - (timeInfo->tm_min * 60ULL + timeInfo->tm_sec);
+    filtered += SENSOR_FILTER_WEIGHT * (reading - filtered);
   }
+  return filtered;
+} // end filterReading
+#endif
 
-  // add extra delay to compensate for esp32's with fast RTCs.
-  sleepDuration += 3ULL;
-  sleepDuration *= 1.0015f;
+/* Wake sequence task. Reads the indoor temperature and humidity.
+ * This task runs alongside the network task, so waiting for the measurement
+ * overlaps with waiting for WiFi and the API responses.
+ */
+static void sensorTask()
+{
+  // GET INDOOR TEMPERATURE AND HUMIDITY, start BMEx80...
+#if SENSOR_ULP_SAMPLING
+  stopUlpSampling(); // release the sensor pins
+#endif
+#if DEBUG_LEVEL >= 1
+  const unsigned long sensorOnTime = millis();
+#endif
+  pinMode(PIN_BME_PWR, OUTPUT);
+  digitalWrite(PIN_BME_PWR, HIGH);
+#if defined(SENSOR_INIT_DELAY_MS) && SENSOR_INIT_DELAY_MS > 0
+  delay(SENSOR_INIT_DELAY_MS);
+#endif
+  TwoWire I2C_bme = TwoWire(0);
+  I2C_bme.begin(PIN_BME_SDA, PIN_BME_SCL, 100000); // 100kHz
+#if defined(SENSOR_BME280)
+  const char *sensorName = "BME280";
+#if SENSOR_ULP_SAMPLING
+  UlpBME280 bme;
+#else
+  Adafruit_BME280 bme;
+#endif
+
+  if(bme.begin(BME_ADDRESS, &I2C_bme))
+  {
+#endif
+#if defined(SENSOR_BME680)
+  const char *sensorName = "BME680";
+  Adafruit_BME680 bme(&I2C_bme);
+
+  if(bme.begin(BME_ADDRESS))
+  {
+#endif
+#if SENSOR_FAST_MEASUREMENT && defined(SENSOR_BME280)
+    // forced mode, temperature and humidity x1, no pressure, no filter
+    bme.setSampling(Adafruit_BME280::MODE_FORCED,
+                    Adafruit_BME280::SAMPLING_X1,
+                    Adafruit_BME280::SAMPLING_NONE,
+                    Adafruit_BME280::SAMPLING_X1,
+                    Adafruit_BME280::FILTER_OFF);
+    if (bme.takeForcedMeasurement())
+    {
+      wakeInTemp     = bme.readTemperature(); // Celsius
+      wakeInHumidity = bme.readHumidity();    // %
+    }
+#elif SENSOR_FAST_MEASUREMENT && defined(SENSOR_BME680)
+    // temperature and humidity x1, no pressure, no filter, gas heater off
+    bme.setTemperatureOversampling(BME680_OS_1X);
+    bme.setHumidityOversampling(BME680_OS_1X);
+    bme.setPressureOversampling(BME680_OS_NONE);
+    bme.setIIRFilterSize(BME680_FILTER_SIZE_0);
+    bme.setGasHeater(0, 0);
+    if (bme.performReading())
+    {
+      wakeInTemp     = bme.temperature; // Celsius
+      wakeInHumidity = bme.humidity;    // %
+    }
+#else
+    wakeInTemp     = bme.readTemperature(); // Celsius
+    wakeInHumidity = bme.readHumidity();    // %
+#endif
 
+    // check if BME readings are valid
+    // note: readings are checked again before drawing to screen. If a reading
+    //       is not a number (NAN) then an error occurred, a dash '-' will be
+    //       displayed.
+    if (std::isnan(wakeInTemp) || std::isnan(wakeInHumidity))
+    {
+      wakeSensorStatus = "BME " + String(TXT_READ_FAILED);
+      LOG_INFO("%s %s... %s", TXT_READING_FROM, sensorName,
+               wakeSensorStatus.c_str());
+    }
+    else
+    {
+      LOG_INFO("%s %s... %s", TXT_READING_FROM, sensorName, TXT_SUCCESS);
+#if SENSOR_FAST_MEASUREMENT
+      wakeInTemp = filterReading(wakeInTemp, filteredInTemp,
+                                 SENSOR_RESET_TEMP);
+      wakeInHumidity = filterReading(wakeInHumidity, filteredInHumidity,
+                                     SENSOR_RESET_HUMIDITY);
+#endif
+#if SENSOR_ULP_SAMPLING
+      bme.loadUlpHistory();
+#endif
+    }
+  }
+  else
+  {
+    wakeSensorStatus = "BME " + String(TXT_NOT_FOUND); // check wiring
+    LOG_INFO("%s %s... %s", TXT_READING_FROM, sensorName,
+             wakeSensorStatus.c_str());
+  }
+  digitalWrite(PIN_BME_PWR, LOW);
 #if DEBUG_LEVEL >= 1
-  printHeapUsage();
+  LOG_DEBUG("Sensor on       : %lums", millis() - sensorOnTime);
 #endif
+  return;
+} // end sensorTask
 
-  esp_sleep_enable_timer_wakeup(sleepDuration * 1000000ULL);
-  Serial.print(TXT_AWAKE_FOR);
-  Serial.println(" "  + String((millis() - startTime) / 1000.0, 3) + "s");
-  Serial.print(TXT_ENTERING_DEEP_SLEEP_FOR);
-  Serial.println(" " + String(sleepDuration) + "s");
-  esp_deep_sleep_start();
-} // end beginDeepSleep
+/* Wake sequence task. Powers on and initializes the display.
+ */
+static void displayTask()
+{
+  initDisplay();
+  return;
+} // end displayTask
+
+/* Wake sequence task. Draws the weather, or an error screen if any step of
+ * networkTask() failed, and refreshes the display.
+ */
+static void renderTask()
+{
+  String statusStr = {};
+  String tmpStr = {};
+  const uint8_t *errorBitmap = nullptr;
+
+  if (wakeWiFiStatus != WL_CONNECTED)
+  {
+    errorBitmap = wifi_x_196x196;
+    statusStr = wakeWiFiStatus == WL_NO_SSID_AVAIL
+                ? TXT_NETWORK_NOT_AVAILABLE
+                : TXT_WIFI_CONNECTION_FAILED;
+    LOG_INFO("%s", statusStr.c_str());
+  }
+  else if (!wakeTimeConfigured)
+  {
+    errorBitmap = wi_time_4_196x196;
+    statusStr = TXT_TIME_SYNCHRONIZATION_FAILED;
+    LOG_INFO("%s", statusStr.c_str());
+  }
+  else if (wakeOnecallStatus != HTTP_CODE_OK
+        || wakeAirPollutionStatus != HTTP_CODE_OK)
+  {
+    int rxStatus;
+    if (wakeOnecallStatus != HTTP_CODE_OK)
+    {
+      statusStr = "One Call " + OWM_ONECALL_VERSION + " API";
+      rxStatus = wakeOnecallStatus;
+    }
+    else
+    {
+      statusStr = "Air Pollution API";
+      rxStatus = wakeAirPollutionStatus;
+    }
+    errorBitmap = wi_cloud_down_196x196;
+    tmpStr = String(rxStatus, DEC) + ": " + getHttpResponsePhrase(rxStatus);
+  }
+
+  // time the weather data was received
+  bool timeConfigured = wakeTimeConfigured;
+  tm dataTimeInfo = wakeTimeInfo;
+  bool stale = false;
+  if (errorBitmap != nullptr)
+  {
+    // draw the last weather data received instead, if it is recent enough,
+    // keeping time with the RTC
+    const bool onecallReceived = wakeWiFiStatus == WL_CONNECTED
+                                 && wakeTimeConfigured
+                                 && wakeOnecallStatus == HTTP_CODE_OK;
+    timeConfigured = getLocalTime(&wakeTimeInfo, 0);
+    const int64_t now = time(nullptr);
+    int64_t dt = now;
+    stale = timeConfigured
+            && (onecallReceived
+                || loadOneCallCache(owm_onecall, now, dt, true))
+            && loadAirPollutionCache(owm_air_pollution, now);
+    if (!stale)
+    {
+      display.firstPage();
+      do
+      {
+        drawError(errorBitmap, statusStr, tmpStr);
+      } while (display.nextPage());
+      wakeDrawFailed = display.allocFailed();
+      powerOffDisplay();
+      return;
+    }
+    const time_t ts = dt;
+    localtime_r(&ts, &dataTimeInfo);
+  }
+  else
+  {
+    statusStr = wakeSensorStatus;
+  }
+
+  String refreshTimeStr;
+  getRefreshTimeStr(refreshTimeStr, timeConfigured, &dataTimeInfo);
+  String dateStr;
+  getDateStr(dateStr, &wakeTimeInfo);
+
+  // RENDER FULL REFRESH
+  // the network requests are done, so their memory is free for the page buffer
+  display.firstPage();
+  restoreChrome();
+  do
+  {
+    CpuBoost boost; // drawing is CPU bound, writing to the panel is not
+    drawCurrentConditions(owm_onecall.current, owm_onecall.daily[0],
+                          owm_air_pollution, wakeInTemp, wakeInHumidity);
+    drawOutlookGraph(owm_onecall.hourly, owm_onecall.daily, wakeTimeInfo);
+    drawForecast(owm_onecall.daily, wakeTimeInfo);
+    drawLocationDate(CITY_STRING, dateStr);
+#if DISPLAY_ALERTS
+    drawAlerts(owm_onecall.alerts, CITY_STRING, dateStr);
+#endif
+    drawStatusBar(statusStr, refreshTimeStr, wakeWiFiRSSI,
+                  wakeBatteryVoltage, stale);
+  } while (display.nextPage());
+  wakeDrawFailed = display.allocFailed();
+  powerOffDisplay();
+  return;
+} // end renderTask
 
 /* Program entry point.
  */
 void setup()
 {
   unsigned long startTime = millis();
-  Serial.begin(115200);
+  // The time zone is not retained during deep sleep. Set it before any local
+  // time is used, so that wakes that skip the network (and the cached data
+  // shown when WiFi fails) are in local time too.
+  setenv("TZ", TIMEZONE, 1);
+  tzset();
+  recordWakeTime();
+  initLogging();
+  initCpuGovernor();
 
 #if DEBUG_LEVEL >= 1
   printHeapUsage();
@@ -136,13 +487,17 @@ void setup()
 
   disableBuiltinLED();
 
+  // If the esp32 slept through the last refresh, the panel has been powered
+  // off now and the update is complete.
+  bool refreshFinished = finishPendingRefresh();
+
   // Open namespace for read/write to non-volatile storage
   prefs.begin(NVS_NAMESPACE, false);
 
 #if BATTERY_MONITORING
   uint32_t batteryVoltage = readBatteryVoltage();
-  Serial.print(TXT_BATTERY_VOLTAGE);
-  Serial.println(": " + String(batteryVoltage) + "mv");
+  LOG_INFO("%s: %umv", TXT_BATTERY_VOLTAGE,
+           static_cast<unsigned>(batteryVoltage));
 
   // When the battery is low, the display should be updated to reflect that, but
   // only the first time we detect low voltage. The next time the display will
@@ -158,6 +513,7 @@ void setup()
       prefs.putBool("lowBat", true);
       prefs.end();
       initDisplay();
+      display.firstPage();
       do
       {
         drawError(battery_alert_0deg_196x196, TXT_LOW_BATTERY);
@@ -169,25 +525,26 @@ void setup()
     { // critically low battery
       // don't set esp_sleep_enable_timer_wakeup();
       // We won't wake up again until someone manually presses the RST button.
-      Serial.println(TXT_CRIT_LOW_BATTERY_VOLTAGE);
-      Serial.println(TXT_HIBERNATING_INDEFINITELY_NOTICE);
+      LOG_INFO("%s", TXT_CRIT_LOW_BATTERY_VOLTAGE);
+      LOG_INFO("%s", TXT_HIBERNATING_INDEFINITELY_NOTICE);
     }
     else if (batteryVoltage <= VERY_LOW_BATTERY_VOLTAGE)
     { // very low battery
       esp_sleep_enable_timer_wakeup(VERY_LOW_BATTERY_SLEEP_INTERVAL
                                     * 60ULL * 1000000ULL);
-      Serial.println(TXT_VERY_LOW_BATTERY_VOLTAGE);
-      Serial.print(TXT_ENTERING_DEEP_SLEEP_FOR);
-      Serial.println(" " + String(VERY_LOW_BATTERY_SLEEP_INTERVAL) + "min");
+      LOG_INFO("%s", TXT_VERY_LOW_BATTERY_VOLTAGE);
+      LOG_INFO("%s %lumin", TXT_ENTERING_DEEP_SLEEP_FOR,
+               VERY_LOW_BATTERY_SLEEP_INTERVAL);
     }
     else
     { // low battery
       esp_sleep_enable_timer_wakeup(LOW_BATTERY_SLEEP_INTERVAL
                                     * 60ULL * 1000000ULL);
-      Serial.println(TXT_LOW_BATTERY_VOLTAGE);
-      Serial.print(TXT_ENTERING_DEEP_SLEEP_FOR);
-      Serial.println(" " + String(LOW_BATTERY_SLEEP_INTERVAL) + "min");
+      LOG_INFO("%s", TXT_LOW_BATTERY_VOLTAGE);
+      LOG_INFO("%s %lumin", TXT_ENTERING_DEEP_SLEEP_FOR,
+               LOW_BATTERY_SLEEP_INTERVAL);
     }
+    flushLog();
     esp_deep_sleep_start();
   }
   // battery is no longer low, reset variable in non-volatile storage
@@ -195,6 +552,7 @@ void setup()
   {
     prefs.putBool("lowBat", false);
   }
+  updateBatteryModel(prefs, batteryVoltage, time(nullptr));
 #else
   uint32_t batteryVoltage = UINT32_MAX;
 #endif
@@ -202,163 +560,35 @@ void setup()
   // All data should have been loaded from NVS. Close filesystem.
   prefs.end();
 
-  String statusStr = {};
-  String tmpStr = {};
   tm timeInfo = {};
 
-  // START WIFI
-  int wifiRSSI = 0; // “Received Signal Strength Indicator"
-  wl_status_t wifiStatus = startWiFi(wifiRSSI);
-  if (wifiStatus != WL_CONNECTED)
-  { // WiFi Connection Failed
-    killWiFi();
-    initDisplay();
-    if (wifiStatus == WL_NO_SSID_AVAIL)
-    {
-      Serial.println(TXT_NETWORK_NOT_AVAILABLE);
-      do
-      {
-        drawError(wifi_x_196x196, TXT_NETWORK_NOT_AVAILABLE);
-      } while (display.nextPage());
-    }
-    else
-    {
-      Serial.println(TXT_WIFI_CONNECTION_FAILED);
-      do
-      {
-        drawError(wifi_x_196x196, TXT_WIFI_CONNECTION_FAILED);
-      } while (display.nextPage());
-    }
-    powerOffDisplay();
-    beginDeepSleep(startTime, &timeInfo);
-  }
-
-  // TIME SYNCHRONIZATION
-  configTzTime(TIMEZONE, NTP_SERVER_1, NTP_SERVER_2);
-  bool timeConfigured = waitForSNTPSync(&timeInfo);
-  if (!timeConfigured)
+  if (refreshFinished)
   {
-    Serial.println(TXT_TIME_SYNCHRONIZATION_FAILED);
-    killWiFi();
-    initDisplay();
-    do
-    {
-      drawError(wi_time_4_196x196, TXT_TIME_SYNCHRONIZATION_FAILED);
-    } while (display.nextPage());
-    powerOffDisplay();
     beginDeepSleep(startTime, &timeInfo);
   }
 
-  // MAKE API REQUESTS
-#ifdef USE_HTTP
-  WiFiClient client;
-#elif defined(USE_HTTPS_NO_CERT_VERIF)
-  WiFiClientSecure client;
-  client.setInsecure();
-#elif defined(USE_HTTPS_WITH_CERT_VERIF)
-  WiFiClientSecure client;
-  client.setCACert(cert_Sectigo_Public_Server_Authentication_Root_R46);
-#endif
-  int rxStatus = getOWMonecall(client, owm_onecall);
-  if (rxStatus != HTTP_CODE_OK)
-  {
-    killWiFi();
-    statusStr = "One Call " + OWM_ONECALL_VERSION + " API";
-    tmpStr = String(rxStatus, DEC) + ": " + getHttpResponsePhrase(rxStatus);
-    initDisplay();
-    do
-    {
-      drawError(wi_cloud_down_196x196, statusStr, tmpStr);
-    } while (display.nextPage());
-    powerOffDisplay();
-    beginDeepSleep(startTime, &timeInfo);
-  }
-  rxStatus = getOWMairpollution(client, owm_air_pollution);
-  if (rxStatus != HTTP_CODE_OK)
+  // Between updates, only check whether the weather alerts have changed.
+  if (isAlertsProbeWake() && !probeAlerts())
   {
-    killWiFi();
-    statusStr = "Air Pollution API";
-    tmpStr = String(rxStatus, DEC) + ": " + getHttpResponsePhrase(rxStatus);
-    initDisplay();
-    do
-    {
-      drawError(wi_cloud_down_196x196, statusStr, tmpStr);
-    } while (display.nextPage());
-    powerOffDisplay();
     beginDeepSleep(startTime, &timeInfo);
   }
-  killWiFi(); // WiFi no longer needed
-
-  // GET INDOOR TEMPERATURE AND HUMIDITY, start BMEx80...
-  pinMode(PIN_BME_PWR, OUTPUT);
-  digitalWrite(PIN_BME_PWR, HIGH);
-#if defined(SENSOR_INIT_DELAY_MS) && SENSOR_INIT_DELAY_MS > 0
-  delay(SENSOR_INIT_DELAY_MS);
-#endif
-  TwoWire I2C_bme = TwoWire(0);
-  I2C_bme.begin(PIN_BME_SDA, PIN_BME_SCL, 100000); // 100kHz
-  float inTemp     = NAN;
-  float inHumidity = NAN;
-#if defined(SENSOR_BME280)
-  Serial.print(String(TXT_READING_FROM) + " BME280... ");
-  Adafruit_BME280 bme;
-
-  if(bme.begin(BME_ADDRESS, &I2C_bme))
-  {
-#endif
-#if defined(SENSOR_BME680)
-  Serial.print(String(TXT_READING_FROM) + " BME680... ");
-  Adafruit_BME680 bme(&I2C_bme);
-
-  if(bme.begin(BME_ADDRESS))
-  {
-#endif
-    inTemp     = bme.readTemperature(); // Celsius
-    inHumidity = bme.readHumidity();    // %
-
-    // check if BME readings are valid
-    // note: readings are checked again before drawing to screen. If a reading
-    //       is not a number (NAN) then an error occurred, a dash '-' will be
-    //       displayed.
-    if (std::isnan(inTemp) || std::isnan(inHumidity))
-    {
-      statusStr = "BME " + String(TXT_READ_FAILED);
-      Serial.println(statusStr);
-    }
-    else
-    {
-      Serial.println(TXT_SUCCESS);
-    }
-  }
-  else
-  {
-    statusStr = "BME " + String(TXT_NOT_FOUND); // check wiring
-    Serial.println(statusStr);
-  }
-  digitalWrite(PIN_BME_PWR, LOW);
-
-  String refreshTimeStr;
-  getRefreshTimeStr(refreshTimeStr, timeConfigured, &timeInfo);
-  String dateStr;
-  getDateStr(dateStr, &timeInfo);
 
-  // RENDER FULL REFRESH
-  initDisplay();
-  do
-  {
-    drawCurrentConditions(owm_onecall.current, owm_onecall.daily[0],
-                          owm_air_pollution, inTemp, inHumidity);
-    drawOutlookGraph(owm_onecall.hourly, owm_onecall.daily, timeInfo);
-    drawForecast(owm_onecall.daily, timeInfo);
-    drawLocationDate(CITY_STRING, dateStr);
-#if DISPLAY_ALERTS
-    drawAlerts(owm_onecall.alerts, CITY_STRING, dateStr);
-#endif
-    drawStatusBar(statusStr, refreshTimeStr, wifiRSSI, batteryVoltage);
-  } while (display.nextPage());
-  powerOffDisplay();
+  // The remaining wake sequence runs as a task graph, so that the sensor and
+  // display are brought up while the radio waits on the network.
+  wakeBatteryVoltage = batteryVoltage;
+  graph_task_t wakeTasks[] = {
+    // name     run          deps                                  core stack
+    {"network", networkTask, 0,                                        0, 8192},
+    {"sensor",  sensorTask,  0,                                        1, 4096},
+    {"display", displayTask, 0,                                        1, 6144},
+    {"render",  renderTask,  TASK_DEP(0) | TASK_DEP(1) | TASK_DEP(2),  1, 8192},
+  };
+  const size_t numWakeTasks = sizeof(wakeTasks) / sizeof(wakeTasks[0]);
+  runTaskGraph(wakeTasks, numWakeTasks);
+  printCriticalPath(wakeTasks, numWakeTasks);
 
   // DEEP SLEEP
+  timeInfo = wakeTimeInfo;
   beginDeepSleep(startTime, &timeInfo);
 } // end setup
 
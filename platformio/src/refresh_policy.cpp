@@ -0,0 +1,168 @@
+/* Data refresh policy for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <Arduino.h>
+#include "config.h"
+#include "logging.h"
+#include "refresh_policy.h"
+
+// Each section of the weather data is refreshed once it is older than the
+// maximum age of its policy; the rest is taken from the cache (see
+// weather_cache.cpp). The time each section was last received is kept in RTC
+// memory, so after a power loss everything is requested again.
+
+// a section is refreshed this much before it reaches its maximum age, so that
+// a wake that is slightly early does not postpone it by a whole interval
+static const int64_t REFRESH_MARGIN = 120; // seconds
+
+RTC_DATA_ATTR static int64_t  sectionTime[8] = {}; // indexed by section bit
+// API usage of the current (UTC) day
+RTC_DATA_ATTR static int32_t  usageDay        = 0;
+RTC_DATA_ATTR static uint16_t callsToday      = 0;
+RTC_DATA_ATTR static uint16_t callsSaved      = 0;
+RTC_DATA_ATTR static uint32_t bytesToday      = 0;
+RTC_DATA_ATTR static uint32_t bytesSaved      = 0;
+// size of the last complete responses, to estimate the bytes saved
+RTC_DATA_ATTR static uint32_t oneCallBytes      = 0;
+RTC_DATA_ATTR static uint32_t airPollutionBytes = 0;
+
+/* Returns the index of the lowest section in the bitmask.
+ */
+static int sectionIndex(uint8_t section)
+{
+  return __builtin_ctz(section);
+} // end sectionIndex
+
+/* Returns the sections of the weather data that are used.
+ */
+uint8_t getUsedSections()
+{
+  uint8_t used = DATA_ONECALL | DATA_AIR_POLLUTION;
+  if (!DISPLAY_ALERTS)
+  {
+    used &= ~DATA_ALERTS;
+  }
+  return used;
+} // end getUsedSections
+
+/* Starts counting the API usage of a new day, if the day has changed.
+ */
+static void updateUsageDay(int64_t now)
+{
+  const int32_t day = static_cast<int32_t>(now / 86400);
+  if (day != usageDay)
+  {
+    usageDay   = day;
+    callsToday = 0;
+    callsSaved = 0;
+    bytesToday = 0;
+    bytesSaved = 0;
+  }
+  return;
+} // end updateUsageDay
+
+/* Returns the sections of the weather data that should be requested.
+ * Sections without a policy are requested on every update. Once
+ * API_CALL_BUDGET calls have been made today, only sections that have never
+ * been received are requested.
+ */
+uint8_t getStaleSections(int64_t now)
+{
+  const uint8_t used = getUsedSections();
+  if (CACHE_MAX_AGE <= 0)
+  { // nothing to merge with
+    return used;
+  }
+  updateUsageDay(now);
+  const bool overBudget = API_CALL_BUDGET > 0
+                          && callsToday >= API_CALL_BUDGET;
+
+  uint8_t stale = used;
+  for (size_t i = 0; i < NUM_REFRESH_POLICIES; ++i)
+  {
+    const refresh_policy_t &policy = REFRESH_POLICY[i];
+    const int64_t fetched = sectionTime[sectionIndex(policy.section)];
+    const int64_t age = now - fetched;
+    if (fetched != 0 && age >= 0
+     && (overBudget || age <= policy.maxAge * 60LL - REFRESH_MARGIN))
+    {
+      stale &= ~policy.section;
+    }
+  }
+  return stale;
+} // end getStaleSections
+
+/* Records a successful API call that received the given sections (0 if the
+ * response is not used as weather data, e.g. an alerts probe).
+ */
+void recordApiCall(uint8_t sections, size_t bytes, int64_t now)
+{
+  const uint8_t oneCall = getUsedSections() & DATA_ONECALL;
+  updateUsageDay(now);
+  ++callsToday;
+  bytesToday += bytes;
+  for (int i = 0; i < 8; ++i)
+  {
+    if (sections & (1 << i))
+    {
+      sectionTime[i] = now;
+    }
+  }
+
+  if (sections == DATA_AIR_POLLUTION)
+  {
+    airPollutionBytes = bytes;
+  }
+  else if ((sections & oneCall) == oneCall)
+  { // complete One Call response
+    oneCallBytes = bytes;
+  }
+  else if (sections != 0 && oneCallBytes > bytes)
+  {
+    bytesSaved += oneCallBytes - bytes;
+  }
+  return;
+} // end recordApiCall
+
+/* Records the requests that were skipped, because none of their sections were
+ * stale.
+ */
+void recordSkippedSections(uint8_t sections)
+{
+  const uint8_t oneCall = getUsedSections() & DATA_ONECALL;
+  if ((sections & oneCall) == oneCall)
+  {
+    ++callsSaved;
+    bytesSaved += oneCallBytes;
+  }
+  if (sections & DATA_AIR_POLLUTION)
+  {
+    ++callsSaved;
+    bytesSaved += airPollutionBytes;
+  }
+  return;
+} // end recordSkippedSections
+
+/* Prints the API usage of the current (UTC) day.
+ */
+void printApiUsage()
+{
+  LOG_DEBUG("API calls today : %u (%ukB), saved %u (%ukB)", callsToday,
+            static_cast<unsigned>(bytesToday / 1024), callsSaved,
+            static_cast<unsigned>(bytesSaved / 1024));
+  return;
+} // end printApiUsage
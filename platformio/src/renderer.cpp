@@ -15,13 +15,18 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <esp_ota_ops.h>
 #include "_locale.h"
 #include "_strftime.h"
 #include "renderer.h"
 #include "api_response.h"
+#include "battery_model.h"
 #include "config.h"
 #include "conversions.h"
 #include "display_utils.h"
+#include "logging.h"
+#include "text_metrics.h"
+#include "ulp_sensor.h"
 
 // fonts
 #include FONT_HEADER
@@ -38,60 +43,93 @@
 #include "icons/icons_196x196.h"
 
 #ifdef DISP_BW_V2
-  GxEPD2_BW<GxEPD2_750_GDEY075T7,
-            GxEPD2_750_GDEY075T7::HEIGHT> display(
-    GxEPD2_750_GDEY075T7(PIN_EPD_CS,
-                         PIN_EPD_DC,
-                         PIN_EPD_RST,
-                         PIN_EPD_BUSY));
+  EpdDisplay display(GxEPD2_750_GDEY075T7(PIN_EPD_CS,
+                                          PIN_EPD_DC,
+                                          PIN_EPD_RST,
+                                          PIN_EPD_BUSY));
 #endif
 #ifdef DISP_3C_B
-  GxEPD2_3C<GxEPD2_750c_GDEY075Z08,
-            GxEPD2_750c_GDEY075Z08::HEIGHT / 2> display(
-    GxEPD2_750c_GDEY075Z08(PIN_EPD_CS,
-                           PIN_EPD_DC,
-                           PIN_EPD_RST,
-                           PIN_EPD_BUSY));
+  EpdDisplay display(GxEPD2_750c_GDEY075Z08(PIN_EPD_CS,
+                                            PIN_EPD_DC,
+                                            PIN_EPD_RST,
+                                            PIN_EPD_BUSY));
 #endif
 #ifdef DISP_7C_F
-  GxEPD2_7C<GxEPD2_730c_GDEY073D46,
-            GxEPD2_730c_GDEY073D46::HEIGHT / 4> display(
-    GxEPD2_730c_GDEY073D46(PIN_EPD_CS,
-                           PIN_EPD_DC,
-                           PIN_EPD_RST,
-                           PIN_EPD_BUSY));
+  EpdDisplay display(GxEPD2_730c_GDEY073D46(PIN_EPD_CS,
+                                            PIN_EPD_DC,
+                                            PIN_EPD_RST,
+                                            PIN_EPD_BUSY));
 #endif
 #ifdef DISP_BW_V1
-  GxEPD2_BW<GxEPD2_750,
-            GxEPD2_750::HEIGHT> display(
-    GxEPD2_750(PIN_EPD_CS,
-               PIN_EPD_DC,
-               PIN_EPD_RST,
-               PIN_EPD_BUSY));
+  EpdDisplay display(GxEPD2_750(PIN_EPD_CS,
+                                PIN_EPD_DC,
+                                PIN_EPD_RST,
+                                PIN_EPD_BUSY));
 #endif
 
 #ifndef ACCENT_COLOR
   #define ACCENT_COLOR GxEPD_BLACK
 #endif
 
+// Bounding boxes of the widgets. On paged displays, a widget is skipped on the
+// pages that it does not touch.
+static const epd_rect_t CURRENT_TEMP_BOUNDS  = {0, 0, 360, 197};
+static const epd_rect_t FORECAST_BOUNDS      = {318, 64, DISP_WIDTH - 318, 136};
+static const epd_rect_t ALERTS_BOUNDS        = {196, 0, DISP_WIDTH - 196, 64};
+static const epd_rect_t LOCATION_DATE_BOUNDS = {DISP_WIDTH / 2, 0,
+                                                DISP_WIDTH / 2, 60};
+static const epd_rect_t OUTLOOK_GRAPH_BOUNDS = {300, 180, DISP_WIDTH - 300,
+                                                DISP_HEIGHT - 180 - 20};
+static const epd_rect_t STATUS_BAR_BOUNDS    = {0, DISP_HEIGHT - 24,
+                                                DISP_WIDTH, 24};
+
+/* Returns the bounding box of the current conditions widget at position pos
+ * of the left panel.
+ */
+static epd_rect_t currentPosBounds(int pos)
+{
+  return {static_cast<int16_t>(162 * (pos % 2)),
+          static_cast<int16_t>(204 + (48 + 8) * (pos / 2)), 162, 48 + 8};
+}
+
+// The chrome layer is the part of the frame that is the same on every wake:
+// the icons and labels of the current conditions widgets (see CHROME_CACHE).
+typedef enum chrome_mode
+{
+  CHROME_DRAW, // draw the chrome along with the values
+  CHROME_ONLY, // draw the chrome alone
+  CHROME_SKIP  // the chrome is already in the page buffer, draw the values
+} chrome_mode_t;
+
+static chrome_mode_t chromeMode = CHROME_DRAW;
+
+/* Returns the bounds of a string in the current font
+ */
+static text_bounds_t getStringBounds(const String &text)
+{
+  const GFXfont *font = display.getFont();
+  if (font == nullptr)
+  { // built-in font
+    text_bounds_t bounds;
+    display.getTextBounds(text, 0, 0, &bounds.x1, &bounds.y1,
+                          &bounds.w, &bounds.h);
+    return bounds;
+  }
+  return measureText(font, text.c_str());
+}
+
 /* Returns the string width in pixels
  */
 uint16_t getStringWidth(const String &text)
 {
-  int16_t x1, y1;
-  uint16_t w, h;
-  display.getTextBounds(text, 0, 0, &x1, &y1, &w, &h);
-  return w;
+  return getStringBounds(text).w;
 }
 
 /* Returns the string height in pixels
  */
 uint16_t getStringHeight(const String &text)
 {
-  int16_t x1, y1;
-  uint16_t w, h;
-  display.getTextBounds(text, 0, 0, &x1, &y1, &w, &h);
-  return h;
+  return getStringBounds(text).h;
 }
 
 /* Draws a string with alignment
@@ -99,10 +137,8 @@ uint16_t getStringHeight(const String &text)
 void drawString(int16_t x, int16_t y, const String &text, alignment_t alignment,
                 uint16_t color)
 {
-  int16_t x1, y1;
-  uint16_t w, h;
+  uint16_t w = getStringWidth(text);
   display.setTextColor(color);
-  display.getTextBounds(text, x, y, &x1, &y1, &w, &h);
   if (alignment == RIGHT)
   {
     x = x - w;
@@ -130,107 +166,84 @@ void drawMultiLnString(int16_t x, int16_t y, const String &text,
                        uint16_t max_lines, int16_t line_spacing,
                        uint16_t color)
 {
-  uint16_t current_line = 0;
-  String textRemaining = text;
+  const GFXfont *font = display.getFont();
+  const char *str = text.c_str();
+  size_t start = 0;
   // print until we reach max_lines or no more text remains
-  while (current_line < max_lines && !textRemaining.isEmpty())
+  for (uint16_t current_line = 0;
+       current_line < max_lines && start < text.length();
+       ++current_line)
   {
-    int16_t  x1, y1;
-    uint16_t w, h;
-
-    display.getTextBounds(textRemaining, 0, 0, &x1, &y1, &w, &h);
-
-    int endIndex = textRemaining.length();
-    // check if remaining text is to wide, if it is then print what we can
-    String subStr = textRemaining;
-    int splitAt = 0;
-    int keepLastChar = 0;
-    while (w > max_width && splitAt != -1)
+    text_line_t line = breakLine(font, str + start, max_width,
+                                 current_line == max_lines - 1);
+    String subStr = text.substring(start, start + line.len);
+    if (line.ellipsis)
     {
-      if (keepLastChar)
-      {
-        // if we kept the last character during the last iteration of this while
-        // loop, remove it now so we don't get stuck in an infinite loop.
-        subStr.remove(subStr.length() - 1);
-      }
-
-      // find the last place in the string that we can break it.
-      if (current_line < max_lines - 1)
-      {
-        splitAt = std::max(subStr.lastIndexOf(" "),
-                           subStr.lastIndexOf("-"));
-      }
-      else
-      {
-        // this is the last line, only break at spaces so we can add ellipsis
-        splitAt = subStr.lastIndexOf(" ");
-      }
-
-      // if splitAt == -1 then there is an unbroken set of characters that is
-      // longer than max_width. Otherwise if splitAt != -1 then we can continue
-      // the loop until the string is <= max_width
-      if (splitAt != -1)
-      {
-        endIndex = splitAt;
-        subStr = subStr.substring(0, endIndex + 1);
-
-        char lastChar = subStr.charAt(endIndex);
-        if (lastChar == ' ')
-        {
-          // remove this char now so it is not counted towards line width
-          keepLastChar = 0;
-          subStr.remove(endIndex);
-          --endIndex;
-        }
-        else if (lastChar == '-')
-        {
-          // this char will be printed on this line and removed next iteration
-          keepLastChar = 1;
-        }
-
-        if (current_line < max_lines - 1)
-        {
-          // this is not the last line
-          display.getTextBounds(subStr, 0, 0, &x1, &y1, &w, &h);
-        }
-        else
-        {
-          // this is the last line, we need to make sure there is space for
-          // ellipsis
-          display.getTextBounds(subStr + "...", 0, 0, &x1, &y1, &w, &h);
-          if (w <= max_width)
-          {
-            // ellipsis fit, add them to subStr
-            subStr = subStr + "...";
-          }
-        }
-
-      } // end if (splitAt != -1)
-    } // end inner while
-
+      subStr += "...";
+    }
     drawString(x, y + (current_line * line_spacing), subStr, alignment, color);
+    start += line.next;
+  }
 
-    // update textRemaining to no longer include what was printed
-    // +1 for exclusive bounds, +1 to get passed space/dash
-    textRemaining = textRemaining.substring(endIndex + 2 - keepLastChar);
+  return;
+} // end drawMultiLnString
 
-    ++current_line;
-  } // end outer while
+/* Draws a string on a single line in the largest font that fits max_width, at
+ * that font's baseline. fonts must be ordered from largest to smallest. If the
+ * string does not fit on a single line in any of them, it is drawn in the
+ * smallest font over up to max_lines lines, starting at wrap_y (see
+ * drawMultiLnString).
+ */
+void drawFitString(int16_t x, const String &text, alignment_t alignment,
+                   int max_width, const fit_font_t *fonts, size_t num_fonts,
+                   int16_t wrap_y, uint16_t max_lines, int16_t line_spacing,
+                   uint16_t color)
+{
+  // the text only gets narrower with each smaller font, so the first font
+  // that fits can be found by binary search
+  size_t lo = 0;
+  size_t hi = num_fonts;
+  while (lo < hi)
+  {
+    size_t mid = (lo + hi) / 2;
+    display.setFont(fonts[mid].font);
+    if (getStringWidth(text) <= max_width)
+    {
+      hi = mid;
+    }
+    else
+    {
+      lo = mid + 1;
+    }
+  }
 
+  if (lo < num_fonts)
+  {
+    display.setFont(fonts[lo].font);
+    drawString(x, fonts[lo].y, text, alignment, color);
+  }
+  else
+  {
+    display.setFont(fonts[num_fonts - 1].font);
+    drawMultiLnString(x, wrap_y, text, alignment, max_width, max_lines,
+                      line_spacing, color);
+  }
   return;
-} // end drawMultiLnString
+} // end drawFitString
 
-/* Initialize e-paper display
+/* Powers on the e-paper display and initializes the panel driver
  */
-void initDisplay()
+static void startDisplay(bool initial)
 {
   pinMode(PIN_EPD_PWR, OUTPUT);
   digitalWrite(PIN_EPD_PWR, HIGH);
+  // a diagnostic bitrate of 0, otherwise GxEPD2 restarts the serial port and
+  // discards any buffered log output
 #ifdef DRIVER_WAVESHARE
-  display.init(115200, true, 2, false);
+  display.init(0, initial, 2, false);
 #endif
 #ifdef DRIVER_DESPI_C02
-  display.init(115200, true, 10, false);
+  display.init(0, initial, 10, false);
 #endif
   // remap spi
   SPI.end();
@@ -238,6 +251,16 @@ void initDisplay()
             PIN_EPD_MISO,
             PIN_EPD_MOSI,
             PIN_EPD_CS);
+  return;
+} // end startDisplay
+
+/* Initialize e-paper display
+ */
+void initDisplay()
+{
+  // a partial refresh relies on the frame the panel is currently showing, so
+  // the controller must not be treated as being in its initial state
+  startDisplay(!display.preparePartialRefresh());
 
   display.setRotation(0);
   display.setTextSize(1);
@@ -245,10 +268,28 @@ void initDisplay()
   display.setTextWrap(false);
   // display.fillScreen(GxEPD_WHITE);
   display.setFullWindow();
-  display.firstPage(); // use paged drawing mode, sets fillScreen(GxEPD_WHITE)
+  // the page buffer is allocated by display.firstPage(), which is left to the
+  // caller so that it can first free any memory it no longer needs
   return;
 } // end initDisplay
 
+/* Powers off the e-paper display after a refresh that the esp32 slept
+ * through (see SLEEP_DURING_REFRESH).
+ *
+ * Returns true if the esp32 woke up because the refresh finished, in which
+ * case there is nothing left to do but sleep until the next update.
+ */
+bool finishPendingRefresh()
+{
+  if (!display.resumePendingRefresh())
+  {
+    return false;
+  }
+  startDisplay(false);
+  powerOffDisplay();
+  return true;
+} // end finishPendingRefresh
+
 /* Power-off e-paper display
  */
 void powerOffDisplay()
@@ -259,6 +300,100 @@ void powerOffDisplay()
   return;
 } // end initDisplay
 
+#if CHROME_CACHE
+/* Returns the 32-bit FNV-1a hash of the data, continuing from hash.
+ */
+static uint32_t fnv1a(uint32_t hash, const void *data, size_t len)
+{
+  const uint8_t *p = static_cast<const uint8_t *>(data);
+  for (size_t i = 0; i < len; ++i)
+  {
+    hash = (hash ^ p[i]) * 16777619UL;
+  }
+  return hash;
+} // end fnv1a
+
+/* Returns a key identifying the build that draws the chrome layer. The layout,
+ * the configuration and the locale are all compiled in, so a cached chrome
+ * layer is only valid for the build that saved it.
+ */
+static uint32_t chromeKey()
+{
+  static const char BUILD_TIME[] = __DATE__ " " __TIME__;
+  const esp_app_desc_t *app = esp_ota_get_app_description();
+  uint32_t hash = 2166136261UL;
+  hash = fnv1a(hash, app->app_elf_sha256, sizeof(app->app_elf_sha256));
+  // this file is rebuilt whenever config.h or the locale changes, which also
+  // covers builds whose image does not carry the ELF hash
+  hash = fnv1a(hash, BUILD_TIME, sizeof(BUILD_TIME));
+  return hash;
+} // end chromeKey
+
+/* Draws the chrome layer alone. The widgets return before looking at their
+ * data, so none is needed.
+ */
+static void drawChrome()
+{
+  const owm_current_t current = {};
+  const owm_daily_t today = {};
+  const owm_resp_air_pollution_t owm_air_pollution = {};
+  chromeMode = CHROME_ONLY;
+  drawCurrentConditions(current, today, owm_air_pollution, NAN, NAN);
+  chromeMode = CHROME_DRAW;
+  return;
+} // end drawChrome
+#endif
+
+/* Fills the page buffer with the chrome layer, so that the widgets of the frame
+ * that follows only draw their values. The chrome layer is kept compressed in
+ * flash, and is drawn and saved again if it is missing or was saved by another
+ * build. Must be called before anything is drawn.
+ */
+void restoreChrome()
+{
+  chromeMode = CHROME_DRAW;
+#if CHROME_CACHE
+  const unsigned long start = millis();
+  const uint32_t key = chromeKey();
+  bool cached = display.restoreChrome(key);
+  const char *result = "restored";
+  if (!cached)
+  {
+    cached = display.saveChrome(key, drawChrome);
+    result = cached ? "saved" : "drawn";
+  }
+  if (cached)
+  {
+    chromeMode = CHROME_SKIP;
+  }
+  LOG_DEBUG("Chrome layer    : %s in %lums", result, millis() - start);
+#endif
+  return;
+} // end restoreChrome
+
+/* Draws the icon and label of the current conditions widget at position pos,
+ * unless the chrome layer is already in the page buffer. icon may be nullptr,
+ * for widgets whose icon depends on the weather.
+ *
+ * Returns false if only the chrome layer is being drawn, in which case the
+ * widget must not draw its values.
+ */
+static bool drawWidgetChrome(int pos, const uint8_t *icon, const char *label)
+{
+  if (chromeMode != CHROME_SKIP)
+  {
+    int PosX = pos % 2;
+    int PosY = pos / 2;
+    if (icon != nullptr)
+    {
+      display.drawInvertedBitmap(162 * PosX, 204 + (48 + 8) * PosY,
+                                 icon, 48, 48, GxEPD_BLACK);
+    }
+    display.setFont(&FONT_7pt8b);
+    drawString(48 + (162 * PosX), 204 + 10 + (48 + 8) * PosY, label, LEFT);
+  }
+  return chromeMode != CHROME_ONLY;
+} // end drawWidgetChrome
 
 /* These functions are responsible for drawing the current conditions and
  * associated icons on the left panel.
@@ -268,16 +403,19 @@ void powerOffDisplay()
 #ifdef POS_SUNRISE
 void drawCurrentSunrise(const owm_current_t &current)
 {
+  if (!display.isOnPage(currentPosBounds(POS_SUNRISE)))
+  {
+    return;
+  }
   String dataStr, unitStr;
   int PosX = POS_SUNRISE % 2;
   int PosY = static_cast<int>(POS_SUNRISE / 2);
-    // icons
-  display.drawInvertedBitmap(162 * PosX, 204 + (48 + 8) * PosY,
-                             wi_sunrise_48x48, 48, 48, GxEPD_BLACK);
 
-  // labels
-  display.setFont(&FONT_7pt8b);
-  drawString(48 + (162 * PosX), 204 + 10 + (48 + 8) * PosY, TXT_SUNRISE, LEFT);
+  // icons and labels
+  if (!drawWidgetChrome(POS_SUNRISE, wi_sunrise_48x48, TXT_SUNRISE))
+  {
+    return;
+  }
 
   // sunrise
   display.setFont(&FONT_12pt8b);
@@ -296,17 +434,19 @@ void drawCurrentSunrise(const owm_current_t &current)
 #ifdef POS_WIND
 void drawCurrentWind(const owm_current_t &current)
 {
+  if (!display.isOnPage(currentPosBounds(POS_WIND)))
+  {
+    return;
+  }
   String dataStr, unitStr;
   int PosX = (POS_WIND % 2);
   int PosY = static_cast<int>(POS_WIND / 2);
 
-  // icons
-  display.drawInvertedBitmap(162 * PosX, 204 + (48 + 8) * PosY,
-                             wi_strong_wind_48x48, 48, 48, GxEPD_BLACK);
-
-  // labels
-  display.setFont(&FONT_7pt8b);
-  drawString(48 + (162 * PosX), 204 + 10 + (48 + 8) * PosY, TXT_WIND, LEFT);
+  // icons and labels
+  if (!drawWidgetChrome(POS_WIND, wi_strong_wind_48x48, TXT_WIND))
+  {
+    return;
+  }
 
   // wind
   display.setFont(&FONT_12pt8b);
@@ -378,17 +518,19 @@ void drawCurrentWind(const owm_current_t &current)
 #ifdef POS_UVI
 void drawCurrentUVI(const owm_current_t &current)
 {
+  if (!display.isOnPage(currentPosBounds(POS_UVI)))
+  {
+    return;
+  }
   String dataStr, unitStr;
   int PosX = (POS_UVI % 2);
   int PosY = static_cast<int>(POS_UVI / 2);
 
-  // icons
-  display.drawInvertedBitmap(162 * PosX, 204 + (48 + 8) * PosY,
-                             wi_day_sunny_48x48, 48, 48, GxEPD_BLACK);
-
-  // labels
-  display.setFont(&FONT_7pt8b);
-  drawString(48 + (162 * PosX), 204 + 10 + (48 + 8) * PosY, TXT_UV_INDEX, LEFT);
+  // icons and labels
+  if (!drawWidgetChrome(POS_UVI, wi_day_sunny_48x48, TXT_UV_INDEX))
+  {
+    return;
+  }
 
   // spacing between end of index value and start of descriptor text
   const int sp = 8;
@@ -399,30 +541,13 @@ void drawCurrentUVI(const owm_current_t &current)
                                 std::max(std::round(current.uvi), 0.0f));
   dataStr = String(uvi);
   drawString(48 + (162 * PosX), 204 + 17 / 2 + (48 + 8) * PosY + 48 / 2, dataStr, LEFT);
-  display.setFont(&FONT_7pt8b);
   dataStr = String(getUVIdesc(uvi));
   int max_w = (162 + (PosX * 162) - sp) - (display.getCursorX() + sp);
-  if (getStringWidth(dataStr) <= max_w)
-  { // Fits on a single line, draw along bottom
-    drawString(display.getCursorX() + sp, 204 + 17 / 2 + (48 + 8) * PosY + 48 / 2,
-               dataStr, LEFT);
-  }
-  else
-  { // use smaller font
-    display.setFont(&FONT_5pt8b);
-    if (getStringWidth(dataStr) <= max_w)
-    { // Fits on a single line with smaller font, draw along bottom
-      drawString(display.getCursorX() + sp,
-                 204 + 17 / 2 + (48 + 8) * PosY + 48 / 2,
-                 dataStr, LEFT);
-    }
-    else
-    { // Does not fit on a single line, draw higher to allow room for 2nd line
-      drawMultiLnString(display.getCursorX() + sp,
-                        204 + 17 / 2 + (48 + 8) * PosY + 48 / 2 - 10,
-                        dataStr, LEFT, max_w, 2, 10);
-    }
-  }
+  // draw along bottom, or higher to allow room for a 2nd line
+  const int16_t y = 204 + 17 / 2 + (48 + 8) * PosY + 48 / 2;
+  const fit_font_t fonts[] = {{&FONT_7pt8b, y}, {&FONT_5pt8b, y}};
+  drawFitString(display.getCursorX() + sp, dataStr, LEFT, max_w, fonts, 2,
+                y - 10, 2, 10);
   return;
 }
 #endif
@@ -432,17 +557,15 @@ void drawCurrentUVI(const owm_current_t &current)
 #ifdef POS_AIR_QULITY
 void drawCurrentAirQuality(const owm_resp_air_pollution_t &owm_air_pollution)
 {
+  if (!display.isOnPage(currentPosBounds(POS_AIR_QULITY)))
+  {
+    return;
+  }
   String dataStr, unitStr;
   int PosX = (POS_AIR_QULITY % 2);
   int PosY = static_cast<int>(POS_AIR_QULITY / 2);
 
-  // icons
-  display.drawInvertedBitmap(162 * PosX, 204 + (48 + 8) * PosY,
-                             air_filter_48x48, 48, 48, GxEPD_BLACK);
-
-  // labels
-  display.setFont(&FONT_7pt8b);
-
+  // icons and labels
   const char *air_quality_index_label;
   if (aqi_desc_type(AQI_SCALE) == AIR_QUALITY_DESC)
   {
@@ -452,7 +575,11 @@ void drawCurrentAirQuality(const owm_resp_air_pollution_t &owm_air_pollution)
   {
     air_quality_index_label = TXT_AIR_POLLUTION;
   }
-  drawString(48 + (162 * PosX), 204 + 10 + (48 + 8) * PosY, air_quality_index_label, LEFT);
+  if (!drawWidgetChrome(POS_AIR_QULITY, air_filter_48x48,
+                        air_quality_index_label))
+  {
+    return;
+  }
 
   // spacing between end of index value and start of descriptor text
   const int sp = 8;
@@ -473,30 +600,13 @@ void drawCurrentAirQuality(const owm_resp_air_pollution_t &owm_air_pollution)
     dataStr = String(aqi);
   }
   drawString(48 + (162 * PosX), 204 + 17 / 2 + (48 + 8) * PosY + 48 / 2, dataStr, LEFT);
-  display.setFont(&FONT_7pt8b);
   dataStr = String(aqi_desc(AQI_SCALE, aqi));
   int max_w = (162 + (PosX * 162) - sp) - (display.getCursorX() + sp);
-  if (getStringWidth(dataStr) <= max_w)
-  { // Fits on a single line, draw along bottom
-    drawString(display.getCursorX() + sp, 204 + 17 / 2 + (48 + 8) * PosY + 48 / 2,
-               dataStr, LEFT);
-  }
-  else
-  { // use smaller font
-    display.setFont(&FONT_5pt8b);
-    if (getStringWidth(dataStr) <= max_w)
-    { // Fits on a single line with smaller font, draw along bottom
-      drawString(display.getCursorX() + sp,
-                 204 + 17 / 2 + (48 + 8) * PosY + 48 / 2,
-                 dataStr, LEFT);
-    }
-    else
-    { // Does not fit on a single line, draw higher to allow room for 2nd line
-      drawMultiLnString(display.getCursorX() + sp,
-                        204 + 17 / 2 + (48 + 8) * PosY + 48 / 2 - 10,
-                        dataStr, LEFT, max_w, 2, 10);
-    }
-  }
+  // draw along bottom, or higher to allow room for a 2nd line
+  const int16_t y = 204 + 17 / 2 + (48 + 8) * PosY + 48 / 2;
+  const fit_font_t fonts[] = {{&FONT_7pt8b, y}, {&FONT_5pt8b, y}};
+  drawFitString(display.getCursorX() + sp, dataStr, LEFT, max_w, fonts, 2,
+                y - 10, 2, 10);
 
   return;
 }
@@ -507,17 +617,20 @@ void drawCurrentAirQuality(const owm_resp_air_pollution_t &owm_air_pollution)
 #ifdef POS_INTEMP
 void drawCurrentInTemp(float inTemp)
 {
+  if (!display.isOnPage(currentPosBounds(POS_INTEMP)))
+  {
+    return;
+  }
   String dataStr, unitStr;
   int PosX = (POS_INTEMP % 2);
   int PosY = static_cast<int>(POS_INTEMP / 2);
 
-  // icons
-  display.drawInvertedBitmap(162 * PosX, 204 + (48 + 8) * PosY,
-                             house_thermometer_48x48, 48, 48, GxEPD_BLACK);
-
-  // labels
-  display.setFont(&FONT_7pt8b);
-  drawString(48 + (162 * PosX), 204 + 10 + (48 + 8) * PosY, TXT_INDOOR_TEMPERATURE, LEFT);
+  // icons and labels
+  if (!drawWidgetChrome(POS_INTEMP, house_thermometer_48x48,
+                        TXT_INDOOR_TEMPERATURE))
+  {
+    return;
+  }
 
   // indoor temperature
   display.setFont(&FONT_12pt8b);
@@ -542,6 +655,47 @@ void drawCurrentInTemp(float inTemp)
   dataStr += "\260";
 #endif
   drawString(48 + (162 * PosX), 204 + 17 / 2 + (48 + 8) * PosY + 48 / 2, dataStr, LEFT);
+
+#if SENSOR_ULP_SAMPLING
+  // range and trend of the indoor temperature since the last update
+  const indoor_history_t *history = getIndoorHistory();
+  if (history != nullptr && !std::isnan(inTemp))
+  {
+    int x = 48 + (162 * PosX) + getStringWidth(dataStr) + 4;
+    int y = 204 + 17 / 2 + (48 + 8) * PosY + 48 / 2;
+    String maxStr, minStr;
+#ifdef UNITS_TEMP_KELVIN
+    maxStr = String(celsius_to_kelvin(history->maxTemp), 1);
+    minStr = String(celsius_to_kelvin(history->minTemp), 1);
+#endif
+#ifdef UNITS_TEMP_CELSIUS
+    maxStr = String(history->maxTemp, 1);
+    minStr = String(history->minTemp, 1);
+#endif
+#ifdef UNITS_TEMP_FAHRENHEIT
+    maxStr = String(static_cast<int>(
+             std::round(celsius_to_fahrenheit(history->maxTemp))));
+    minStr = String(static_cast<int>(
+             std::round(celsius_to_fahrenheit(history->minTemp))));
+#endif
+    display.setFont(&FONT_6pt8b);
+    drawString(x, y - 9, maxStr, LEFT);
+    drawString(x, y, minStr, LEFT);
+
+    // rising or falling by at least 0.3 degrees Celsius per hour
+    x += std::max(getStringWidth(maxStr), getStringWidth(minStr)) + 4;
+    if (history->tempTrend >= 0.3f)
+    {
+      display.fillTriangle(x, y - 4, x + 6, y - 4, x + 3, y - 10,
+                           GxEPD_BLACK);
+    }
+    else if (history->tempTrend <= -0.3f)
+    {
+      display.fillTriangle(x, y - 10, x + 6, y - 10, x + 3, y - 4,
+                           GxEPD_BLACK);
+    }
+  }
+#endif
   return;
 }
 #endif
@@ -551,16 +705,19 @@ void drawCurrentInTemp(float inTemp)
 #ifdef POS_SUNSET
 void drawCurrentSunset(const owm_current_t &current)
 {
+  if (!display.isOnPage(currentPosBounds(POS_SUNSET)))
+  {
+    return;
+  }
   String dataStr, unitStr;
   int PosX = (POS_SUNSET % 2);
   int PosY = static_cast<int>(POS_SUNSET / 2);
-  // icons
-  display.drawInvertedBitmap(162 * PosX, 204 + (48 + 8) * PosY,
-                             wi_sunset_48x48, 48, 48, GxEPD_BLACK);
 
-  // labels
-  display.setFont(&FONT_7pt8b);
-  drawString(48 + (162 * PosX), 204 + 10 + (48 + 8) * PosY, TXT_SUNSET, LEFT);
+  // icons and labels
+  if (!drawWidgetChrome(POS_SUNSET, wi_sunset_48x48, TXT_SUNSET))
+  {
+    return;
+  }
 
   // sunset
   display.setFont(&FONT_12pt8b);
@@ -579,17 +736,19 @@ void drawCurrentSunset(const owm_current_t &current)
 #ifdef POS_HUMIDITY
 void drawCurrentHumidity(const owm_current_t &current)
 {
+  if (!display.isOnPage(currentPosBounds(POS_HUMIDITY)))
+  {
+    return;
+  }
   String dataStr, unitStr;
   int PosX = (POS_HUMIDITY % 2);
   int PosY = static_cast<int>(POS_HUMIDITY / 2);
 
-  // icons
-  display.drawInvertedBitmap(162 * PosX, 204 + (48 + 8) * PosY,
-                             wi_humidity_48x48, 48, 48, GxEPD_BLACK);
-
-  // labels
-  display.setFont(&FONT_7pt8b);
-  drawString(48 + (162 * PosX), 204 + 10 + (48 + 8) * PosY, TXT_HUMIDITY, LEFT);
+  // icons and labels
+  if (!drawWidgetChrome(POS_HUMIDITY, wi_humidity_48x48, TXT_HUMIDITY))
+  {
+    return;
+  }
 
   // humidity
   display.setFont(&FONT_12pt8b);
@@ -607,16 +766,19 @@ void drawCurrentHumidity(const owm_current_t &current)
 #ifdef POS_PRESSURE
 void drawCurrentPressure(const owm_current_t &current)
 {
+  if (!display.isOnPage(currentPosBounds(POS_PRESSURE)))
+  {
+    return;
+  }
   String dataStr, unitStr;
   int PosX = (POS_PRESSURE % 2);
   int PosY = static_cast<int>(POS_PRESSURE / 2);
-  //  icons
-  display.drawInvertedBitmap(162 * PosX, 204 + (48 + 8) * PosY,
-                             wi_barometer_48x48, 48, 48, GxEPD_BLACK);
 
-  //  labels
-  display.setFont(&FONT_7pt8b);
-  drawString(48 + (162 * PosX), 204 + 10 + (48 + 8) * PosY, TXT_PRESSURE, LEFT);
+  // icons and labels
+  if (!drawWidgetChrome(POS_PRESSURE, wi_barometer_48x48, TXT_PRESSURE))
+  {
+    return;
+  }
 
   // pressure
 #ifdef UNITS_PRES_HECTOPASCALS
@@ -677,17 +839,19 @@ void drawCurrentPressure(const owm_current_t &current)
 #ifdef POS_VISIBILITY
 void drawCurrentVisibility(const owm_current_t &current)
 {
+  if (!display.isOnPage(currentPosBounds(POS_VISIBILITY)))
+  {
+    return;
+  }
   String dataStr, unitStr;
   int PosX = (POS_VISIBILITY % 2);
   int PosY = static_cast<int>(POS_VISIBILITY / 2);
 
-  // icons
-  display.drawInvertedBitmap(162 * PosX, 204 + (48 + 8) * PosY,
-                             visibility_icon_48x48, 48, 48, GxEPD_BLACK);
-
-  // labels
-  display.setFont(&FONT_7pt8b);
-  drawString(48 + (162 * PosX), 204 + 10 + (48 + 8) * PosY, TXT_VISIBILITY, LEFT);
+  // icons and labels
+  if (!drawWidgetChrome(POS_VISIBILITY, visibility_icon_48x48, TXT_VISIBILITY))
+  {
+    return;
+  }
 
   // visibility
   display.setFont(&FONT_12pt8b);
@@ -733,17 +897,20 @@ void drawCurrentVisibility(const owm_current_t &current)
 #ifdef POS_INHUMIDITY
 void drawCurrentInHumidity(float inHumidity)
 {
+  if (!display.isOnPage(currentPosBounds(POS_INHUMIDITY)))
+  {
+    return;
+  }
   String dataStr, unitStr;
   int PosX = (POS_INHUMIDITY % 2);
   int PosY = static_cast<int>(POS_INHUMIDITY / 2);
 
-  // current weather data icons
-  display.drawInvertedBitmap(162 * PosX, 204 + (48 + 8) * PosY,
-                             house_humidity_48x48, 48, 48, GxEPD_BLACK);
-
-  // current weather data labels
-  display.setFont(&FONT_7pt8b);
-  drawString(48 + (162 * PosX), 204 + 10 + (48 + 8) * PosY, TXT_INDOOR_HUMIDITY, LEFT);
+  // icons and labels
+  if (!drawWidgetChrome(POS_INHUMIDITY, house_humidity_48x48,
+                        TXT_INDOOR_HUMIDITY))
+  {
+    return;
+  }
 
   // indoor humidity
   display.setFont(&FONT_12pt8b);
@@ -768,17 +935,19 @@ void drawCurrentInHumidity(float inHumidity)
 #ifdef POS_MOONRISE
 void drawCurrentMoonrise(const owm_daily_t &today)
 {
+  if (!display.isOnPage(currentPosBounds(POS_MOONRISE)))
+  {
+    return;
+  }
   String dataStr, unitStr;
   int PosX = POS_MOONRISE % 2;
   int PosY = static_cast<int>(POS_MOONRISE / 2);
 
-  // icons
-  display.drawInvertedBitmap(162 * PosX, 204 + (48 + 8) * PosY,
-                             wi_moonrise_48x48, 48, 48, GxEPD_BLACK);
-
-  // labels
-  display.setFont(&FONT_7pt8b);
-  drawString(48 + (162 * PosX), 204 + 10 + (48 + 8) * PosY, TXT_MOONRISE, LEFT);
+  // icons and labels
+  if (!drawWidgetChrome(POS_MOONRISE, wi_moonrise_48x48, TXT_MOONRISE))
+  {
+    return;
+  }
 
   // moonrise
   display.setFont(&FONT_12pt8b);
@@ -797,16 +966,19 @@ void drawCurrentMoonrise(const owm_daily_t &today)
 #ifdef POS_MOONSET
 void drawCurrentMoonset(const owm_daily_t &today)
 {
+  if (!display.isOnPage(currentPosBounds(POS_MOONSET)))
+  {
+    return;
+  }
   String dataStr, unitStr;
   int PosX = (POS_MOONSET % 2);
   int PosY = static_cast<int>(POS_MOONSET / 2);
-  // icons
-  display.drawInvertedBitmap(162 * PosX, 204 + (48 + 8) * PosY,
-                             wi_moonset_48x48, 48, 48, GxEPD_BLACK);
 
-  // labels
-  display.setFont(&FONT_7pt8b);
-  drawString(48 + (162 * PosX), 204 + 10 + (48 + 8) * PosY, TXT_MOONSET, LEFT);
+  // icons and labels
+  if (!drawWidgetChrome(POS_MOONSET, wi_moonset_48x48, TXT_MOONSET))
+  {
+    return;
+  }
 
   // moonset
   display.setFont(&FONT_12pt8b);
@@ -825,43 +997,31 @@ void drawCurrentMoonset(const owm_daily_t &today)
 #ifdef POS_MOONPHASE
 void drawCurrentMoonphase(const owm_daily_t &daily)
 {
+  if (!display.isOnPage(currentPosBounds(POS_MOONPHASE)))
+  {
+    return;
+  }
   String dataStr, unitStr;
   int PosX = (POS_MOONPHASE % 2);
   int PosY = static_cast<int>(POS_MOONPHASE / 2);
 
-  // icons
+  // labels, the icon depends on the weather
+  if (!drawWidgetChrome(POS_MOONPHASE, nullptr, TXT_MOONPHASE))
+  {
+    return;
+  }
   display.drawInvertedBitmap(162 * PosX, 204 + (48 + 8) * PosY,
                              getMoonPhaseBitmap48(daily), 48, 48, GxEPD_BLACK);
 
-  // labels
-  display.setFont(&FONT_7pt8b);
-  drawString(48 + (162 * PosX), 204 + 10 + (48 + 8) * PosY, TXT_MOONPHASE, LEFT);
-
   // moonphase
   const int sp = 8;
   dataStr = String(getMoonPhaseStr(daily));
   int max_w = (162 + (PosX * 162) - sp) - (48 + (PosX * 162));
-  if (getStringWidth(dataStr) <= max_w)
-  { // Fits on a single line, draw along bottom
-    drawString(48 + (162 * PosX), 204 + 17 / 2 + (48 + 8) * PosY + 48 / 2,
-               dataStr, LEFT);
-  }
-  else
-  { // use smaller font
-    display.setFont(&FONT_5pt8b);
-    if (getStringWidth(dataStr) <= max_w)
-    { // Fits on a single line with smaller font, draw along bottom
-      drawString(48 + (162 * PosX),
-                 204 + 17 / 2 + (48 + 8) * PosY + 48 / 2,
-                 dataStr, LEFT);
-    }
-    else
-    { // Does not fit on a single line, draw higher to allow room for 2nd line
-      drawMultiLnString(48 + (162 * PosX),
-                        204 + 17 / 2 + (48 + 8) * PosY + 48 / 2 - 10,
-                        dataStr, LEFT, max_w, 2, 10);
-    }
-  }
+  // draw along bottom, or higher to allow room for a 2nd line
+  const int16_t y = 204 + 17 / 2 + (48 + 8) * PosY + 48 / 2;
+  const fit_font_t fonts[] = {{&FONT_7pt8b, y}, {&FONT_5pt8b, y}};
+  drawFitString(48 + (162 * PosX), dataStr, LEFT, max_w, fonts, 2, y - 10, 2,
+                10);
 
   return;
 }
@@ -872,19 +1032,24 @@ void drawCurrentMoonphase(const owm_daily_t &daily)
 #ifdef POS_DEWPOINT
 void drawCurrentDewpoint(const owm_current_t &current)
 {
+  if (!display.isOnPage(currentPosBounds(POS_DEWPOINT)))
+  {
+    return;
+  }
   String dataStr, unitStr;
   int PosX = (POS_DEWPOINT % 2);
   int PosY = static_cast<int>(POS_DEWPOINT / 2);
-  
-  // icons
-  display.drawInvertedBitmap(162 * PosX, 204 + (48 + 8) * PosY,
-                             wi_thermometer_48x48, 48, 48, GxEPD_BLACK);
-  display.drawInvertedBitmap(162 * PosX + 48 - 24, 204 + (48 + 8) * PosY + 4,
-                             wi_raindrops_24x24, 24, 24, GxEPD_BLACK);
-  
-  // labels
-  display.setFont(&FONT_7pt8b);
-  drawString(48 + (162 * PosX), 204 + 10 + (48 + 8) * PosY, TXT_DEWPOINT, LEFT);
+
+  // icons and labels
+  if (chromeMode != CHROME_SKIP)
+  {
+    display.drawInvertedBitmap(162 * PosX + 48 - 24, 204 + (48 + 8) * PosY + 4,
+                               wi_raindrops_24x24, 24, 24, GxEPD_BLACK);
+  }
+  if (!drawWidgetChrome(POS_DEWPOINT, wi_thermometer_48x48, TXT_DEWPOINT))
+  {
+    return;
+  }
 
   // Dew point
   display.setFont(&FONT_12pt8b);
@@ -916,14 +1081,16 @@ void drawCurrentDewpoint(const owm_current_t &current)
 
 //End defining functions for left panel.
 
-/* This function is responsible for drawing the current conditions and
- * associated icons.
+/* Draws the current conditions icon, the current temperature and the feels
+ * like temperature.
  */
-void drawCurrentConditions(const owm_current_t &current,
-                           const owm_daily_t &today,
-                           const owm_resp_air_pollution_t &owm_air_pollution,
-                           float inTemp, float inHumidity)
+static void drawCurrentTemp(const owm_current_t &current,
+                            const owm_daily_t &today)
 {
+  if (!display.isOnPage(CURRENT_TEMP_BOUNDS))
+  {
+    return;
+  }
   String dataStr, unitStr;
   // current weather icon
   display.drawInvertedBitmap(0, 0,
@@ -979,6 +1146,22 @@ void drawCurrentConditions(const owm_current_t &current,
 #elif defined(DISP_BW_V1)
   drawString(156 + 164 / 2, 98 + 69 / 2 + 12 + 17, dataStr, CENTER);
 #endif
+  return;
+} // end drawCurrentTemp
+
+/* This function is responsible for drawing the current conditions and
+ * associated icons.
+ */
+void drawCurrentConditions(const owm_current_t &current,
+                           const owm_daily_t &today,
+                           const owm_resp_air_pollution_t &owm_air_pollution,
+                           float inTemp, float inHumidity)
+{
+  if (chromeMode != CHROME_ONLY)
+  {
+    drawCurrentTemp(current, today);
+  }
+
   // line dividing top and bottom display areas
   // display.drawLine(0, 196, DISP_WIDTH - 1, 196, GxEPD_BLACK);
 
@@ -1049,6 +1232,10 @@ void drawCurrentConditions(const owm_current_t &current,
  */
 void drawForecast(const owm_daily_t *daily, tm timeInfo)
 {
+  if (!display.isOnPage(FORECAST_BOUNDS))
+  {
+    return;
+  }
   // 5 day, forecast
   String hiStr, loStr;
   String dataStr, unitStr;
@@ -1152,9 +1339,11 @@ void drawForecast(const owm_daily_t *daily, tm timeInfo)
   void drawAlerts(std::vector<owm_alerts_t> & alerts,
                   const String &city, const String &date)
   {
-#if DEBUG_LEVEL >= 1
-  Serial.println("[debug] alerts.size()    : " + String(alerts.size()));
-#endif
+  if (!display.isOnPage(ALERTS_BOUNDS))
+  {
+    return;
+  }
+  LOG_DEBUG("alerts.size()    : %u", static_cast<unsigned>(alerts.size()));
   if (alerts.size() == 0)
   { // no alerts to draw
     return;
@@ -1164,7 +1353,7 @@ void drawForecast(const owm_daily_t *daily, tm timeInfo)
   int *alert_indices = (int *) calloc(alerts.size(), sizeof(*alert_indices));
   if (!ignore_list || !alert_indices)
   {
-    Serial.println("Error: Failed to allocate memory while handling alerts.");
+    LOG_INFO("Error: Failed to allocate memory while handling alerts.");
     free(ignore_list);
     free(alert_indices);
     return;
@@ -1185,12 +1374,18 @@ void drawForecast(const owm_daily_t *daily, tm timeInfo)
   // find indices of valid alerts
   int num_valid_alerts = 0;
 #if DEBUG_LEVEL >= 1
-  Serial.print("[debug] ignore_list      : [ ");
+  char ignore_str[64];
+  int ignore_pos = 0;
 #endif
   for (int i = 0; i < alerts.size(); ++i)
   {
 #if DEBUG_LEVEL >= 1
-    Serial.print(String(ignore_list[i]) + " ");
+    if (ignore_pos < static_cast<int>(sizeof(ignore_str)))
+    {
+      ignore_pos += snprintf(ignore_str + ignore_pos,
+                             sizeof(ignore_str) - ignore_pos,
+                             "%d ", ignore_list[i]);
+    }
 #endif
     if (!ignore_list[i])
     {
@@ -1199,7 +1394,9 @@ void drawForecast(const owm_daily_t *daily, tm timeInfo)
     }
   }
 #if DEBUG_LEVEL >= 1
-  Serial.println("]\n[debug] num_valid_alerts : " + String(num_valid_alerts));
+  ignore_str[std::min<int>(ignore_pos, sizeof(ignore_str) - 1)] = '\0';
+  LOG_DEBUG("ignore_list      : [ %s]", ignore_str);
+  LOG_DEBUG("num_valid_alerts : %d", num_valid_alerts);
 #endif
 
   if (num_valid_alerts == 1)
@@ -1213,24 +1410,11 @@ void drawForecast(const owm_daily_t *daily, tm timeInfo)
     // must be called after getAlertBitmap
     toTitleCase(cur_alert.event);
 
-    display.setFont(&FONT_14pt8b);
-    if (getStringWidth(cur_alert.event) <= max_w)
-    { // Fits on a single line, draw along bottom
-      drawString(196 + 48 + 4, 24 + 8 - 12 + 20 + 1, cur_alert.event, LEFT);
-    }
-    else
-    { // use smaller font
-      display.setFont(&FONT_12pt8b);
-      if (getStringWidth(cur_alert.event) <= max_w)
-      { // Fits on a single line with smaller font, draw along bottom
-        drawString(196 + 48 + 4, 24 + 8 - 12 + 17 + 1, cur_alert.event, LEFT);
-      }
-      else
-      { // Does not fit on a single line, draw higher to allow room for 2nd line
-        drawMultiLnString(196 + 48 + 4, 24 + 8 - 12 + 17 - 11,
-                          cur_alert.event, LEFT, max_w, 2, 23);
-      }
-    }
+    // draw along bottom, or higher to allow room for a 2nd line
+    const fit_font_t fonts[] = {{&FONT_14pt8b, 24 + 8 - 12 + 20 + 1},
+                                {&FONT_12pt8b, 24 + 8 - 12 + 17 + 1}};
+    drawFitString(196 + 48 + 4, cur_alert.event, LEFT, max_w, fonts, 2,
+                  24 + 8 - 12 + 17 - 11, 2, 23);
   } // end 1 alert
   else
   { // 2 alerts
@@ -1263,6 +1447,10 @@ void drawForecast(const owm_daily_t *daily, tm timeInfo)
  */
 void drawLocationDate(const String &city, const String &date)
 {
+  if (!display.isOnPage(LOCATION_DATE_BOUNDS))
+  {
+    return;
+  }
   // location, date
   display.setFont(&FONT_16pt8b);
   drawString(DISP_WIDTH - 2, 23, city, RIGHT, ACCENT_COLOR);
@@ -1301,12 +1489,23 @@ int kelvin_to_plot_y(float kelvin, int tempBoundMin, float yPxPerUnit,
 #endif
 }
 
+// Hatching of the precipitation bars: every other pixel of every other row,
+// on the even columns. The bars are hatched upwards from their bottom row.
+static const uint8_t PRECIP_HATCH_EVEN_ROWS[8] = {0xAA, 0x00, 0xAA, 0x00,
+                                                  0xAA, 0x00, 0xAA, 0x00};
+static const uint8_t PRECIP_HATCH_ODD_ROWS[8]  = {0x00, 0xAA, 0x00, 0xAA,
+                                                  0x00, 0xAA, 0x00, 0xAA};
+
 /* This function is responsible for drawing the outlook graph for the specified
  * number of hours(up to 48).
  */
 void drawOutlookGraph(const owm_hourly_t *hourly, const owm_daily_t *daily,
                       tm timeInfo)
 {
+  if (!display.isOnPage(OUTLOOK_GRAPH_BOUNDS))
+  {
+    return;
+  }
   const int xPos0 = 350;
   int xPos1 = DISP_WIDTH;
   const int yPos0 = 216;
@@ -1496,10 +1695,8 @@ void drawOutlookGraph(const owm_hourly_t *hourly, const owm_daily_t *daily,
     // draw dotted line
     if (i < yMajorTicks)
     {
-      for (int x = xPos0; x <= xPos1 + 1; x += 3)
-      {
-        display.drawPixel(x, yTick + (yTick % 2), GxEPD_BLACK);
-      }
+      display.drawDottedHLine(xPos0, yTick + (yTick % 2), xPos1 + 2 - xPos0, 3,
+                              GxEPD_BLACK);
     }
   }
 
@@ -1540,9 +1737,7 @@ void drawOutlookGraph(const owm_hourly_t *hourly, const owm_daily_t *daily,
       y0_t = y_t[i - 1];
       y1_t = y_t[i    ];
       // graph temperature
-      display.drawLine(x0_t    , y0_t    , x1_t    , y1_t    , ACCENT_COLOR);
-      display.drawLine(x0_t    , y0_t + 1, x1_t    , y1_t + 1, ACCENT_COLOR);
-      display.drawLine(x0_t - 1, y0_t    , x1_t - 1, y1_t    , ACCENT_COLOR);
+      display.drawThickLine(x0_t, y0_t, x1_t, y1_t, ACCENT_COLOR);
 
       // draw hourly bitmap
 #if DISPLAY_HOURLY_ICONS
@@ -1602,13 +1797,10 @@ void drawOutlookGraph(const owm_hourly_t *hourly, const owm_daily_t *daily,
     y1_t = yPos1;
 
     // graph Precipitation
-    for (int y = y1_t - 1; y > y0_t; y -= 2)
-    {
-      for (int x = x0_t + (x0_t % 2); x < x1_t; x += 2)
-      {
-        display.drawPixel(x, y, GxEPD_BLACK);
-      }
-    }
+    display.fillPattern(x0_t, y0_t + 1, x1_t - x0_t, y1_t - 1 - y0_t,
+                        ((y1_t - 1) & 1) ? PRECIP_HATCH_ODD_ROWS
+                                         : PRECIP_HATCH_EVEN_ROWS,
+                        GxEPD_BLACK);
 
     if ((i % hourInterval) == 0)
     {
@@ -1645,11 +1837,16 @@ void drawOutlookGraph(const owm_hourly_t *hourly, const owm_daily_t *daily,
 } // end drawOutlookGraph
 
 /* This function is responsible for drawing the status bar along the bottom of
- * the display.
+ * the display. stale indicates that the weather data shown was received at
+ * refreshTimeStr, rather than now.
  */
 void drawStatusBar(const String &statusStr, const String &refreshTimeStr,
-                   int rssi, uint32_t batVoltage)
+                   int rssi, uint32_t batVoltage, bool stale)
 {
+  if (!display.isOnPage(STATUS_BAR_BOUNDS))
+  {
+    return;
+  }
   String dataStr;
   uint16_t dataColor = GxEPD_BLACK;
   display.setFont(&FONT_6pt8b);
@@ -1667,13 +1864,21 @@ void drawStatusBar(const String &statusStr, const String &refreshTimeStr,
     dataColor = ACCENT_COLOR;
   }
 #endif
-#if STATUS_BAR_EXTRAS_BAT_PERCENTAGE || STATUS_BAR_EXTRAS_BAT_VOLTAGE
+#if STATUS_BAR_EXTRAS_BAT_PERCENTAGE || STATUS_BAR_EXTRAS_BAT_VOLTAGE \
+    || STATUS_BAR_EXTRAS_BAT_DAYS
   dataStr = "";
 #if STATUS_BAR_EXTRAS_BAT_PERCENTAGE
   dataStr += String(batPercent) + "%";
 #endif
 #if STATUS_BAR_EXTRAS_BAT_VOLTAGE
   dataStr += " (" + String( std::round(batVoltage / 10.f) / 100.f, 2 ) + "v)";
+#endif
+#if STATUS_BAR_EXTRAS_BAT_DAYS
+  float batDays = getBatteryDaysRemaining();
+  if (!std::isnan(batDays))
+  {
+    dataStr += " (" + String(std::min(static_cast<int>(batDays), 999)) + "d)";
+  }
 #endif
   drawString(pos, DISP_HEIGHT - 1 - 2, dataStr, RIGHT, dataColor);
   pos -= getStringWidth(dataStr) + 1;
@@ -1705,11 +1910,14 @@ void drawStatusBar(const String &statusStr, const String &refreshTimeStr,
                              16, 16, dataColor);
   pos -= sp + 8;
 
-  // last refresh
-  dataColor = GxEPD_BLACK;
+  // last refresh. If the weather data is from an earlier refresh, it is
+  // highlighted, and marked by a clock instead of the refresh arrows, since
+  // the accent color is black on black and white panels.
+  dataColor = stale ? ACCENT_COLOR : GxEPD_BLACK;
   drawString(pos, DISP_HEIGHT - 1 - 2, refreshTimeStr, RIGHT, dataColor);
   pos -= getStringWidth(refreshTimeStr) + 25;
-  display.drawInvertedBitmap(pos, DISP_HEIGHT - 1 - 21, wi_refresh_32x32,
+  display.drawInvertedBitmap(pos, DISP_HEIGHT - 1 - 21,
+                             stale ? wi_time_4_32x32 : wi_refresh_32x32,
                              32, 32, dataColor);
   pos -= sp;
 
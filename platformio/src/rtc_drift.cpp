@@ -0,0 +1,212 @@
+/* RTC drift compensation for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <Arduino.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <sys/time.h>
+#include "config.h"
+#include "logging.h"
+#include "rtc_drift.h"
+
+// The RTC slow clock keeps time (and times the wakeup) during deep sleep. Its
+// frequency differs from board to board and with temperature, so the RTC
+// drifts by up to a few seconds each sleep. The drift is measured whenever the
+// time is synchronized, as the error of the RTC's time at wake divided by the
+// time it spent asleep since the previous synchronization. A positive drift
+// means the RTC runs fast.
+
+// drift assumed until the first measurement
+static const float DRIFT_DEFAULT = 0.0015f;
+// weight of a new measurement in the moving average
+static const float DRIFT_ALPHA = 0.25f;
+// measurements beyond this are discarded (e.g. the time was set manually)
+static const float DRIFT_MAX = 0.02f;
+// sleeps shorter than this are too noisy to measure
+static const int64_t DRIFT_MIN_SLEEP_US = 300 * 1000000LL;
+// aim to wake this long after the scheduled time, so that a wake that is
+// slightly early is not mistaken for one before the scheduled update
+static const int64_t WAKE_MARGIN_US = 1000000LL;
+// drift is also averaged per bin of indoor temperature, the last temperature
+// measured before the sleep is taken as the temperature during the sleep
+static const int   DRIFT_BINS      = 8;
+static const float DRIFT_BIN_WIDTH = 5.0f; // degrees Celsius, from 0
+
+// state kept across deep sleep
+RTC_DATA_ATTR static int64_t  lastSyncUs       = 0; // true time of last sync
+RTC_DATA_ATTR static uint32_t awakeSinceSyncMs = 0;
+RTC_DATA_ATTR static int64_t  targetWakeUs     = 0;
+RTC_DATA_ATTR static float    sleepTemperature = NAN;
+RTC_DATA_ATTR static float    driftEstimate    = 0.0f;
+RTC_DATA_ATTR static uint16_t driftSamples     = 0;
+RTC_DATA_ATTR static float    driftBins[DRIFT_BINS]       = {};
+RTC_DATA_ATTR static uint8_t  driftBinSamples[DRIFT_BINS] = {};
+
+// time according to the RTC at wake, and the esp_timer at the same instant
+static int64_t wakeRtcUs   = 0;
+static int64_t wakeTimerUs = 0;
+// synchronized time, and the esp_timer at the same instant
+static volatile bool syncRecorded = false;
+static int64_t syncUs      = 0;
+static int64_t syncTimerUs = 0;
+
+/* Returns the time of day as microseconds since the epoch.
+ */
+static int64_t toMicros(const struct timeval &tv)
+{
+  return static_cast<int64_t>(tv.tv_sec) * 1000000LL + tv.tv_usec;
+} // end toMicros
+
+/* Returns the drift bin of the given temperature, or -1 if it is unknown.
+ */
+static int driftBin(float temperature)
+{
+  if (std::isnan(temperature))
+  {
+    return -1;
+  }
+  int bin = static_cast<int>(floorf(temperature / DRIFT_BIN_WIDTH));
+  return std::min(std::max(bin, 0), DRIFT_BINS - 1);
+} // end driftBin
+
+/* Returns the exponentially weighted moving average after adding a sample.
+ */
+static float movingAverage(float average, uint16_t samples, float sample)
+{
+  if (samples == 0)
+  {
+    return sample;
+  }
+  return average + DRIFT_ALPHA * (sample - average);
+} // end movingAverage
+
+/* Records the RTC's time at wake. Must be called as early as possible, before
+ * the time is synchronized.
+ */
+void recordWakeTime()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  wakeTimerUs = esp_timer_get_time();
+  wakeRtcUs = toMicros(tv);
+  return;
+} // end recordWakeTime
+
+/* Records a time synchronization. Called from the SNTP client with the time it
+ * has just set.
+ */
+void recordTimeSync(const struct timeval *tv)
+{
+  syncTimerUs = esp_timer_get_time();
+  syncUs = toMicros(*tv);
+  syncRecorded = true;
+  return;
+} // end recordTimeSync
+
+/* Updates the drift estimate from the error of the RTC's time at wake, once the
+ * time has been synchronized. The residual error of the wake time, against the
+ * time the last sleep was meant to end, shows how well the estimate works.
+ */
+void updateRtcDrift()
+{
+  if (!syncRecorded)
+  {
+    return;
+  }
+  syncRecorded = false;
+  const int64_t trueWakeUs = syncUs - (syncTimerUs - wakeTimerUs);
+  const int64_t errorUs = wakeRtcUs - trueWakeUs;
+  // time the RTC believes it spent asleep since the last sync
+  const int64_t sleptUs = wakeRtcUs - lastSyncUs
+                          - awakeSinceSyncMs * 1000LL;
+
+  if (lastSyncUs != 0 && sleptUs >= DRIFT_MIN_SLEEP_US
+   && esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER)
+  {
+    const float drift = errorUs / static_cast<float>(sleptUs);
+    if (fabsf(drift) < DRIFT_MAX)
+    {
+      driftEstimate = movingAverage(driftEstimate, driftSamples, drift);
+      if (driftSamples < UINT16_MAX)
+      {
+        ++driftSamples;
+      }
+      int bin = driftBin(sleepTemperature);
+      if (bin >= 0)
+      {
+        driftBins[bin] = movingAverage(driftBins[bin], driftBinSamples[bin],
+                                       drift);
+        if (driftBinSamples[bin] < UINT8_MAX)
+        {
+          ++driftBinSamples[bin];
+        }
+      }
+      LOG_DEBUG("RTC drift       : %.0fppm over %lds, estimate %.0fppm",
+                drift * 1e6f, static_cast<long>(sleptUs / 1000000),
+                driftEstimate * 1e6f);
+    }
+    else
+    {
+      LOG_DEBUG("RTC drift       : %.0fppm over %lds, discarded",
+                drift * 1e6f, static_cast<long>(sleptUs / 1000000));
+    }
+  }
+  if (targetWakeUs != 0)
+  {
+    LOG_DEBUG("Wake residual   : %.3fs", (trueWakeUs - targetWakeUs) / 1e6f);
+    targetWakeUs = 0;
+  }
+
+  lastSyncUs = trueWakeUs;
+  awakeSinceSyncMs = 0;
+  return;
+} // end updateRtcDrift
+
+/* Returns the duration in microseconds to program the sleep timer with, in
+ * order to wake at the given time. Must be called just before entering deep
+ * sleep, temperature may be NAN if it was not measured during this wake (e.g.
+ * an alerts probe), in which case the last temperature measured is used.
+ */
+uint64_t getSleepTimerDuration(time_t wakeTime, float temperature)
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  targetWakeUs = static_cast<int64_t>(wakeTime) * 1000000LL + WAKE_MARGIN_US;
+  awakeSinceSyncMs += millis();
+  if (!std::isnan(temperature))
+  {
+    sleepTemperature = temperature;
+  }
+
+  float drift = DRIFT_DEFAULT;
+  int bin = driftBin(sleepTemperature);
+  if (bin >= 0 && driftBinSamples[bin] > 0)
+  {
+    drift = driftBins[bin];
+  }
+  else if (driftSamples > 0)
+  {
+    drift = driftEstimate;
+  }
+
+  // a fast RTC counts more than the true time asleep, so must count longer
+  int64_t durationUs = targetWakeUs - toMicros(tv);
+  durationUs = static_cast<int64_t>(durationUs / (1.0 - drift));
+  return std::max<int64_t>(durationUs, 1000000LL);
+} // end getSleepTimerDuration
@@ -0,0 +1,243 @@
+/* Sleep scheduler for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <Arduino.h>
+#include <time.h>
+#include "config.h"
+#include "scheduler.h"
+
+// Sunrise and sunset as minutes after local midnight, from the most recent
+// weather data. -1 if unknown, rules anchored to them are skipped until known.
+RTC_DATA_ATTR static int16_t sunriseMinute = -1;
+RTC_DATA_ATTR static int16_t sunsetMinute  = -1;
+
+/* Returns the minutes after local midnight of the given time.
+ */
+static int16_t minuteOfDay(time_t t)
+{
+  tm local = {};
+  localtime_r(&t, &local);
+  return local.tm_hour * 60 + local.tm_min;
+} // end minuteOfDay
+
+/* Remembers today's sunrise and sunset for rules anchored to them. The times
+ * are kept across deep sleep and applied to every day, since they only shift
+ * by a few minutes from one day to the next.
+ */
+void setSunTimes(time_t sunrise, time_t sunset)
+{
+  if (sunrise == 0 || sunset == 0)
+  { // polar day or night, keep the last known times
+    return;
+  }
+  sunriseMinute = minuteOfDay(sunrise);
+  sunsetMinute  = minuteOfDay(sunset);
+  return;
+} // end setSunTimes
+
+// Intervals of all rules are multiplied by this, to save battery
+static float intervalScale = 1.0f;
+
+/* Stretches the update interval of every rule by the given factor.
+ */
+void setIntervalScale(float scale)
+{
+  intervalScale = std::max(scale, 1.0f);
+  return;
+} // end setIntervalScale
+
+/* Returns the time at the given number of minutes after the local midnight
+ * that begins date. Minutes may be negative or exceed a day. Near DST
+ * transitions, use wallClockTime() instead.
+ */
+static time_t localMinuteTime(const tm &date, int minutes)
+{
+  tm t = date;
+  t.tm_hour  = 0;
+  t.tm_min   = minutes;
+  t.tm_sec   = 0;
+  t.tm_isdst = -1;
+  return mktime(&t);
+} // end localMinuteTime
+
+/* Returns the minutes after the local midnight that begins date that the wall
+ * clock shows at time t. t must be within a few days of date.
+ */
+static int wallMinute(const tm &date, time_t t)
+{
+  tm local = {};
+  localtime_r(&t, &local);
+  int days = local.tm_yday - date.tm_yday;
+  if (local.tm_year != date.tm_year)
+  { // the dates are in adjacent years
+    const tm &prev = (local.tm_year < date.tm_year) ? local : date;
+    const int year = prev.tm_year + 1900;
+    const bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    days += (local.tm_year > date.tm_year ? 1 : -1) * (leap ? 366 : 365);
+  }
+  return days * 24 * 60 + local.tm_hour * 60 + local.tm_min;
+} // end wallMinute
+
+/* Returns the first time at or after earliest (a little after now) at which
+ * the wall clock shows the given number of minutes after the local midnight
+ * that begins date, or 0 if that time has passed.
+ *
+ * The result follows the wall clock across DST transitions, independent of
+ * how mktime() resolves them. A time that the clock skips when it is set
+ * forward is replaced by the moment the clock is set forward. A time that the
+ * clock shows twice when it is set back (by an hour) is at its first
+ * occurrence, or at the second if the first was before now. A first
+ * occurrence between now and earliest is skipped, not repeated.
+ */
+static time_t wallClockTime(const tm &date, int minutes, time_t now,
+                            time_t earliest)
+{
+  time_t t = localMinuteTime(date, minutes);
+  const int shown = wallMinute(date, t);
+  if (shown != minutes)
+  { // skipped, find the first minute the clock shows a later time
+    time_t lo = t - std::abs(shown - minutes) * 60;
+    time_t hi = t + std::abs(shown - minutes) * 60;
+    while (hi - lo > 60)
+    {
+      time_t mid = lo + (hi - lo) / 120 * 60;
+      if (wallMinute(date, mid) > minutes)
+      {
+        hi = mid;
+      }
+      else
+      {
+        lo = mid;
+      }
+    }
+    t = hi;
+  }
+  else
+  {
+    if (wallMinute(date, t - 3600) == minutes)
+    { // shown twice, mktime() resolved it to the second occurrence
+      t -= 3600;
+    }
+    if (t < now && wallMinute(date, t + 3600) == minutes)
+    {
+      t += 3600;
+    }
+  }
+  return (t >= earliest) ? t : 0;
+} // end wallClockTime
+
+/* Returns the time of the next update according to the given rules.
+ *
+ * Each rule opens a window on the days of the week it applies to. Updates are
+ * made every interval minutes (stretched by the interval scale) within the
+ * window, aligned to the start of the window. Updates are scheduled on the
+ * wall clock, so each update of a window is made once, even on days when the
+ * clock is set forward or back. The earliest update of all rules that the wall
+ * clock has not reached yet is chosen. If that update is less than 2 minutes,
+ * or less than 5% of the rule's interval away, it is skipped in favor of the
+ * one after it.
+ */
+time_t getNextWakeTime(time_t now, const sleep_rule_t *rules,
+                       size_t numRules)
+{
+  tm today = {};
+  localtime_r(&now, &today);
+  const int nowMinute = today.tm_hour * 60 + today.tm_min;
+  time_t next = 0;
+
+  // windows that opened yesterday may still be open, a window can be at most
+  // one day long, so a week and a day covers every rule at least once
+  for (int day = -1; day <= 7; ++day)
+  {
+    tm date = today;
+    date.tm_mday += day;
+    date.tm_hour  = 0;
+    date.tm_min   = 0;
+    date.tm_sec   = 0;
+    date.tm_isdst = -1;
+    mktime(&date); // normalizes the date and sets tm_wday
+
+    for (size_t i = 0; i < numRules; ++i)
+    {
+      const sleep_rule_t &rule = rules[i];
+      if (!(rule.days & (1 << date.tm_wday)) || rule.interval == 0)
+      {
+        continue;
+      }
+      int anchor = 0;
+      if (rule.anchor == SCHED_SUNRISE)
+      {
+        anchor = sunriseMinute;
+      }
+      else if (rule.anchor == SCHED_SUNSET)
+      {
+        anchor = sunsetMinute;
+      }
+      if (anchor < 0)
+      {
+        continue;
+      }
+
+      int length = rule.end - rule.start;
+      if (length <= 0)
+      { // window ends the next day, start == end is a full day
+        length += 24 * 60;
+      }
+      // minutes after the midnight that begins date
+      const int start = anchor + rule.start;
+      const int end   = start + length;
+      const int current = nowMinute - day * 24 * 60;
+      const int interval = std::max<int>(lroundf(rule.interval
+                                                 * intervalScale), 1);
+      const time_t earliest = now + std::max(120, interval * 60 / 20);
+
+      // first update after the current minute of the wall clock
+      int minute = start;
+      if (current >= start)
+      {
+        minute += ((current - start) / interval + 1) * interval;
+      }
+      for (; minute < end; minute += interval)
+      {
+        time_t wake = wallClockTime(date, minute, now, earliest);
+        if (wake != 0)
+        {
+          if (next == 0 || wake < next)
+          {
+            next = wake;
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  if (next == 0)
+  { // no rule applies (e.g. all rules are anchored to an unknown sunrise)
+    next = now + SLEEP_DURATION * 60;
+  }
+  return next;
+} // end getNextWakeTime
+
+/* Returns the time of the next update according to SLEEP_RULES.
+ */
+time_t getNextWakeTime(time_t now)
+{
+  return getNextWakeTime(now, SLEEP_RULES, NUM_SLEEP_RULES);
+} // end getNextWakeTime
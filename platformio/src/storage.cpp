@@ -0,0 +1,36 @@
+/* Flash storage for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <mutex>
+#include <LittleFS.h>
+#include "storage.h"
+
+/* Mounts the filesystem (formatting it if it has never been used) the first
+ * time it is called. The weather cache and the frame store are used from
+ * tasks on both cores, so the filesystem is mounted exactly once, and the
+ * other callers wait for the mount to finish. A format must never run while
+ * another task is writing.
+ *
+ * Returns true if the filesystem is ready for use.
+ */
+bool mountStorage()
+{
+  static std::once_flag mountFlag;
+  static bool mounted = false;
+  std::call_once(mountFlag, []() { mounted = LittleFS.begin(true); });
+  return mounted;
+} // end mountStorage
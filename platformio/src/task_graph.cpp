@@ -0,0 +1,124 @@
+/* Task graph for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/task.h>
+#include "logging.h"
+#include "task_graph.h"
+
+// Completion of each task is signaled by setting its dependency bit, so that
+// a task can wait on all of its dependencies at once.
+static EventGroupHandle_t graphEvents = nullptr;
+static graph_task_t *graphTasks = nullptr;
+
+/* FreeRTOS task that runs a single task of the graph once all of its
+ * dependencies have completed.
+ */
+static void graphTaskEntry(void *param)
+{
+  size_t i = reinterpret_cast<size_t>(param);
+  graph_task_t &task = graphTasks[i];
+  if (task.deps != 0)
+  {
+    xEventGroupWaitBits(graphEvents, task.deps, pdFALSE, pdTRUE,
+                        portMAX_DELAY);
+  }
+  task.start = millis();
+  task.run();
+  task.end = millis();
+  xEventGroupSetBits(graphEvents, TASK_DEP(i));
+  vTaskDelete(NULL);
+} // end graphTaskEntry
+
+/* Runs a graph of tasks, each on its own FreeRTOS task pinned to the given
+ * core. A task starts as soon as all tasks it depends on have completed, so
+ * independent tasks run concurrently. Tasks may only depend on tasks with a
+ * lower index. Blocks until every task has completed.
+ */
+void runTaskGraph(graph_task_t *tasks, size_t count)
+{
+  graphTasks = tasks;
+  graphEvents = xEventGroupCreate();
+  for (size_t i = 0; i < count; ++i)
+  {
+    tasks[i].start = 0;
+    tasks[i].end = 0;
+    xTaskCreatePinnedToCore(graphTaskEntry, tasks[i].name, tasks[i].stackSize,
+                            reinterpret_cast<void *>(i), 1, NULL,
+                            tasks[i].core);
+  }
+  xEventGroupWaitBits(graphEvents, TASK_DEP(count) - 1, pdFALSE, pdTRUE,
+                      portMAX_DELAY);
+  vEventGroupDelete(graphEvents);
+  graphEvents = nullptr;
+  graphTasks = nullptr;
+  return;
+} // end runTaskGraph
+
+/* Prints the critical path of a completed task graph, the chain of tasks that
+ * determined when the last task finished. Starting at the task that finished
+ * last, each step goes back to the dependency that finished last.
+ */
+void printCriticalPath(const graph_task_t *tasks, size_t count)
+{
+  if (count == 0)
+  {
+    return;
+  }
+  size_t path[32];
+  size_t len = 0;
+  size_t cur = 0;
+  for (size_t i = 1; i < count; ++i)
+  {
+    if (tasks[i].end > tasks[cur].end)
+    {
+      cur = i;
+    }
+  }
+  while (true)
+  {
+    path[len++] = cur;
+    if (tasks[cur].deps == 0)
+    {
+      break;
+    }
+    size_t next = count;
+    for (size_t i = 0; i < count; ++i)
+    {
+      if ((tasks[cur].deps & TASK_DEP(i))
+       && (next == count || tasks[i].end > tasks[next].end))
+      {
+        next = i;
+      }
+    }
+    cur = next;
+  }
+
+  char line[192];
+  int pos = 0;
+  while (len > 0 && pos < static_cast<int>(sizeof(line)))
+  {
+    const graph_task_t &task = tasks[path[--len]];
+    pos += snprintf(line + pos, sizeof(line) - pos, " %s %.3f-%.3fs%s",
+                    task.name, task.start / 1000.0, task.end / 1000.0,
+                    len > 0 ? " >" : "");
+  }
+  LOG_INFO("Critical path:%s", line);
+  return;
+} // end printCriticalPath
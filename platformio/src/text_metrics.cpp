@@ -0,0 +1,208 @@
+/* Text metrics for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <Adafruit_GFX.h>
+#include "text_metrics.h"
+
+// Text is measured straight from the font's glyph table, which holds the
+// advance and the ink extents of every glyph, in a single pass. The bounds are
+// the same as those of Adafruit_GFX::getTextBounds() for text drawn without
+// wrapping or scaling.
+//
+// The renderer measures many strings more than once (e.g. to pick a font size
+// that fits, and again to align the text), so recent results are memoized.
+// Fonts are constant, so an entry never goes stale.
+
+static const uint32_t TEXT_MEMO_SIZE = 32; // entries, must be a power of 2
+static const size_t   TEXT_MEMO_LEN  = 32; // longest text memoized, with '\0'
+
+typedef struct text_memo
+{
+  const GFXfont *font;
+  char text[TEXT_MEMO_LEN];
+  text_bounds_t bounds;
+} text_memo_t;
+
+static text_memo_t textMemo[TEXT_MEMO_SIZE];
+
+// Ink extents of the characters added so far, and the cursor position
+typedef struct ink_extent
+{
+  int16_t x;
+  int16_t y;
+  int16_t minx;
+  int16_t miny;
+  int16_t maxx;
+  int16_t maxy;
+} ink_extent_t;
+
+static const ink_extent_t EMPTY_EXTENT = {0, 0, INT16_MAX, INT16_MAX, -1, -1};
+
+/* Adds a character to the extent and advances the cursor.
+ */
+static inline void addChar(const GFXfont *font, ink_extent_t &ext, uint8_t c)
+{
+  if (c == '\n')
+  {
+    ext.x = 0;
+    ext.y += font->yAdvance;
+    return;
+  }
+  if (c == '\r' || c < font->first || c > font->last)
+  {
+    return;
+  }
+  const GFXglyph &glyph = font->glyph[c - font->first];
+  // empty glyphs (e.g. space) count too, like in getTextBounds()
+  const int16_t x1 = ext.x + glyph.xOffset;
+  const int16_t y1 = ext.y + glyph.yOffset;
+  ext.minx = std::min(ext.minx, x1);
+  ext.miny = std::min(ext.miny, y1);
+  ext.maxx = std::max<int16_t>(ext.maxx, x1 + glyph.width - 1);
+  ext.maxy = std::max<int16_t>(ext.maxy, y1 + glyph.height - 1);
+  ext.x += glyph.xAdvance;
+  return;
+} // end addChar
+
+/* Returns the width of the extent in pixels.
+ */
+static uint16_t extentWidth(const ink_extent_t &ext)
+{
+  return ext.maxx >= ext.minx ? ext.maxx - ext.minx + 1 : 0;
+} // end extentWidth
+
+/* Returns the bounds of text in the given font, from the glyph table.
+ */
+static text_bounds_t computeBounds(const GFXfont *font, const char *text)
+{
+  ink_extent_t ext = EMPTY_EXTENT;
+  for (const char *p = text; *p != '\0'; ++p)
+  {
+    addChar(font, ext, *p);
+  }
+
+  text_bounds_t bounds = {0, 0, 0, 0};
+  if (ext.maxx >= ext.minx)
+  {
+    bounds.x1 = ext.minx;
+    bounds.w = extentWidth(ext);
+  }
+  if (ext.maxy >= ext.miny)
+  {
+    bounds.y1 = ext.miny;
+    bounds.h = ext.maxy - ext.miny + 1;
+  }
+  return bounds;
+} // end computeBounds
+
+/* Returns the bounds of text drawn in the given font with the cursor at 0,0.
+ */
+text_bounds_t measureText(const GFXfont *font, const char *text)
+{
+  const size_t len = strlen(text);
+  if (len >= TEXT_MEMO_LEN)
+  {
+    return computeBounds(font, text);
+  }
+
+  // FNV-1a
+  uint32_t hash = 2166136261u ^ reinterpret_cast<uintptr_t>(font);
+  for (size_t i = 0; i < len; ++i)
+  {
+    hash = (hash ^ static_cast<uint8_t>(text[i])) * 16777619u;
+  }
+  text_memo_t &entry = textMemo[hash & (TEXT_MEMO_SIZE - 1)];
+  if (entry.font != font || strcmp(entry.text, text) != 0)
+  {
+    entry.font = font;
+    memcpy(entry.text, text, len + 1);
+    entry.bounds = computeBounds(font, text);
+  }
+  return entry.bounds;
+} // end measureText
+
+/* Returns the next line of text that fits in max_width pixels.
+ *
+ * Lines break at spaces, which are not drawn, and after dashes. On the last
+ * line, text is only broken at spaces, and is followed by an ellipsis if it
+ * fits. Of the break points whose line fits, the one furthest along is taken.
+ * If none fits, the line is broken at the first break point, without its dash
+ * or an ellipsis. Text without any break point is not broken, even if it does
+ * not fit.
+ *
+ * The width of every candidate line is taken from a single pass over the
+ * text.
+ */
+text_line_t breakLine(const GFXfont *font, const char *text,
+                      uint16_t max_width, bool last_line)
+{
+  const size_t len = strlen(text);
+  text_line_t line = {len, len, false};
+  if (font == nullptr)
+  {
+    return line;
+  }
+
+  ink_extent_t ext = EMPTY_EXTENT; // text[0, i)
+  size_t fitAt = SIZE_MAX;
+  size_t firstAt = SIZE_MAX;
+  for (size_t i = 0; i < len; ++i)
+  {
+    const uint8_t c = text[i];
+    if (c == ' ' || (c == '-' && !last_line))
+    {
+      ink_extent_t candidate = ext;
+      if (c == '-')
+      {
+        addChar(font, candidate, c);
+      }
+      if (last_line)
+      {
+        for (int n = 0; n < 3; ++n)
+        {
+          addChar(font, candidate, '.');
+        }
+      }
+      if (extentWidth(candidate) <= max_width)
+      {
+        fitAt = i;
+      }
+      firstAt = std::min(firstAt, i);
+    }
+    addChar(font, ext, c);
+  }
+
+  if (extentWidth(ext) <= max_width)
+  { // the rest of the text fits
+    return line;
+  }
+  if (fitAt != SIZE_MAX)
+  {
+    line.len = fitAt + (text[fitAt] == '-' ? 1 : 0);
+    line.next = fitAt + 1;
+    line.ellipsis = last_line;
+  }
+  else if (firstAt != SIZE_MAX)
+  {
+    line.len = firstAt;
+    line.next = firstAt + 1;
+  }
+  return line;
+} // end breakLine
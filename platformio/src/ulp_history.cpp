@@ -0,0 +1,107 @@
+/* ULP sample conversion for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include "ulp_history.h"
+
+/* Returns the ring buffer index of the n-th oldest of the last count samples,
+ * given the index the ULP will store its next sample at.
+ */
+int ulpSampleIndex(uint32_t next, int count, int n)
+{
+  return (next - count + n + ULP_NUM_SAMPLES) & (ULP_NUM_SAMPLES - 1);
+} // end ulpSampleIndex
+
+/* Returns the temperature in Celsius of a raw reading, with the integer
+ * compensation formula from the BME280 datasheet. Also returns t_fine, which
+ * the humidity compensation needs.
+ */
+float bme280Temperature(const bme280_calib_data &c, int32_t adcT,
+                        int32_t *tFine)
+{
+  int32_t var1 = ((((adcT >> 3) - ((int32_t)c.dig_T1 << 1)))
+                  * ((int32_t)c.dig_T2)) >> 11;
+  int32_t var2 = (((((adcT >> 4) - ((int32_t)c.dig_T1))
+                    * ((adcT >> 4) - ((int32_t)c.dig_T1))) >> 12)
+                  * ((int32_t)c.dig_T3)) >> 14;
+  *tFine = var1 + var2;
+  return ((*tFine * 5 + 128) >> 8) / 100.0f;
+} // end bme280Temperature
+
+/* Returns the relative humidity in % of a raw reading, with the integer
+ * compensation formula from the BME280 datasheet.
+ */
+float bme280Humidity(const bme280_calib_data &c, int32_t adcH, int32_t tFine)
+{
+  int32_t v = tFine - 76800;
+  v = (((((adcH << 14) - (((int32_t)c.dig_H4) << 20)
+          - (((int32_t)c.dig_H5) * v)) + 16384) >> 15)
+       * (((((((v * ((int32_t)c.dig_H6)) >> 10)
+              * (((v * ((int32_t)c.dig_H3)) >> 11) + 32768)) >> 10)
+            + 2097152) * ((int32_t)c.dig_H2) + 8192) >> 14));
+  v = v - (((((v >> 15) * (v >> 15)) >> 7) * ((int32_t)c.dig_H1)) >> 4);
+  v = std::min(std::max(v, 0), 419430400);
+  return (v >> 12) / 1024.0f;
+} // end bme280Humidity
+
+/* Converts the samples the ULP stored at data (see ulp_history.h), taken
+ * periodS seconds apart. Fewer than 2 samples give no history (samples 0).
+ */
+indoor_history_t convertUlpSamples(const uint32_t *data, uint32_t periodS,
+                                   const bme280_calib_data &c)
+{
+  indoor_history_t history = {};
+  const int count = std::min<int>(data[1] & 0xFFFF, ULP_NUM_SAMPLES);
+  const uint32_t next = data[0] & (ULP_NUM_SAMPLES - 1);
+  if (count < 2)
+  {
+    return history;
+  }
+
+  float sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+  for (int n = 0; n < count; ++n)
+  {
+    const int i = ulpSampleIndex(next, count, n);
+    const int32_t adcT = (data[2 + 2 * i] & 0xFFFF) << 4;
+    const int32_t adcH = data[3 + 2 * i] & 0xFFFF;
+    int32_t tFine;
+    const float temp = bme280Temperature(c, adcT, &tFine);
+    const float humidity = bme280Humidity(c, adcH, tFine);
+
+    if (n == 0)
+    {
+      history.minTemp = history.maxTemp = temp;
+      history.minHumidity = history.maxHumidity = humidity;
+    }
+    history.minTemp = std::min(history.minTemp, temp);
+    history.maxTemp = std::max(history.maxTemp, temp);
+    history.minHumidity = std::min(history.minHumidity, humidity);
+    history.maxHumidity = std::max(history.maxHumidity, humidity);
+
+    const float hours = n * periodS / 3600.0f;
+    sumX  += hours;
+    sumY  += temp;
+    sumXX += hours * hours;
+    sumXY += hours * temp;
+  }
+  const float denom = count * sumXX - sumX * sumX;
+  history.tempTrend = denom > 0 ? (count * sumXY - sumX * sumY) / denom
+                                : 0.0f;
+  history.samples = count;
+  return history;
+} // end convertUlpSamples
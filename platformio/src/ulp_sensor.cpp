@@ -0,0 +1,227 @@
+/* ULP indoor sensor sampling for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "logging.h"
+#include "ulp_sensor.h"
+
+#if SENSOR_ULP_SAMPLING
+#include <algorithm>
+#include <cmath>
+#include <Arduino.h>
+#include <driver/rtc_io.h>
+#include <esp_sleep.h>
+#include <esp32/ulp.h>
+#include <soc/rtc_cntl_reg.h>
+#include <soc/rtc_i2c_reg.h>
+#include <soc/rtc_io_reg.h>
+#include <soc/sens_reg.h>
+
+// While the esp32 is in deep sleep, the ULP coprocessor periodically powers
+// the BME280, triggers a forced mode measurement (temperature and humidity,
+// no oversampling, no pressure) over the RTC I2C controller and stores the raw
+// readings in RTC slow memory, at ULP_DATA in the layout described in
+// ulp_history.h. The main core converts them once it wakes. The program and
+// the samples must fit in the memory reserved for the ULP (512 bytes).
+static const uint32_t ULP_DATA         = 64;
+static_assert((ULP_DATA + ULP_DATA_WORDS) * 4 <= 512,
+              "ULP samples do not fit in the memory reserved for the ULP");
+static const uint32_t ULP_MIN_PERIOD_S = 60;
+
+// BME280 registers
+static const uint8_t BME280_CTRL_HUM  = 0xF2;
+static const uint8_t BME280_CTRL_MEAS = 0xF4;
+static const uint8_t BME280_TEMP_MSB  = 0xFA;
+static const uint8_t BME280_TEMP_LSB  = 0xFB;
+static const uint8_t BME280_HUM_MSB   = 0xFD;
+static const uint8_t BME280_HUM_LSB   = 0xFE;
+
+RTC_DATA_ATTR static bool     ulpRunning  = false;
+RTC_DATA_ATTR static uint32_t ulpPeriodS  = 0;
+static indoor_history_t indoorHistory = {};
+
+/* Routes a GPIO to the RTC I2C controller. Only GPIO 4 and 2 (SCL) and GPIO 0
+ * and 15 (SDA) can be used.
+ *
+ * Returns false if the GPIO cannot be used.
+ */
+static bool routeRtcI2C(uint8_t pin)
+{
+  gpio_num_t gpio = static_cast<gpio_num_t>(pin);
+  rtc_gpio_init(gpio);
+  rtc_gpio_set_direction(gpio, RTC_GPIO_MODE_INPUT_OUTPUT);
+  rtc_gpio_pullup_en(gpio);
+  switch (pin)
+  {
+  case 4:
+    REG_SET_FIELD(RTC_IO_TOUCH_PAD0_REG, RTC_IO_TOUCH_PAD0_FUN_SEL, 3);
+    return true;
+  case 0:
+    REG_SET_FIELD(RTC_IO_TOUCH_PAD1_REG, RTC_IO_TOUCH_PAD1_FUN_SEL, 3);
+    return true;
+  case 2:
+    REG_SET_FIELD(RTC_IO_TOUCH_PAD2_REG, RTC_IO_TOUCH_PAD2_FUN_SEL, 3);
+    return true;
+  case 15:
+    REG_SET_FIELD(RTC_IO_TOUCH_PAD3_REG, RTC_IO_TOUCH_PAD3_FUN_SEL, 3);
+    return true;
+  default:
+    rtc_gpio_deinit(gpio);
+    return false;
+  }
+} // end routeRtcI2C
+
+/* Starts the ULP coprocessor sampling the BME280 during the coming sleep.
+ * The sampling period is chosen so that the sample buffer covers the sleep.
+ */
+void startUlpSampling(uint64_t sleepDuration)
+{
+  const bool pinsValid = (PIN_BME_SCL == 4 || PIN_BME_SCL == 2)
+                      && (PIN_BME_SDA == 0 || PIN_BME_SDA == 15)
+                      && PIN_BME_PWR != PIN_BME_SCL
+                      && PIN_BME_PWR != PIN_BME_SDA
+                      && rtc_gpio_is_valid_gpio(
+                           static_cast<gpio_num_t>(PIN_BME_PWR));
+  if (!pinsValid)
+  {
+    LOG_DEBUG("ULP sampling    : invalid pins");
+    return;
+  }
+
+  // sensor power, driven by the ULP through the RTC GPIO registers
+  const gpio_num_t pwr = static_cast<gpio_num_t>(PIN_BME_PWR);
+  rtc_gpio_init(pwr);
+  rtc_gpio_set_direction(pwr, RTC_GPIO_MODE_OUTPUT_ONLY);
+  rtc_gpio_set_level(pwr, 0);
+  const int pwrBit = rtc_io_number_get(pwr);
+
+  // I2C at ~100kHz from the 8MHz RTC fast clock
+  routeRtcI2C(PIN_BME_SCL);
+  routeRtcI2C(PIN_BME_SDA);
+  REG_SET_FIELD(RTC_IO_SAR_I2C_IO_REG, RTC_IO_SAR_I2C_SCL_SEL,
+                PIN_BME_SCL == 2 ? 1 : 0);
+  REG_SET_FIELD(RTC_IO_SAR_I2C_IO_REG, RTC_IO_SAR_I2C_SDA_SEL,
+                PIN_BME_SDA == 15 ? 1 : 0);
+  REG_SET_FIELD(RTC_I2C_SCL_LOW_PERIOD_REG, RTC_I2C_SCL_LOW_PERIOD, 40);
+  REG_SET_FIELD(RTC_I2C_SCL_HIGH_PERIOD_REG, RTC_I2C_SCL_HIGH_PERIOD, 40);
+  REG_SET_FIELD(RTC_I2C_SDA_DUTY_REG, RTC_I2C_SDA_DUTY, 16);
+  REG_SET_FIELD(RTC_I2C_SCL_START_PERIOD_REG, RTC_I2C_SCL_START_PERIOD, 30);
+  REG_SET_FIELD(RTC_I2C_SCL_STOP_PERIOD_REG, RTC_I2C_SCL_STOP_PERIOD, 44);
+  REG_SET_FIELD(RTC_I2C_TIMEOUT_REG, RTC_I2C_TIMEOUT, 200);
+  REG_SET_FIELD(RTC_I2C_CTRL_REG, RTC_I2C_MS_MODE, 1);
+  REG_SET_FIELD(SENS_SAR_SLAVE_ADDR1_REG, SENS_I2C_SLAVE_ADDR0, BME_ADDRESS);
+
+  enum { LBL_BUFFER_FULL };
+  const ulp_insn_t program[] = {
+    // power on, the BME280 is ready 2ms later
+    I_WR_REG_BIT(RTC_GPIO_OUT_W1TS_REG, RTC_GPIO_OUT_DATA_W1TS_S + pwrBit, 1),
+    I_DELAY(16000),
+    // forced mode measurement: humidity x1, temperature x1, no pressure
+    I_I2C_WRITE(0, BME280_CTRL_HUM, 0x01),
+    I_I2C_WRITE(0, BME280_CTRL_MEAS, 0x21),
+    I_DELAY(65000), // ~8ms, measurement takes at most 6.4ms
+    I_I2C_READ(0, BME280_TEMP_MSB),
+    I_LSHI(R1, R0, 8),
+    I_I2C_READ(0, BME280_TEMP_LSB),
+    I_ORR(R1, R1, R0),
+    I_I2C_READ(0, BME280_HUM_MSB),
+    I_LSHI(R2, R0, 8),
+    I_I2C_READ(0, BME280_HUM_LSB),
+    I_ORR(R2, R2, R0),
+    I_WR_REG_BIT(RTC_GPIO_OUT_W1TC_REG, RTC_GPIO_OUT_DATA_W1TC_S + pwrBit, 1),
+    // store the sample at the next index of the ring buffer
+    I_MOVI(R3, ULP_DATA),
+    I_LD(R0, R3, 0),
+    I_LSHI(R0, R0, 1),
+    I_ADDR(R0, R0, R3),
+    I_ST(R1, R0, 2),
+    I_ST(R2, R0, 3),
+    I_LD(R0, R3, 0),
+    I_ADDI(R0, R0, 1),
+    I_ANDI(R0, R0, ULP_NUM_SAMPLES - 1),
+    I_ST(R0, R3, 0),
+    // count the sample, until the buffer is full
+    I_LD(R0, R3, 1),
+    M_BGE(LBL_BUFFER_FULL, ULP_NUM_SAMPLES),
+    I_ADDI(R0, R0, 1),
+    I_ST(R0, R3, 1),
+    M_LABEL(LBL_BUFFER_FULL),
+    I_HALT(),
+  };
+
+  size_t size = sizeof(program) / sizeof(ulp_insn_t);
+  RTC_SLOW_MEM[ULP_DATA] = 0;
+  RTC_SLOW_MEM[ULP_DATA + 1] = 0;
+  if (ulp_process_macros_and_load(0, program, &size) != ESP_OK
+   || size > ULP_DATA)
+  {
+    LOG_DEBUG("ULP sampling    : failed to load");
+    return;
+  }
+  ulpPeriodS = std::max<uint32_t>(sleepDuration / 1000000ULL
+                                  / ULP_NUM_SAMPLES, ULP_MIN_PERIOD_S);
+  ulp_set_wakeup_period(0, ulpPeriodS * 1000000UL);
+  // RTC peripherals (I2C, GPIO) must stay powered for the ULP to use them
+  esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+  ulpRunning = ulp_run(0) == ESP_OK;
+  LOG_DEBUG("ULP sampling    : every %us", static_cast<unsigned>(ulpPeriodS));
+  return;
+} // end startUlpSampling
+
+/* Stops the ULP coprocessor sampling and returns the sensor pins to the main
+ * core.
+ */
+void stopUlpSampling()
+{
+  if (!ulpRunning)
+  {
+    return;
+  }
+  CLEAR_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+  delay(20); // let a measurement in progress finish
+  rtc_gpio_deinit(static_cast<gpio_num_t>(PIN_BME_SCL));
+  rtc_gpio_deinit(static_cast<gpio_num_t>(PIN_BME_SDA));
+  rtc_gpio_deinit(static_cast<gpio_num_t>(PIN_BME_PWR));
+  ulpRunning = false;
+  return;
+} // end stopUlpSampling
+
+/* Converts the samples taken by the ULP during the last sleep, using the
+ * sensor's calibration data (read by begin()).
+ */
+void UlpBME280::loadUlpHistory()
+{
+  indoorHistory = convertUlpSamples(&RTC_SLOW_MEM[ULP_DATA], ulpPeriodS,
+                                    _bme280_calib);
+  RTC_SLOW_MEM[ULP_DATA + 1] = 0;
+  if (indoorHistory.samples > 0)
+  {
+    LOG_DEBUG("ULP samples     : %d, %.1f-%.1fC, %.2fC/h",
+              indoorHistory.samples, indoorHistory.minTemp,
+              indoorHistory.maxTemp, indoorHistory.tempTrend);
+  }
+  return;
+} // end loadUlpHistory
+
+/* Returns the indoor conditions over the last sleep, or nullptr if the ULP
+ * took too few samples.
+ */
+const indoor_history_t *getIndoorHistory()
+{
+  return indoorHistory.samples >= 2 ? &indoorHistory : nullptr;
+} // end getIndoorHistory
+#endif
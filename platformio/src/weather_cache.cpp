@@ -0,0 +1,368 @@
+/* Weather data cache for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "api_response.h"
+#include "config.h"
+#include "cpu_governor.h"
+#include "logging.h"
+#include "refresh_policy.h"
+#include "storage.h"
+#include "weather_cache.h"
+
+// The last responses that parsed successfully are kept as received, so that
+// they can be parsed again (by the same code) if a later request fails.
+// One Call responses may only contain some of the sections (see
+// refresh_policy.cpp), so a response is kept for each combination of sections
+// requested, and they are merged in the order they were fetched. The time of
+// the fetch is kept in a header before the response, since the modification
+// times of the files are only as good as the clock was when they were written.
+const char *AIR_POLLUTION_CACHE_PATH = "/air_pollution.json";
+static const char *CACHE_TMP_SUFFIX  = ".tmp";
+static const uint32_t CACHE_MAGIC    = 0x31435745; // "EWC1"
+
+typedef struct cache_header
+{
+  uint32_t magic;
+  int64_t  fetched; // Unix, UTC
+} cache_header_t;
+
+CacheStream::CacheStream(Stream &source, const String &path, int64_t fetched)
+  : _source(source), _path(path), _len(0), _received(0), _ok(false)
+{
+  if (CACHE_MAX_AGE > 0 && mountStorage())
+  {
+    _file = LittleFS.open(_path + CACHE_TMP_SUFFIX, "w");
+    const cache_header_t header = {CACHE_MAGIC, fetched};
+    _ok = _file && _file.write(reinterpret_cast<const uint8_t *>(&header),
+                               sizeof(header)) == sizeof(header);
+  }
+} // end CacheStream
+
+CacheStream::~CacheStream()
+{
+  if (_file)
+  { // not committed
+    _file.close();
+    LittleFS.remove(_path + CACHE_TMP_SUFFIX);
+  }
+} // end ~CacheStream
+
+int CacheStream::available()
+{
+  return _source.available();
+} // end available
+
+int CacheStream::read()
+{
+  int c = _source.read();
+  if (c >= 0)
+  {
+    uint8_t b = static_cast<uint8_t>(c);
+    append(&b, 1);
+  }
+  return c;
+} // end read
+
+int CacheStream::peek()
+{
+  return _source.peek();
+} // end peek
+
+size_t CacheStream::readBytes(char *buffer, size_t length)
+{
+  size_t n = _source.readBytes(buffer, length);
+  append(reinterpret_cast<const uint8_t *>(buffer), n);
+  return n;
+} // end readBytes
+
+size_t CacheStream::write(uint8_t b)
+{
+  return 0; // read only
+} // end write
+
+/* Appends received bytes to the copy, writing to flash in blocks.
+ */
+void CacheStream::append(const uint8_t *data, size_t len)
+{
+  _received += len;
+  while (_ok && len > 0)
+  {
+    size_t n = std::min(len, sizeof(_buf) - _len);
+    memcpy(_buf + _len, data, n);
+    _len += n;
+    data += n;
+    len -= n;
+    if (_len == sizeof(_buf))
+    {
+      _ok = flushBuffer();
+    }
+  }
+  return;
+} // end append
+
+/* Writes the buffered bytes to the copy.
+ */
+bool CacheStream::flushBuffer()
+{
+  bool ok = _file.write(_buf, _len) == _len;
+  _len = 0;
+  return ok;
+} // end flushBuffer
+
+/* Replaces the cached response with the copy of the response read so far.
+ * Should only be called once the response has been parsed successfully.
+ *
+ * Returns true if the cache was updated.
+ */
+bool CacheStream::commit()
+{
+  if (!_file)
+  {
+    return false;
+  }
+  _ok = _ok && flushBuffer();
+  _file.close();
+  const String tmpPath = _path + CACHE_TMP_SUFFIX;
+  if (_ok)
+  {
+    LittleFS.remove(_path);
+    _ok = LittleFS.rename(tmpPath, _path);
+  }
+  if (!_ok)
+  {
+    LittleFS.remove(tmpPath);
+  }
+  LOG_DEBUG("Cache saved     : %s %s", _path.c_str(), _ok ? "true" : "false");
+  return _ok;
+} // end commit
+
+/* Returns the number of bytes read from the source.
+ */
+size_t CacheStream::received() const
+{
+  return _received;
+} // end received
+
+/* Returns the path of the cached One Call response with the given sections.
+ */
+String oneCallCachePath(uint8_t sections)
+{
+  return "/onecall_" + String(sections & DATA_ONECALL) + ".json";
+} // end oneCallCachePath
+
+/* Removes the cached One Call responses that have been superseded by a
+ * response with the given sections, i.e. those with no other sections.
+ */
+void pruneOneCallCache(uint8_t sections)
+{
+  if (CACHE_MAX_AGE <= 0 || !mountStorage())
+  {
+    return;
+  }
+  sections &= DATA_ONECALL;
+  for (uint8_t s = 1; s <= DATA_ONECALL; ++s)
+  {
+    const String path = oneCallCachePath(s);
+    if (s != sections && (s & ~sections) == 0 && LittleFS.exists(path))
+    {
+      LittleFS.remove(path);
+    }
+  }
+  return;
+} // end pruneOneCallCache
+
+/* Opens a cached response for reading, positioned after its header, and
+ * returns the time it was fetched.
+ */
+static File openCache(const String &path, int64_t *fetched = nullptr)
+{
+  if (CACHE_MAX_AGE <= 0 || !mountStorage() || !LittleFS.exists(path))
+  {
+    return File();
+  }
+  File file = LittleFS.open(path, "r");
+  cache_header_t header = {};
+  if (!file
+   || file.read(reinterpret_cast<uint8_t *>(&header), sizeof(header))
+      != sizeof(header)
+   || header.magic != CACHE_MAGIC)
+  { // written by an older version, or incomplete
+    return File();
+  }
+  if (fetched)
+  {
+    *fetched = header.fetched;
+  }
+  return file;
+} // end openCache
+
+/* Shifts the cached forecast to the current time. Hours and days that have
+ * passed are dropped. The series are padded at the end by repeating the last
+ * forecast, for the part of the graph the cache no longer covers. If current
+ * is true, the current conditions are taken from the forecast for the current
+ * hour, for when nothing newer can be fetched.
+ */
+static void shiftOneCall(owm_resp_onecall_t &r, int64_t now, bool current)
+{
+  int skip = 0;
+  while (skip < OWM_NUM_HOURLY - 1 && r.hourly[skip + 1].dt <= now)
+  {
+    ++skip;
+  }
+  for (int i = 0; i < OWM_NUM_HOURLY; ++i)
+  {
+    int src = std::min(i + skip, OWM_NUM_HOURLY - 1);
+    int64_t dt = r.hourly[src].dt + 3600LL * (i + skip - src);
+    r.hourly[i] = r.hourly[src];
+    r.hourly[i].dt = dt;
+  }
+
+  // daily forecasts are for local noon
+  skip = 0;
+  while (skip < OWM_NUM_DAILY - 1
+      && r.daily[skip + 1].dt - 12 * 3600 <= now)
+  {
+    ++skip;
+  }
+  for (int i = 0; i < OWM_NUM_DAILY; ++i)
+  {
+    int src = std::min(i + skip, OWM_NUM_DAILY - 1);
+    int64_t dt = r.daily[src].dt + 86400LL * (i + skip - src);
+    r.daily[i] = r.daily[src];
+    r.daily[i].dt = dt;
+  }
+
+  for (auto it = r.alerts.begin(); it != r.alerts.end();)
+  {
+    it = it->end <= now ? r.alerts.erase(it) : it + 1;
+  }
+  if (!current)
+  {
+    return;
+  }
+
+  const owm_hourly_t &hour = r.hourly[0];
+  r.current.dt         = now;
+  r.current.sunrise    = r.daily[0].sunrise;
+  r.current.sunset     = r.daily[0].sunset;
+  r.current.temp       = hour.temp;
+  r.current.feels_like = hour.feels_like;
+  r.current.pressure   = hour.pressure;
+  r.current.humidity   = hour.humidity;
+  r.current.dew_point  = hour.dew_point;
+  r.current.clouds     = hour.clouds;
+  r.current.uvi        = hour.uvi;
+  r.current.visibility = hour.visibility;
+  r.current.wind_speed = hour.wind_speed;
+  r.current.wind_gust  = hour.wind_gust;
+  r.current.wind_deg   = hour.wind_deg;
+  r.current.rain_1h    = hour.rain_1h;
+  r.current.snow_1h    = hour.snow_1h;
+  r.current.weather    = hour.weather;
+  return;
+} // end shiftOneCall
+
+/* Loads the cached One Call response, shifted to the current time. dt is set to
+ * the time the current conditions were received. The current conditions are
+ * replaced by the forecast for the current hour only if shiftCurrent is true,
+ * i.e. when the cache is drawn offline. Otherwise they are kept as they were
+ * observed, since they are either still fresh (see REFRESH_POLICY) or fetched
+ * again.
+ *
+ * Returns true if the cache has every section, and the current conditions are
+ * no older than CACHE_MAX_AGE.
+ */
+bool loadOneCallCache(owm_resp_onecall_t &r, int64_t now, int64_t &dt,
+                      bool shiftCurrent)
+{
+  // cached responses, oldest first
+  uint8_t order[DATA_ONECALL];
+  int64_t fetched[DATA_ONECALL];
+  int n = 0;
+  uint8_t found = 0;
+  for (uint8_t s = 1; s <= DATA_ONECALL; ++s)
+  {
+    int64_t t;
+    File file = openCache(oneCallCachePath(s), &t);
+    if (!file)
+    {
+      continue;
+    }
+    file.close();
+    int i = n++;
+    for (; i > 0 && fetched[i - 1] > t; --i)
+    {
+      order[i] = order[i - 1];
+      fetched[i] = fetched[i - 1];
+    }
+    order[i] = s;
+    fetched[i] = t;
+    found |= s;
+  }
+  const uint8_t needed = getUsedSections() & DATA_ONECALL;
+  if ((found & needed) != needed)
+  {
+    return false;
+  }
+
+  // later responses replace the sections they contain
+  CpuBoost boost; // parsing is CPU bound
+  for (int i = 0; i < n; ++i)
+  {
+    File file = openCache(oneCallCachePath(order[i]));
+    if (order[i] & DATA_ALERTS)
+    {
+      r.alerts.clear();
+    }
+    DeserializationError jsonErr = deserializeOneCall(file, r);
+    file.close();
+    if (jsonErr)
+    {
+      return false;
+    }
+  }
+  dt = r.current.dt;
+  if (now - dt > CACHE_MAX_AGE * 3600LL)
+  {
+    return false;
+  }
+  shiftOneCall(r, now, shiftCurrent);
+  LOG_DEBUG("Cache age       : %ldmin", static_cast<long>(now - dt) / 60);
+  return true;
+} // end loadOneCallCache
+
+/* Loads the cached Air Pollution response.
+ *
+ * Returns true if the cached response is no older than CACHE_MAX_AGE.
+ */
+bool loadAirPollutionCache(owm_resp_air_pollution_t &r, int64_t now)
+{
+  File file = openCache(AIR_POLLUTION_CACHE_PATH);
+  if (!file)
+  {
+    return false;
+  }
+  CpuBoost boost; // parsing is CPU bound
+  DeserializationError jsonErr = deserializeAirQuality(file, r);
+  file.close();
+  return !jsonErr
+      && now - r.dt[OWM_NUM_AIR_POLLUTION - 1] <= CACHE_MAX_AGE * 3600LL;
+} // end loadAirPollutionCache
@@ -0,0 +1,290 @@
+/* Battery model simulator for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Runs the firmware's battery model (battery_model.cpp) and sleep schedule
+// over a discharge, to check its runtime estimate and, with
+// BATTERY_TARGET_DAYS, how close the stretched sleep intervals come to the
+// target.
+//
+// Usage: [BATTERY_TARGET_DAYS=days] battery_sim [options] [trace]
+//   -a  seconds awake per update, including the refresh    default 15
+//   -i  mA while awake                                     default 75
+//   -z  uA in deep sleep                                   default 15
+//   -c  battery capacity, mAh                              default 5000
+//   -n  voltage reading noise, +/- millivolts              default 10
+//   -p  days between the rows printed                      default 30
+//   -v  print the model's debug output
+//
+// Without a trace the battery is simulated from full, waking on the schedule
+// of the default configuration (30 minutes, 06:00 to 00:00) stretched by the
+// model. A trace replays recorded readings instead, one "seconds millivolts"
+// pair per line, where seconds is a Unix time or the time since the first
+// reading. Lines starting with '#' are ignored.
+//
+// BATTERY_TARGET_DAYS is read from the environment, as it is a constant in
+// the firmware. The other constants are config.cpp's defaults.
+
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+#include <unistd.h>
+#include <Preferences.h>
+#include "battery_model.h"
+#include "config.h"
+#include "scheduler.h"
+
+// as in config.cpp
+static const char *TEST_TIMEZONE = "EST5EDT,M3.2.0,M11.1.0";
+const int SLEEP_DURATION = 30;
+const sleep_rule_t SLEEP_RULES[] = {
+  {SCHED_EVERYDAY, SCHED_MIDNIGHT, 6 * 60, 0, 30},
+};
+const size_t NUM_SLEEP_RULES = sizeof(SLEEP_RULES) / sizeof(SLEEP_RULES[0]);
+const uint32_t LOW_BATTERY_VOLTAGE = 3462;
+const uint32_t MAX_BATTERY_VOLTAGE = 4200;
+const uint32_t MIN_BATTERY_VOLTAGE = 3000;
+const int MAX_SLEEP_DURATION = 120;
+
+/* Returns BATTERY_TARGET_DAYS from the environment, 0 if it is not set.
+ */
+static int targetDays()
+{
+  const char *days = getenv("BATTERY_TARGET_DAYS");
+  return days ? atoi(days) : 0;
+}
+const int BATTERY_TARGET_DAYS = targetDays();
+
+static bool verbose = false;
+
+void logPrintf(const char *format, ...)
+{
+  if (verbose)
+  {
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+  }
+}
+
+typedef struct params
+{
+  double awake_s = 15;
+  double awake_ma = 75;
+  double sleep_ua = 15;
+  double capacity_mah = 5000;
+  int noise_mv = 10;
+  int print_days = 30;
+} params_t;
+
+typedef struct row
+{
+  time_t time;
+  uint32_t millivolts;
+  int wakes;      // per day, on the schedule in effect
+  float estimate; // days, NAN if none yet
+} row_t;
+
+/* Returns the battery voltage at the given percentage, the inverse of
+ * calcBatPercent(), interpolated between the voltages where it steps.
+ */
+static double voltageAt(double percent)
+{
+  if (percent >= 100)
+  {
+    return MAX_BATTERY_VOLTAGE;
+  }
+  const uint32_t whole = static_cast<uint32_t>(std::max(percent, 0.0));
+  uint32_t v0 = MIN_BATTERY_VOLTAGE;
+  while (v0 < MAX_BATTERY_VOLTAGE
+      && calcBatPercent(v0, MIN_BATTERY_VOLTAGE, MAX_BATTERY_VOLTAGE) < whole)
+  {
+    ++v0;
+  }
+  uint32_t v1 = v0;
+  while (v1 < MAX_BATTERY_VOLTAGE
+      && calcBatPercent(v1, MIN_BATTERY_VOLTAGE, MAX_BATTERY_VOLTAGE) <= whole)
+  {
+    ++v1;
+  }
+  return v0 + (percent - whole) * (v1 - v0);
+}
+
+/* Returns the number of updates the scheduler makes in the day after now.
+ */
+static int wakesPerDay(time_t now)
+{
+  int wakes = 0;
+  for (time_t t = getNextWakeTime(now); t <= now + 86400;
+       t = getNextWakeTime(t))
+  {
+    ++wakes;
+  }
+  return wakes;
+}
+
+/* Discharges a simulated battery from full, waking on the stretched schedule,
+ * until it reaches LOW_BATTERY_VOLTAGE or 5 years have passed.
+ */
+static std::vector<row_t> simulate(const params_t &p, time_t start)
+{
+  std::vector<row_t> rows;
+  Preferences prefs;
+  double used_mah = 0;
+  time_t now = start;
+  int wakes = 0;
+  time_t counted = 0;
+  srand(1);
+  while (now - start < 5 * 365 * 86400L)
+  {
+    const double percent = 100 * (1 - used_mah / p.capacity_mah);
+    const int noise = p.noise_mv
+                      ? rand() % (2 * p.noise_mv + 1) - p.noise_mv : 0;
+    const uint32_t mv = static_cast<uint32_t>(lround(voltageAt(percent)))
+                        + noise;
+    if (mv <= LOW_BATTERY_VOLTAGE)
+    {
+      rows.push_back({now, mv, 0, NAN});
+      break;
+    }
+    updateBatteryModel(prefs, mv, now);
+    if (now - counted >= 86400 / 2)
+    { // about twice a day is enough to follow the schedule
+      wakes = wakesPerDay(now);
+      counted = now;
+    }
+    rows.push_back({now, mv, wakes, getBatteryDaysRemaining()});
+
+    const time_t next = getNextWakeTime(now);
+    used_mah += (p.awake_s * p.awake_ma
+                 + (next - now - p.awake_s) * p.sleep_ua / 1000) / 3600;
+    now = next;
+  }
+  return rows;
+}
+
+/* Replays the readings of a trace. Returns an empty list if it cannot be
+ * read.
+ */
+static std::vector<row_t> replay(const char *path, time_t start)
+{
+  std::vector<row_t> rows;
+  FILE *f = fopen(path, "r");
+  if (f == nullptr)
+  {
+    perror(path);
+    return rows;
+  }
+  Preferences prefs;
+  char line[128];
+  while (fgets(line, sizeof(line), f))
+  {
+    long long seconds;
+    unsigned mv;
+    if (line[0] == '#' || sscanf(line, "%lld %u", &seconds, &mv) != 2)
+    {
+      continue;
+    }
+    const time_t now = seconds < 1600000000 ? start + seconds : seconds;
+    updateBatteryModel(prefs, mv, now);
+    rows.push_back({now, mv, wakesPerDay(now), getBatteryDaysRemaining()});
+  }
+  fclose(f);
+  return rows;
+}
+
+int main(int argc, char *argv[])
+{
+  params_t p;
+  int opt;
+  while ((opt = getopt(argc, argv, "a:i:z:c:n:p:v")) != -1)
+  {
+    switch (opt)
+    {
+    case 'a': p.awake_s      = atof(optarg); break;
+    case 'i': p.awake_ma     = atof(optarg); break;
+    case 'z': p.sleep_ua     = atof(optarg); break;
+    case 'c': p.capacity_mah = atof(optarg); break;
+    case 'n': p.noise_mv     = atoi(optarg); break;
+    case 'p': p.print_days   = atoi(optarg); break;
+    case 'v': verbose = true;                break;
+    default:
+      fprintf(stderr, "usage: [BATTERY_TARGET_DAYS=days] %s [-a sec] "
+              "[-i mA] [-z uA] [-c mAh] [-n mV] [-p days] [-v] [trace]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+  setenv("TZ", TEST_TIMEZONE, 1);
+  tzset();
+  tm first = {};
+  first.tm_year  = 2026 - 1900;
+  first.tm_mday  = 1;
+  first.tm_hour  = 6;
+  first.tm_isdst = -1;
+  const time_t start = mktime(&first);
+
+  const std::vector<row_t> rows = (optind < argc) ? replay(argv[optind], start)
+                                                  : simulate(p, start);
+  if (rows.empty())
+  {
+    return 1;
+  }
+  // the runtime is known once the battery is low
+  const row_t &last = rows.back();
+  const bool low = last.millivolts <= LOW_BATTERY_VOLTAGE;
+
+  printf("BATTERY_TARGET_DAYS %d\n", BATTERY_TARGET_DAYS);
+  printf("  day      mV  wakes/day  estimate    actual\n");
+  double sumError = 0;
+  int numError = 0;
+  time_t printed = 0;
+  for (const row_t &r : rows)
+  {
+    const double actual = (last.time - r.time) / 86400.0;
+    if (low && !std::isnan(r.estimate) && &r != &last)
+    {
+      sumError += fabs(r.estimate - actual);
+      ++numError;
+    }
+    if (printed != 0 && r.time - printed < p.print_days * 86400L
+     && &r != &last)
+    {
+      continue;
+    }
+    printed = r.time;
+    printf("%5.0f  %6u", (r.time - rows.front().time) / 86400.0,
+           static_cast<unsigned>(r.millivolts));
+    printf(r.wakes ? "  %9d" : "          -", r.wakes);
+    printf(std::isnan(r.estimate) ? "         -" : "  %8.1f", r.estimate);
+    printf(low ? "  %8.1f\n" : "         -\n", actual);
+  }
+  if (low)
+  {
+    printf("runtime to LOW_BATTERY_VOLTAGE: %.1f days\n",
+           (last.time - rows.front().time) / 86400.0);
+  }
+  if (numError > 0)
+  {
+    printf("mean estimate error: %.1f days\n", sumError / numError);
+  }
+  return 0;
+}
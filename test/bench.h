@@ -0,0 +1,85 @@
+/* Benchmark timing for the host builds of esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+// Each benchmark is run for at least this long, in BENCH_BATCHES batches
+#define BENCH_SECONDS 0.5
+#define BENCH_BATCHES 10
+
+// Results are added here, so that the work being timed is not optimized away
+static volatile uint32_t benchSink = 0;
+
+/* Returns the mean time of a call to fn, in seconds, over one batch of calls.
+ */
+template <typename Fn>
+static double benchBatch(Fn fn)
+{
+  using clock = std::chrono::steady_clock;
+  const clock::time_point start = clock::now();
+  double elapsed = 0;
+  long calls = 0;
+  do
+  {
+    fn();
+    ++calls;
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+  } while (elapsed < BENCH_SECONDS / BENCH_BATCHES);
+  return elapsed / calls;
+}
+
+/* Returns the time of a call to fn, in seconds: the mean of the fastest batch
+ * of calls, which is the least disturbed by other work on the host. fn is
+ * called once before the timing starts.
+ */
+template <typename Fn>
+static double benchSeconds(Fn fn)
+{
+  fn();
+  double best = 1e9;
+  for (int batch = 0; batch < BENCH_BATCHES; ++batch)
+  {
+    best = std::min(best, benchBatch(fn));
+  }
+  return best;
+}
+
+/* Returns the time of a call to fn in seconds, as benchSeconds(), and the time
+ * of a call to fn2 in seconds2. The batches of both are interleaved, so that
+ * they are compared under the same load of the host.
+ */
+template <typename Fn, typename Fn2>
+static double benchSeconds(Fn fn, Fn2 fn2, double &seconds2)
+{
+  fn();
+  fn2();
+  double best = 1e9;
+  seconds2 = 1e9;
+  for (int batch = 0; batch < BENCH_BATCHES; ++batch)
+  {
+    best = std::min(best, benchBatch(fn));
+    seconds2 = std::min(seconds2, benchBatch(fn2));
+  }
+  return best;
+}
+
+#endif
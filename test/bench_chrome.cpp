@@ -0,0 +1,156 @@
+/* Chrome cache benchmark for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Times the drawing of a frame laid out like the renderer's (sample_frame.cpp)
+// through EpdDisplay, for the panel that it is built for with CHROME_CACHE 1
+// (see the Makefile): drawn whole, as without CHROME_CACHE, and started from
+// the chrome layer restored from flash, with only the values drawn over it.
+// The difference is the raster work that the chrome cache saves on each wake.
+// Checks that both frames are identical, when the chrome layer is saved and
+// when it is restored. The time is host CPU time, and flash is held in memory
+// (see host/LittleFS.h), so the time to read the chrome layer from flash is
+// not included, only the time to decompress it.
+
+#include <cstdint>
+#include <cstdio>
+#include <esp_heap_caps.h>
+#include <LittleFS.h>
+#include "bench.h"
+#include "check.h"
+#include "config.h"
+#include "epd_display.h"
+#include "sample_frame.h"
+
+#if !CHROME_CACHE
+  #error bench_chrome must be built with CHROME_CACHE 1.
+#endif
+
+#if defined(DISP_BW_V2)
+  #define PANEL "BW_V2"
+#elif defined(DISP_3C_B)
+  #define PANEL "3C_B"
+#elif defined(DISP_7C_F)
+  #define PANEL "7C_F"
+#else
+  #define PANEL "BW_V1"
+#endif
+
+// key of the chrome layer, which identifies the build in the firmware
+static const uint32_t CHROME_KEY = 0x43484d45;
+
+void boostCpu() {}
+void releaseCpu() {}
+void logPrintf(const char *format, ...) {}
+
+static EpdDisplay *chromeDisplay = nullptr;
+
+/* Draws the chrome layer alone, as drawChrome() in renderer.cpp.
+ */
+static void drawChrome()
+{
+  drawSampleFrame(*chromeDisplay, SAMPLE_CHROME_ONLY);
+}
+
+/* Returns the FNV-1a hash of the frame memory of the panel driver.
+ */
+static uint32_t frameHash(const epd_driver_t &epd2)
+{
+  uint32_t hash = 2166136261u;
+  for (const std::vector<uint8_t> *plane : {&epd2.frame, &epd2.color_frame})
+  {
+    for (uint8_t byte : *plane)
+    {
+      hash = (hash ^ byte) * 16777619u;
+    }
+  }
+  return hash;
+}
+
+/* Draws the whole frame. Returns the number of pages.
+ */
+static uint16_t drawFull(EpdDisplay &display)
+{
+  display.firstPage();
+  const uint16_t pages = display.pages();
+  do
+  {
+    drawSampleFrame(display);
+  } while (display.nextPage());
+  return pages;
+}
+
+/* Draws the frame from the chrome layer, as renderTask() in main.cpp and
+ * restoreChrome() in renderer.cpp do, saving the chrome layer first if it is
+ * not saved yet. Returns how the chrome layer was obtained.
+ */
+static const char *drawCached(EpdDisplay &display)
+{
+  display.firstPage();
+  const char *result = "restored";
+  bool cached = display.restoreChrome(CHROME_KEY);
+  if (!cached)
+  {
+    cached = display.saveChrome(CHROME_KEY, drawChrome);
+    result = cached ? "saved" : "drawn";
+  }
+  do
+  {
+    drawSampleFrame(display, cached ? SAMPLE_CHROME_SKIP
+                                    : SAMPLE_CHROME_DRAW);
+  } while (display.nextPage());
+  return result;
+}
+
+int main()
+{
+  const size_t heaps[] = {90000, 60000}; // bytes of free internal memory
+  for (size_t heap : heaps)
+  {
+    hostFreeHeap = heap;
+    LittleFS.remove("/chrome.bin");
+    EpdDisplay display(epd_driver_t(0, 0, 0, 0));
+    chromeDisplay = &display;
+    display.init(0, true, 10, false);
+    display.setRotation(0);
+    display.setTextSize(1);
+    display.setTextColor(GxEPD_BLACK);
+    display.setTextWrap(false);
+    display.setFullWindow();
+
+    const uint16_t pages = drawFull(display);
+    const uint32_t expected = frameHash(display.epd2);
+    for (const char *wanted : {"saved", "restored"})
+    {
+      const char *result = drawCached(display);
+      CHECK(strcmp(result, wanted) == 0, "%s: chrome layer %s, not %s",
+            PANEL, result, wanted);
+      CHECK(frameHash(display.epd2) == expected,
+            "%s: frame with the %s chrome layer differs", PANEL, result);
+    }
+
+    double cached = 0;
+    const double full = benchSeconds([&] { drawFull(display); },
+                                     [&] { drawCached(display); }, cached);
+    File chrome = LittleFS.open("/chrome.bin", "r");
+    printf("%-5s  heap %6zu  %2u pages  full %7.3f ms  chrome cache %7.3f ms"
+           "  saved %5.3f ms (%4.1f%%)  chrome %5zuB\n",
+           PANEL, heap, pages, full * 1000, cached * 1000,
+           (full - cached) * 1000, 100 * (full - cached) / full,
+           chrome.size());
+  }
+  return checkSummary();
+}
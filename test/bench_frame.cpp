@@ -0,0 +1,134 @@
+/* Frame drawing benchmark for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Times the drawing of a frame laid out like the renderer's (sample_frame.cpp)
+// through EpdDisplay, for the panel and display options that it is built with
+// (see the Makefile). The frame is drawn with the free memory of a typical
+// wake, of a tight one, and of one too tight to keep the heap reserve, which
+// sets the number of pages (see EpdDisplay::allocBuffer()). The time is host
+// CPU time, which only compares the builds with each other.
+//
+// Built with DISPLAY_LIST 1, the first page is recorded and the others are
+// replayed from the display list. Built with DISPLAY_LIST 0, the frame is
+// drawn again for every page. The frames written to the panel driver are
+// summed, and must match between the builds of a panel.
+//
+// Built with DUAL_CORE_RASTER 1, each frame is drawn as on a single core chip,
+// and then with the lower half of each page drawn by a second task, on its
+// own thread. The two frames must be identical. The speedup only shows on a
+// host with more than one hardware thread.
+
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <esp_heap_caps.h>
+#include <freertos/task.h>
+#include "bench.h"
+#include "check.h"
+#include "config.h"
+#include "epd_display.h"
+#include "sample_frame.h"
+
+#if defined(DISP_BW_V2)
+  #define PANEL "BW_V2"
+#elif defined(DISP_3C_B)
+  #define PANEL "3C_B"
+#elif defined(DISP_7C_F)
+  #define PANEL "7C_F"
+#else
+  #define PANEL "BW_V1"
+#endif
+
+#if !DISPLAY_LIST
+  #define MODE "redraw"
+#else
+  #define MODE "display list"
+#endif
+
+void boostCpu() {}
+void releaseCpu() {}
+void logPrintf(const char *format, ...) {}
+
+/* Returns the FNV-1a hash of the frame memory of the panel driver.
+ */
+static uint32_t frameHash(const epd_driver_t &epd2)
+{
+  uint32_t hash = 2166136261u;
+  for (const std::vector<uint8_t> *plane : {&epd2.frame, &epd2.color_frame})
+  {
+    for (uint8_t byte : *plane)
+    {
+      hash = (hash ^ byte) * 16777619u;
+    }
+  }
+  return hash;
+}
+
+/* Times the drawing of the sample frame with heap bytes of free internal
+ * memory, and prints the result. Returns the time per frame in seconds, and
+ * the hash of the frame in hash.
+ */
+static double benchFrame(size_t heap, const char *mode, uint32_t &hash)
+{
+  hostFreeHeap = heap;
+  EpdDisplay display(epd_driver_t(0, 0, 0, 0));
+  display.init(0, true, 10, false);
+  display.setRotation(0);
+  display.setTextSize(1);
+  display.setTextColor(GxEPD_BLACK);
+  display.setTextWrap(false);
+  display.setFullWindow();
+
+  uint16_t pages = 0;
+  const double seconds = benchSeconds([&] {
+    display.firstPage();
+    pages = display.pages();
+    do
+    {
+      drawSampleFrame(display);
+    } while (display.nextPage());
+  });
+  hash = frameHash(display.epd2);
+  printf("%-5s  %-12s  heap %6zu  %2u pages  %7.3f ms/frame  frame %08x\n",
+         PANEL, mode, heap, pages, seconds * 1000, hash);
+  return seconds;
+}
+
+int main()
+{
+  const size_t heaps[] = {90000, 60000, 40000}; // bytes of free internal memory
+#if DUAL_CORE_RASTER
+  printf("host hardware threads: %u\n", std::thread::hardware_concurrency());
+#endif
+  for (size_t heap : heaps)
+  {
+    uint32_t hash = 0;
+#if DUAL_CORE_RASTER
+    hostCores = 1;
+    const double single = benchFrame(heap, "single core", hash);
+    const uint32_t expected = hash;
+    hostCores = 2;
+    const double dual = benchFrame(heap, "dual core", hash);
+    CHECK(hash == expected, "dual core frame %08x, single core frame %08x",
+          hash, expected);
+    printf("%-5s  dual core speedup %.2fx\n", PANEL, single / dual);
+#else
+    benchFrame(heap, MODE, hash);
+#endif
+  }
+  return checkSummary();
+}
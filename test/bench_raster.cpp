@@ -0,0 +1,352 @@
+/* Raster primitive benchmark for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Times the raster primitives of epd_raster.cpp, which write a primitive
+// straight into the page buffer, against drawing the same pixels one at a
+// time through a virtual drawPixel(), as the renderer's loops and
+// Adafruit_GFX did before. Checks that both draw the same pixels, and prints
+// the pixels drawn per second, for the panel format that it is built for (see
+// the Makefile).
+//
+// The workloads are those of a frame: the hatched precipitation bars, dotted
+// gridlines and thick temperature line of the outlook graph, the lines and
+// filled rectangles replayed from the display list, text, and icons, blitted
+// a byte at a time by rasterBitmap() where drawInvertedBitmap() went pixel by
+// pixel.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include <Adafruit_GFX.h>
+#include "bench.h"
+#include "check.h"
+#include "config.h"
+#include "epd_display.h"
+#include "epd_raster.h"
+
+#include FONT_HEADER
+#include "icons/196x196/wi_day_sunny_196x196.h"
+#include "icons/64x64/wi_rain_64x64.h"
+#include "icons/48x48/air_filter_48x48.h"
+#include "icons/32x32/wi_day_cloudy_32x32.h"
+#include "icons/16x16/wifi_3_bar_16x16.h"
+
+static const int16_t W = epd_driver_t::WIDTH;
+static const int16_t H = epd_driver_t::HEIGHT;
+
+static const uint8_t HATCH_EVEN_ROWS[8] = {0xAA, 0x00, 0xAA, 0x00,
+                                           0xAA, 0x00, 0xAA, 0x00};
+static const uint8_t HATCH_ODD_ROWS[8]  = {0x00, 0xAA, 0x00, 0xAA,
+                                           0x00, 0xAA, 0x00, 0xAA};
+
+// A whole frame held in one band
+static std::vector<uint8_t> plane(EPD_FRAME_SIZE);
+static std::vector<uint8_t> colorPlane(EPD_FRAME_SIZE);
+static const epd_band_t band = {plane.data(), colorPlane.data(), 0, 0,
+                                static_cast<int16_t>(H - 1)};
+
+// Draws pixel by pixel into the band, as the panel driver's drawPixel() did
+class PixelCanvas : public Adafruit_GFX
+{
+public:
+  PixelCanvas() : Adafruit_GFX(W, H) { setTextWrap(false); }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override
+  {
+    if (x < 0 || x >= width() || y < 0 || y >= height())
+    {
+      return;
+    }
+    rasterPixel(band, x, y, color);
+  }
+};
+
+// Drawn through a pointer the compiler can't see through, so that each pixel
+// is a virtual call, as it is in the firmware
+static PixelCanvas pixelCanvas;
+static Adafruit_GFX *volatile const gfx = &pixelCanvas;
+
+// A workload, drawn through the raster primitive and pixel by pixel
+typedef struct workload
+{
+  const char *name;
+  std::function<void()> raster;
+  std::function<void()> pixels;
+} workload_t;
+
+/* Returns the number of pixels of the band that are not white.
+ */
+static long countInk()
+{
+  long ink = 0;
+  for (size_t i = 0; i < plane.size(); ++i)
+  {
+#ifdef EPD_FORMAT_7C
+    ink += (plane[i] >> 4) != 0x1;
+    ink += (plane[i] & 0xF) != 0x1;
+#elif defined(EPD_FORMAT_3C)
+    ink += __builtin_popcount(static_cast<uint8_t>(~plane[i] | ~colorPlane[i]));
+#else
+    ink += __builtin_popcount(static_cast<uint8_t>(~plane[i]));
+#endif
+  }
+  return ink;
+}
+
+/* Draws a workload into a white band, and returns a copy of the band.
+ */
+static std::vector<uint8_t> drawn(const std::function<void()> &draw)
+{
+  rasterFill(band, GxEPD_WHITE);
+  draw();
+  std::vector<uint8_t> frame(plane);
+  frame.insert(frame.end(), colorPlane.begin(), colorPlane.end());
+  return frame;
+}
+
+/* Outlook graph precipitation bars, hatched every other pixel.
+ */
+static void bars(bool raster)
+{
+  const int yPos1 = H - 46;
+  for (int i = 0; i < 24; ++i)
+  {
+    const int x0_t = 351 + i * 17;
+    const int x1_t = x0_t + 17;
+    const int y0_t = yPos1 - 40 - (i * 37) % 180;
+    const int y1_t = yPos1;
+    if (raster)
+    {
+      rasterPattern(band, x0_t, y0_t + 1, x1_t - x0_t, y1_t - 1 - y0_t,
+                    ((y1_t - 1) & 1) ? HATCH_ODD_ROWS : HATCH_EVEN_ROWS,
+                    GxEPD_BLACK);
+      continue;
+    }
+    for (int y = y1_t - 1; y > y0_t; y -= 2)
+    {
+      for (int x = x0_t + (x0_t % 2); x < x1_t; x += 2)
+      {
+        gfx->drawPixel(x, y, GxEPD_BLACK);
+      }
+    }
+  }
+}
+
+/* Outlook graph gridlines, every third pixel.
+ */
+static void gridlines(bool raster)
+{
+  const int xPos0 = 350;
+  const int xPos1 = W - 46;
+  for (int i = 0; i < 5; ++i)
+  {
+    const int yTick = 216 + i * 44;
+    if (raster)
+    {
+      rasterDottedHLine(band, xPos0, yTick + (yTick % 2), xPos1 + 2 - xPos0, 3,
+                        GxEPD_BLACK);
+      continue;
+    }
+    for (int x = xPos0; x <= xPos1 + 1; x += 3)
+    {
+      gfx->drawPixel(x, yTick + (yTick % 2), GxEPD_BLACK);
+    }
+  }
+}
+
+/* Outlook graph temperature line, 2 pixels thick.
+ */
+static void temperatureLine(bool raster)
+{
+  for (int i = 1; i < 24; ++i)
+  {
+    const int x0_t = 359 + (i - 1) * 17;
+    const int x1_t = x0_t + 17;
+    const int y0_t = 300 + ((i - 1) * 53) % 120;
+    const int y1_t = 300 + (i * 53) % 120;
+    if (raster)
+    {
+      rasterThickLine(band, x0_t, y0_t, x1_t, y1_t, GxEPD_BLACK);
+      continue;
+    }
+    gfx->drawLine(x0_t    , y0_t    , x1_t    , y1_t    , GxEPD_BLACK);
+    gfx->drawLine(x0_t    , y0_t + 1, x1_t    , y1_t + 1, GxEPD_BLACK);
+    gfx->drawLine(x0_t - 1, y0_t    , x1_t - 1, y1_t    , GxEPD_BLACK);
+  }
+}
+
+/* Lines of every slope, fanning out from the middle of the frame.
+ */
+static void lines(bool raster)
+{
+  for (int i = 0; i < 64; ++i)
+  {
+    const int16_t x1 = W / 2 + static_cast<int16_t>(200 * std::cos(i / 10.2));
+    const int16_t y1 = H / 2 + static_cast<int16_t>(200 * std::sin(i / 10.2));
+    if (raster)
+    {
+      rasterLine(band, W / 2, H / 2, x1, y1, GxEPD_BLACK);
+      continue;
+    }
+    gfx->startWrite();
+    gfx->writeLine(W / 2, H / 2, x1, y1, GxEPD_BLACK);
+    gfx->endWrite();
+  }
+}
+
+/* Filled rectangles, of the size of the axis ticks up to large panels.
+ */
+static void rectangles(bool raster)
+{
+  for (int i = 0; i < 40; ++i)
+  {
+    const int16_t w = 2 + (i * 7) % 120;
+    const int16_t h = 4 + (i * 13) % 80;
+    const int16_t x = (i * 97) % (W - w);
+    const int16_t y = (i * 61) % (H - h);
+    if (raster)
+    {
+      rasterRect(band, x, y, w, h, GxEPD_BLACK);
+      continue;
+    }
+    gfx->fillRect(x, y, w, h, GxEPD_BLACK);
+  }
+}
+
+/* Text in the fonts of the widget values and of the current temperature.
+ */
+static void text(bool raster)
+{
+  static const struct
+  {
+    const GFXfont *font;
+    const char *text;
+    int16_t x;
+    int16_t y;
+  } labels[] = {
+    {&FONT_12pt8b, "Saturday, October 17", 560, 51},
+    {&FONT_12pt8b, "Feels Like 70\260", 220, 177},
+    {&FONT_8pt8b, "75\260 | 58\260  76\260 | 57\260  77\260 | 56\260", 400,
+     167},
+    {&FONT_48pt8b_temperature, "72", 210, 132}};
+  for (const auto &label : labels)
+  {
+    if (!raster)
+    {
+      gfx->setFont(label.font);
+      gfx->setTextColor(GxEPD_BLACK);
+      gfx->setCursor(label.x, label.y);
+      gfx->print(label.text);
+      continue;
+    }
+    int16_t x = label.x;
+    for (const char *c = label.text; *c != '\0'; ++c)
+    {
+      const uint8_t ch = *c;
+      rasterGlyph(band, label.font, ch, x, label.y, GxEPD_BLACK);
+      x += label.font->glyph[ch - label.font->first].xAdvance;
+    }
+  }
+}
+
+/* Icons of each size drawn in a frame, at every alignment to the bytes of the
+ * buffer, and clipped by the edges of the frame.
+ */
+static void icons(bool raster)
+{
+  static const struct
+  {
+    const uint8_t *bitmap;
+    int16_t size;
+    int16_t x;
+    int16_t y;
+    int16_t count;
+  } rows[] = {
+    {wi_day_sunny_196x196, 196, 0, 0, 1},
+    {air_filter_48x48, 48, 0, 204, 8},
+    {wi_rain_64x64, 64, 196, 98, 8},
+    {wi_day_cloudy_32x32, 32, 350, 300, 12},
+    {wifi_3_bar_16x16, 16, 500, H - 14, 8},
+    {wifi_3_bar_16x16, 16, -5, H - 14, 1},
+    {wifi_3_bar_16x16, 16, W - 9, H - 14, 1}};
+  for (const auto &row : rows)
+  {
+    for (int16_t n = 0; n < row.count; ++n)
+    {
+      const int16_t x = row.x + n * (row.size + 1);
+      const int16_t w = row.size;
+      const int16_t h = row.size;
+      if (raster)
+      {
+        rasterBitmap(band, x, row.y, row.bitmap, w, h, GxEPD_BLACK);
+        continue;
+      }
+      // EpdDisplay::drawInvertedBitmap() when rotated, as GxEPD2's was
+      const int16_t byteWidth = (w + 7) / 8;
+      uint8_t byte = 0;
+      for (int16_t j = 0; j < h; ++j)
+      {
+        for (int16_t i = 0; i < w; ++i)
+        {
+          if (i & 7)
+          {
+            byte <<= 1;
+          }
+          else
+          {
+            byte = row.bitmap[j * byteWidth + i / 8];
+          }
+          if (!(byte & 0x80))
+          {
+            gfx->drawPixel(x + i, row.y + j, GxEPD_BLACK);
+          }
+        }
+      }
+    }
+  }
+}
+
+int main()
+{
+  const workload_t workloads[] = {
+    {"rasterPattern", [] { bars(true); }, [] { bars(false); }},
+    {"rasterDottedHLine", [] { gridlines(true); }, [] { gridlines(false); }},
+    {"rasterThickLine", [] { temperatureLine(true); },
+     [] { temperatureLine(false); }},
+    {"rasterLine", [] { lines(true); }, [] { lines(false); }},
+    {"rasterRect", [] { rectangles(true); }, [] { rectangles(false); }},
+    {"rasterGlyph", [] { text(true); }, [] { text(false); }},
+    {"rasterBitmap", [] { icons(true); }, [] { icons(false); }}};
+
+  printf("%-18s %8s  %14s  %14s  %7s\n", "", "pixels", "raster", "per pixel",
+         "speedup");
+  for (const workload_t &workload : workloads)
+  {
+    const std::vector<uint8_t> expected = drawn(workload.pixels);
+    const long ink = countInk();
+    CHECK(drawn(workload.raster) == expected, "%s: the pixels differ",
+          workload.name);
+    const double raster = benchSeconds(workload.raster);
+    const double pixels = benchSeconds(workload.pixels);
+    printf("%-18s %8ld  %8.1f Mpx/s  %8.1f Mpx/s  %6.1fx\n", workload.name,
+           ink, ink / raster / 1e6, ink / pixels / 1e6, pixels / raster);
+  }
+  return checkSummary();
+}
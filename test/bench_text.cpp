@@ -0,0 +1,166 @@
+/* Text measurement benchmark for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Compares measureText() (text_metrics.cpp) with the
+// Adafruit_GFX::getTextBounds() call that the renderer used to measure text
+// with: checks that the bounds are the same for every font of FONT_HEADER,
+// then times both on strings like those the renderer draws.
+//
+// measureText() is timed with the strings in its memo (hit), as when a widget
+// measures a string again to align it, and with more strings than the memo
+// holds (miss). Strings longer than the memo holds are always measured from
+// the glyph table (long).
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <Adafruit_GFX.h>
+#include "bench.h"
+#include "check.h"
+#include "config.h"
+#include "text_metrics.h"
+
+#include FONT_HEADER
+
+static const GFXfont *const FONTS[] = {
+  &FONT_4pt8b, &FONT_5pt8b, &FONT_6pt8b, &FONT_7pt8b, &FONT_8pt8b,
+  &FONT_9pt8b, &FONT_10pt8b, &FONT_11pt8b, &FONT_12pt8b, &FONT_14pt8b,
+  &FONT_16pt8b, &FONT_18pt8b, &FONT_20pt8b, &FONT_22pt8b, &FONT_24pt8b,
+  &FONT_26pt8b, &FONT_48pt8b_temperature};
+
+// as drawn by the renderer
+static const char *const LABELS[] = {
+  "72", "\260F", "Feels Like 70\260", "Sunrise", "6:42", "am", "Sunset",
+  "Wind", "12", "mph", "Humidity", "64%", "UV Index", "- Moderate",
+  "Pressure", "30.12", "inHg", "Air Quality", "- Good", "Visibility", "10",
+  "mi", "Temperature", "71\260", "Sun", "Mon", "Tue", "|", "75\260", "58\260",
+  "Minneapolis", "Saturday, October 17", "80\260", "100", "%", "10AM",
+  "Sat 7:30 am", "Strong (-58dBm)", "94% (4.12v)"};
+
+static const char *const LONG_TEXT[] = {
+  "Winter Weather Advisory - Freezing Rain and Sleet",
+  "Expected Through Sunday Evening",
+  "Small Craft Advisory for Hazardous Seas"};
+
+// Draws nothing, only measures
+class Canvas : public Adafruit_GFX
+{
+public:
+  Canvas() : Adafruit_GFX(800, 480) { setTextWrap(false); }
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {}
+};
+
+/* Returns count strings of 1 to 24 characters from the whole 8 bit range of
+ * the fonts, from a fixed seed.
+ */
+static std::vector<std::string> randomStrings(int count)
+{
+  std::vector<std::string> strings;
+  uint32_t seed = 1;
+  for (int i = 0; i < count; ++i)
+  {
+    seed = seed * 1103515245 + 12345;
+    std::string s(1 + (seed >> 16) % 24, ' ');
+    for (char &c : s)
+    {
+      seed = seed * 1103515245 + 12345;
+      c = static_cast<char>(0x20 + (seed >> 16) % 0xE0);
+    }
+    strings.push_back(s);
+  }
+  return strings;
+}
+
+/* Checks that measureText() gives the same bounds as getTextBounds().
+ */
+static void checkBounds(Canvas &canvas, const GFXfont *font, const char *text)
+{
+  canvas.setFont(font);
+  int16_t x1 = 0, y1 = 0;
+  uint16_t w = 0, h = 0;
+  canvas.getTextBounds(String(text), 0, 0, &x1, &y1, &w, &h);
+  const text_bounds_t b = measureText(font, text);
+  CHECK(b.x1 == x1 && b.y1 == y1 && b.w == w && b.h == h,
+        "\"%s\": %d,%d %ux%u, getTextBounds %d,%d %ux%u",
+        text, b.x1, b.y1, b.w, b.h, x1, y1, w, h);
+}
+
+/* Prints the time per string of measuring each of texts in turn.
+ */
+template <typename Measure>
+static void bench(const char *name, const std::vector<std::string> &texts,
+                  Measure measure)
+{
+  const double seconds = benchSeconds([&] {
+    for (const std::string &text : texts)
+    {
+      benchSink = benchSink + measure(text.c_str());
+    }
+  });
+  printf("  %-28s %7.1f ns/string\n", name, seconds * 1e9 / texts.size());
+}
+
+int main()
+{
+  Canvas canvas;
+  const std::vector<std::string> random = randomStrings(1000);
+  for (const GFXfont *font : FONTS)
+  {
+    for (const char *text : LABELS)
+    {
+      checkBounds(canvas, font, text);
+    }
+    for (const char *text : LONG_TEXT)
+    {
+      checkBounds(canvas, font, text);
+    }
+    for (const std::string &text : random)
+    {
+      checkBounds(canvas, font, text.c_str());
+    }
+    checkBounds(canvas, font, "two\nlines");
+  }
+
+  const GFXfont *font = &FONT_12pt8b;
+  canvas.setFont(font);
+  auto getTextBounds = [&](const char *text) {
+    int16_t x1 = 0, y1 = 0;
+    uint16_t w = 0, h = 0;
+    canvas.getTextBounds(String(text), 0, 0, &x1, &y1, &w, &h);
+    return w;
+  };
+  auto measure = [&](const char *text) {
+    return measureText(font, text).w;
+  };
+
+  const std::vector<std::string> labels(LABELS, LABELS + 16);
+  const std::vector<std::string> manyLabels(random.begin(),
+                                            random.begin() + 256);
+  const std::vector<std::string> longText(std::begin(LONG_TEXT),
+                                          std::end(LONG_TEXT));
+  printf("FONT_12pt8b, %zu labels:\n", labels.size());
+  bench("getTextBounds", labels, getTextBounds);
+  bench("measureText (hit)", labels, measure);
+  printf("FONT_12pt8b, %zu strings:\n", manyLabels.size());
+  bench("getTextBounds", manyLabels, getTextBounds);
+  bench("measureText (miss)", manyLabels, measure);
+  printf("FONT_12pt8b, %zu long strings:\n", longText.size());
+  bench("getTextBounds", longText, getTextBounds);
+  bench("measureText (long)", longText, measure);
+  return checkSummary();
+}
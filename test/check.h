@@ -0,0 +1,48 @@
+/* Test assertions for host builds of esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CHECK_H__
+#define __CHECK_H__
+
+#include <cstdio>
+
+static int checks = 0;
+static int failures = 0;
+
+// Counts a failure and prints the message (printf style) if cond is false.
+// Only the first 20 failures are printed.
+#define CHECK(cond, ...)                                                    \
+  do                                                                        \
+  {                                                                         \
+    ++checks;                                                               \
+    if (!(cond) && ++failures <= 20)                                        \
+    {                                                                       \
+      printf("%s:%d: check failed: %s\n  ", __FILE__, __LINE__, #cond);     \
+      printf(__VA_ARGS__);                                                  \
+      printf("\n");                                                         \
+    }                                                                       \
+  } while (0)
+
+/* Prints the totals. Returns the exit status of the test.
+ */
+static int checkSummary()
+{
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,198 @@
+/* Dirty area report for esp32-weather-epd frames.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Reports the regions that partial refreshes (PARTIAL_REFRESH) would update
+// for a sequence of recorded frames, using the firmware's frame comparison.
+//
+// Usage: dirty_area [-l limit] frame0.pbm frame1.pbm ...
+//   -l  partial refreshes before a full refresh (PARTIAL_REFRESH_LIMIT)
+//
+// Frames are binary PBM (P4) images the size of the panel, e.g. converted
+// from screenshots with ImageMagick:
+//   convert screenshot.png -threshold 50% frame.pbm
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "frame_diff.h"
+
+// same as EpdDisplay
+#define MAX_DIRTY_RECTS 16
+
+typedef struct frame
+{
+  int width;
+  int height;
+  std::vector<uint8_t> bits;
+} frame_t;
+
+/* Skips whitespace and comments in a PBM header.
+ */
+static void skipSpace(FILE *f)
+{
+  int c;
+  while ((c = fgetc(f)) != EOF)
+  {
+    if (c == '#')
+    {
+      while ((c = fgetc(f)) != EOF && c != '\n');
+    }
+    else if (!isspace(c))
+    {
+      ungetc(c, f);
+      return;
+    }
+  }
+  return;
+} // end skipSpace
+
+/* Reads a binary PBM image. Returns false on error.
+ */
+static bool readPbm(const char *path, frame_t &frame)
+{
+  FILE *f = fopen(path, "rb");
+  if (f == nullptr)
+  {
+    fprintf(stderr, "%s: can not open\n", path);
+    return false;
+  }
+  bool ok = fgetc(f) == 'P' && fgetc(f) == '4';
+  skipSpace(f);
+  ok = ok && fscanf(f, "%d", &frame.width) == 1;
+  skipSpace(f);
+  ok = ok && fscanf(f, "%d", &frame.height) == 1;
+  ok = ok && isspace(fgetc(f));
+  if (!ok || frame.width % 8 != 0 || frame.width > DIRTY_MAX_WIDTH
+   || frame.height <= 0)
+  {
+    fprintf(stderr, "%s: not a P4 PBM of width 8n <= %d\n",
+            path, DIRTY_MAX_WIDTH);
+    fclose(f);
+    return false;
+  }
+  frame.bits.resize(frame.width / 8 * frame.height);
+  ok = fread(frame.bits.data(), 1, frame.bits.size(), f) == frame.bits.size();
+  fclose(f);
+  if (!ok)
+  {
+    fprintf(stderr, "%s: truncated\n", path);
+  }
+  return ok;
+} // end readPbm
+
+int main(int argc, char *argv[])
+{
+  int limit = 0;
+  int opt;
+  while ((opt = getopt(argc, argv, "l:")) != -1)
+  {
+    if (opt == 'l')
+    {
+      limit = atoi(optarg);
+    }
+    else
+    {
+      fprintf(stderr, "usage: %s [-l limit] frame.pbm...\n", argv[0]);
+      return 2;
+    }
+  }
+  if (argc - optind < 2)
+  {
+    fprintf(stderr, "usage: %s [-l limit] frame.pbm...\n", argv[0]);
+    return 2;
+  }
+
+  frame_t prev, cur;
+  if (!readPbm(argv[optind], prev))
+  {
+    return 1;
+  }
+  const double pixels = static_cast<double>(prev.width) * prev.height;
+  double dirty_sum = 0, refreshed_sum = 0;
+  int partials = 0, fulls = 0, unchanged = 0, count = 0;
+
+  printf("%-24s %5s %8s %8s  %s\n",
+         "frame", "rects", "dirty%", "window%", "refresh");
+  for (int i = optind + 1; i < argc; ++i)
+  {
+    if (!readPbm(argv[i], cur))
+    {
+      return 1;
+    }
+    if (cur.width != prev.width || cur.height != prev.height)
+    {
+      fprintf(stderr, "%s: size differs from the previous frame\n", argv[i]);
+      return 1;
+    }
+
+    epd_rect_t rects[MAX_DIRTY_RECTS];
+    int n = findDirtyRects(prev.bits.data(), cur.bits.data(),
+                           cur.width, cur.height, rects, MAX_DIRTY_RECTS);
+    int x0 = cur.width, y0 = cur.height, x1 = 0, y1 = 0;
+    double area = 0;
+    for (int r = 0; r < n; ++r)
+    {
+      x0 = std::min<int>(x0, rects[r].x);
+      y0 = std::min<int>(y0, rects[r].y);
+      x1 = std::max<int>(x1, rects[r].x + rects[r].w);
+      y1 = std::max<int>(y1, rects[r].y + rects[r].h);
+      area += static_cast<double>(rects[r].w) * rects[r].h;
+    }
+    double window = (n > 0) ? static_cast<double>(x1 - x0) * (y1 - y0) : 0;
+
+    // the panel refreshes the bounding window of the rectangles, or all of it
+    // once limit partial refreshes have been made in a row
+    const char *mode = "partial";
+    if (limit > 0 && partials >= limit)
+    {
+      mode = "full";
+      window = pixels;
+      partials = 0;
+      ++fulls;
+    }
+    else if (n == 0)
+    {
+      mode = "none";
+      ++unchanged;
+    }
+    else
+    {
+      ++partials;
+    }
+    dirty_sum += area;
+    refreshed_sum += window;
+    ++count;
+
+    std::string name = argv[i];
+    name = name.substr(name.find_last_of('/') + 1);
+    printf("%-24s %5d %7.1f%% %7.1f%%  %s\n", name.c_str(), n,
+           100 * area / pixels, 100 * window / pixels, mode);
+    std::swap(prev, cur);
+  }
+
+  printf("\n%d frames: %d full, %d partial, %d unchanged\n",
+         count, fulls, count - fulls - unchanged, unchanged);
+  printf("mean dirty area      : %.1f%%\n", 100 * dirty_sum / count / pixels);
+  printf("mean refreshed area  : %.1f%%\n",
+         100 * refreshed_sum / count / pixels);
+  return 0;
+} // end main
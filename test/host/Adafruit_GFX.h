@@ -0,0 +1,385 @@
+/* Adafruit GFX Library stand-in for host builds of esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Draws and measures as the Adafruit GFX Library does, so that the firmware's
+// drawing code can be run and compared against it on the host. Declares only
+// what the firmware sources built on the host use. Text in the built-in font
+// is measured, but not drawn.
+
+#ifndef __HOST_ADAFRUIT_GFX_H__
+#define __HOST_ADAFRUIT_GFX_H__
+
+#include <Arduino.h>
+#include "gfxfont.h"
+
+class Adafruit_GFX : public Print
+{
+public:
+  Adafruit_GFX(int16_t w, int16_t h) :
+    WIDTH(w), HEIGHT(h), _width(w), _height(h)
+  {
+  }
+
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+  virtual void startWrite() {}
+  virtual void endWrite() {}
+
+  virtual void writePixel(int16_t x, int16_t y, uint16_t color)
+  {
+    drawPixel(x, y, color);
+  }
+
+  virtual void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                             uint16_t color)
+  {
+    fillRect(x, y, w, h, color);
+  }
+
+  virtual void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+  {
+    drawFastVLine(x, y, h, color);
+  }
+
+  virtual void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+  {
+    drawFastHLine(x, y, w, color);
+  }
+
+  // Bresenham's algorithm
+  virtual void writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                         uint16_t color)
+  {
+    const bool steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep)
+    {
+      std::swap(x0, y0);
+      std::swap(x1, y1);
+    }
+    if (x0 > x1)
+    {
+      std::swap(x0, x1);
+      std::swap(y0, y1);
+    }
+    const int16_t dx = x1 - x0;
+    const int16_t dy = abs(y1 - y0);
+    const int16_t ystep = y0 < y1 ? 1 : -1;
+    int16_t err = dx / 2;
+    for (; x0 <= x1; ++x0)
+    {
+      if (steep)
+      {
+        writePixel(y0, x0, color);
+      }
+      else
+      {
+        writePixel(x0, y0, color);
+      }
+      err -= dy;
+      if (err < 0)
+      {
+        y0 += ystep;
+        err += dx;
+      }
+    }
+  }
+
+  virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+  {
+    startWrite();
+    writeLine(x, y, x, y + h - 1, color);
+    endWrite();
+  }
+
+  virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+  {
+    startWrite();
+    writeLine(x, y, x + w - 1, y, color);
+    endWrite();
+  }
+
+  virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                        uint16_t color)
+  {
+    startWrite();
+    for (int16_t i = x; i < x + w; ++i)
+    {
+      writeFastVLine(i, y, h, color);
+    }
+    endWrite();
+  }
+
+  virtual void fillScreen(uint16_t color)
+  {
+    fillRect(0, 0, _width, _height, color);
+  }
+
+  virtual void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                        uint16_t color)
+  {
+    if (x0 == x1)
+    {
+      if (y0 > y1)
+      {
+        std::swap(y0, y1);
+      }
+      drawFastVLine(x0, y0, y1 - y0 + 1, color);
+    }
+    else if (y0 == y1)
+    {
+      if (x0 > x1)
+      {
+        std::swap(x0, x1);
+      }
+      drawFastHLine(x0, y0, x1 - x0 + 1, color);
+    }
+    else
+    {
+      startWrite();
+      writeLine(x0, y0, x1, y1, color);
+      endWrite();
+    }
+  }
+
+  virtual void drawRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                        uint16_t color)
+  {
+    startWrite();
+    writeFastHLine(x, y, w, color);
+    writeFastHLine(x, y + h - 1, w, color);
+    writeFastVLine(x, y, h, color);
+    writeFastVLine(x + w - 1, y, h, color);
+    endWrite();
+  }
+
+  void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+                uint16_t bg, uint8_t size_x, uint8_t size_y)
+  {
+    if (gfxFont == nullptr)
+    {
+      return;
+    }
+    const GFXglyph &glyph = gfxFont->glyph[c - gfxFont->first];
+    const uint8_t *bitmap = gfxFont->bitmap;
+    uint16_t bo = glyph.bitmapOffset;
+    int16_t xo16 = 0, yo16 = 0;
+    if (size_x > 1 || size_y > 1)
+    {
+      xo16 = glyph.xOffset;
+      yo16 = glyph.yOffset;
+    }
+    uint8_t bits = 0, bit = 0;
+    startWrite();
+    for (uint8_t yy = 0; yy < glyph.height; ++yy)
+    {
+      for (uint8_t xx = 0; xx < glyph.width; ++xx)
+      {
+        if (!(bit++ & 7))
+        {
+          bits = pgm_read_byte(&bitmap[bo++]);
+        }
+        if (bits & 0x80)
+        {
+          if (size_x == 1 && size_y == 1)
+          {
+            writePixel(x + glyph.xOffset + xx, y + glyph.yOffset + yy, color);
+          }
+          else
+          {
+            writeFillRect(x + (xo16 + xx) * size_x, y + (yo16 + yy) * size_y,
+                          size_x, size_y, color);
+          }
+        }
+        bits <<= 1;
+      }
+    }
+    endWrite();
+  }
+
+  virtual size_t write(uint8_t c) override
+  {
+    if (gfxFont == nullptr)
+    {
+      if (c == '\n')
+      {
+        cursor_x = 0;
+        cursor_y += textsize_y * 8;
+      }
+      else if (c != '\r')
+      {
+        if (wrap && cursor_x + textsize_x * 6 > _width)
+        {
+          cursor_x = 0;
+          cursor_y += textsize_y * 8;
+        }
+        drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor,
+                 textsize_x, textsize_y);
+        cursor_x += textsize_x * 6;
+      }
+      return 1;
+    }
+
+    if (c == '\n')
+    {
+      cursor_x = 0;
+      cursor_y += textsize_y * gfxFont->yAdvance;
+    }
+    else if (c != '\r' && c >= gfxFont->first && c <= gfxFont->last)
+    {
+      const GFXglyph &glyph = gfxFont->glyph[c - gfxFont->first];
+      if (glyph.width > 0 && glyph.height > 0)
+      {
+        if (wrap && cursor_x + textsize_x * (glyph.xOffset + glyph.width)
+                    > _width)
+        {
+          cursor_x = 0;
+          cursor_y += textsize_y * gfxFont->yAdvance;
+        }
+        drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor,
+                 textsize_x, textsize_y);
+      }
+      cursor_x += glyph.xAdvance * textsize_x;
+    }
+    return 1;
+  }
+  using Print::write;
+
+  void getTextBounds(const char *str, int16_t x, int16_t y,
+                     int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h)
+  {
+    int16_t minx = 0x7FFF, miny = 0x7FFF, maxx = -1, maxy = -1;
+    *x1 = x;
+    *y1 = y;
+    *w = *h = 0;
+    uint8_t c;
+    while ((c = *str++))
+    {
+      charBounds(c, &x, &y, &minx, &miny, &maxx, &maxy);
+    }
+    if (maxx >= minx)
+    {
+      *x1 = minx;
+      *w = maxx - minx + 1;
+    }
+    if (maxy >= miny)
+    {
+      *y1 = miny;
+      *h = maxy - miny + 1;
+    }
+  }
+
+  // leaves the bounds as they are for an empty string
+  void getTextBounds(const String &str, int16_t x, int16_t y,
+                     int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h)
+  {
+    if (str.length() != 0)
+    {
+      getTextBounds(str.c_str(), x, y, x1, y1, w, h);
+    }
+  }
+
+  void setFont(const GFXfont *f = nullptr)
+  {
+    gfxFont = const_cast<GFXfont *>(f);
+  }
+
+  void setRotation(uint8_t r)
+  {
+    rotation = r & 3;
+    _width = (rotation & 1) ? HEIGHT : WIDTH;
+    _height = (rotation & 1) ? WIDTH : HEIGHT;
+  }
+
+  void setTextSize(uint8_t s) { textsize_x = textsize_y = s > 0 ? s : 1; }
+  void setCursor(int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+  void setTextColor(uint16_t c) { textcolor = textbgcolor = c; }
+  void setTextWrap(bool w) { wrap = w; }
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+  uint8_t getRotation() const { return rotation; }
+  int16_t getCursorX() const { return cursor_x; }
+  int16_t getCursorY() const { return cursor_y; }
+
+protected:
+  int16_t WIDTH;
+  int16_t HEIGHT;
+  int16_t _width;
+  int16_t _height;
+  int16_t cursor_x = 0;
+  int16_t cursor_y = 0;
+  uint16_t textcolor = 0xFFFF;
+  uint16_t textbgcolor = 0xFFFF;
+  uint8_t textsize_x = 1;
+  uint8_t textsize_y = 1;
+  uint8_t rotation = 0;
+  bool wrap = true;
+  GFXfont *gfxFont = nullptr;
+
+private:
+  void charBounds(unsigned char c, int16_t *x, int16_t *y, int16_t *minx,
+                  int16_t *miny, int16_t *maxx, int16_t *maxy)
+  {
+    if (gfxFont == nullptr)
+    {
+      if (c == '\n')
+      {
+        *x = 0;
+        *y += textsize_y * 8;
+      }
+      else if (c != '\r')
+      {
+        if (wrap && *x + textsize_x * 6 > _width)
+        {
+          *x = 0;
+          *y += textsize_y * 8;
+        }
+        *maxx = std::max<int16_t>(*maxx, *x + textsize_x * 6 - 1);
+        *maxy = std::max<int16_t>(*maxy, *y + textsize_y * 8 - 1);
+        *minx = std::min(*minx, *x);
+        *miny = std::min(*miny, *y);
+        *x += textsize_x * 6;
+      }
+      return;
+    }
+
+    if (c == '\n')
+    {
+      *x = 0;
+      *y += textsize_y * gfxFont->yAdvance;
+    }
+    else if (c != '\r' && c >= gfxFont->first && c <= gfxFont->last)
+    {
+      const GFXglyph &glyph = gfxFont->glyph[c - gfxFont->first];
+      if (wrap && *x + (glyph.xOffset + glyph.width) * textsize_x > _width)
+      {
+        *x = 0;
+        *y += textsize_y * gfxFont->yAdvance;
+      }
+      const int16_t x1 = *x + glyph.xOffset * textsize_x;
+      const int16_t y1 = *y + glyph.yOffset * textsize_y;
+      const int16_t x2 = x1 + glyph.width * textsize_x - 1;
+      const int16_t y2 = y1 + glyph.height * textsize_y - 1;
+      *minx = std::min(*minx, x1);
+      *miny = std::min(*miny, y1);
+      *maxx = std::max(*maxx, x2);
+      *maxy = std::max(*maxy, y2);
+      *x += glyph.xAdvance * textsize_x;
+    }
+  }
+};
+
+#endif
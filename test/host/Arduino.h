@@ -0,0 +1,130 @@
+/* Arduino core stand-in for host builds of esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Declares only what the firmware sources built on the host use.
+
+#ifndef __HOST_ARDUINO_H__
+#define __HOST_ARDUINO_H__
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+#define PROGMEM
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define IRAM_ATTR
+
+#define pgm_read_byte(addr)    (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)    (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr)   (*(const uint32_t *)(addr))
+#define pgm_read_pointer(addr) (*(void * const *)(addr))
+
+inline unsigned long millis()
+{
+  using namespace std::chrono;
+  static const steady_clock::time_point start = steady_clock::now();
+  return duration_cast<milliseconds>(steady_clock::now() - start).count();
+}
+
+inline bool psramFound()
+{
+  return false;
+}
+
+class String
+{
+public:
+  String(const char *s = "") : s(s) {}
+  String(const std::string &s) : s(s) {}
+  explicit String(int value) : s(std::to_string(value)) {}
+
+  const char *c_str() const { return s.c_str(); }
+  unsigned int length() const { return s.length(); }
+  bool isEmpty() const { return s.empty(); }
+  char charAt(unsigned int i) const { return i < s.length() ? s[i] : 0; }
+
+  String substring(unsigned int from) const
+  {
+    return from < s.length() ? String(s.substr(from)) : String();
+  }
+
+  String substring(unsigned int from, unsigned int to) const
+  {
+    if (from > to)
+    {
+      std::swap(from, to);
+    }
+    from = std::min<unsigned int>(from, s.length());
+    to = std::min<unsigned int>(to, s.length());
+    return String(s.substr(from, to - from));
+  }
+
+  void remove(unsigned int index)
+  {
+    if (index < s.length())
+    {
+      s.erase(index);
+    }
+  }
+
+  int lastIndexOf(const char *str) const
+  {
+    size_t i = s.rfind(str);
+    return i == std::string::npos ? -1 : static_cast<int>(i);
+  }
+
+  String &operator+=(const String &o) { s += o.s; return *this; }
+  String &operator+=(const char *o) { s += o; return *this; }
+  bool operator==(const String &o) const { return s == o.s; }
+  bool operator!=(const String &o) const { return s != o.s; }
+  friend String operator+(const String &a, const String &b)
+  {
+    return String(a.s + b.s);
+  }
+
+private:
+  std::string s;
+};
+
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+
+  size_t write(const char *str)
+  {
+    size_t n = 0;
+    while (*str)
+    {
+      n += write(static_cast<uint8_t>(*str++));
+    }
+    return n;
+  }
+
+  size_t print(const char *str) { return write(str); }
+  size_t print(const String &str) { return write(str.c_str()); }
+};
+
+#endif
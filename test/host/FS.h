@@ -0,0 +1,82 @@
+/* Arduino file system stand-in for host builds of esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Files are kept in memory (see LittleFS.h). Declares only what the firmware
+// sources built on the host use.
+
+#ifndef __HOST_FS_H__
+#define __HOST_FS_H__
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+class File
+{
+public:
+  File() {}
+  explicit File(std::shared_ptr<std::vector<uint8_t>> data) : _data(data) {}
+
+  explicit operator bool() const { return _data != nullptr; }
+
+  int read()
+  {
+    if (!_data || _pos >= _data->size())
+    {
+      return -1;
+    }
+    return (*_data)[_pos++];
+  }
+
+  size_t read(uint8_t *buf, size_t len)
+  {
+    if (!_data)
+    {
+      return 0;
+    }
+    len = std::min(len, _data->size() - _pos);
+    memcpy(buf, _data->data() + _pos, len);
+    _pos += len;
+    return len;
+  }
+
+  size_t write(const uint8_t *buf, size_t len)
+  {
+    if (!_data)
+    {
+      return 0;
+    }
+    _data->insert(_data->end(), buf, buf + len);
+    return len;
+  }
+
+  size_t size() const { return _data ? _data->size() : 0; }
+
+  void close()
+  {
+    _data.reset();
+    _pos = 0;
+  }
+
+private:
+  std::shared_ptr<std::vector<uint8_t>> _data;
+  size_t _pos = 0;
+};
+
+#endif
@@ -0,0 +1,81 @@
+/* GxEPD2 stand-in for host builds of esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// The panel drivers keep what is written to the controller in memory, so that
+// host harnesses can compare the frames that were drawn. Declares only what
+// the firmware sources built on the host use.
+
+#ifndef __HOST_GXEPD2_H__
+#define __HOST_GXEPD2_H__
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#define GxEPD_BLACK     0x0000
+#define GxEPD_DARKGREY  0x7BEF
+#define GxEPD_LIGHTGREY 0xC618
+#define GxEPD_WHITE     0xFFFF
+#define GxEPD_RED       0xF800
+#define GxEPD_YELLOW    0xFFE0
+#define GxEPD_GREEN     0x07E0
+#define GxEPD_BLUE      0x001F
+#define GxEPD_ORANGE    0xFC00
+
+class GxEPD2_EPD
+{
+public:
+  std::vector<uint8_t> frame;       // controller frame memory
+  std::vector<uint8_t> color_frame; // 3-color panels only
+  uint32_t refreshes = 0;
+
+  GxEPD2_EPD(uint16_t w, uint16_t h, uint8_t bits_per_pixel) :
+    frame(w * h * bits_per_pixel / 8, 0xFF), _bits_per_pixel(bits_per_pixel),
+    _width(w)
+  {
+  }
+
+  void init(uint32_t serial_diag_bitrate, bool initial,
+            uint16_t reset_duration = 10, bool pulldown_rst_mode = false) {}
+  void setBusyCallback(void (*busyCallback)(const void *),
+                       const void *busy_callback_parameter = 0) {}
+  void setPaged() {}
+  void refresh(bool partial_update_mode = false) { ++refreshes; }
+  void refresh(int16_t x, int16_t y, int16_t w, int16_t h) { ++refreshes; }
+  void powerOff() {}
+  void hibernate() {}
+
+protected:
+  void store(std::vector<uint8_t> &plane, const uint8_t *data,
+             int16_t x, int16_t y, int16_t w, int16_t h)
+  {
+    const size_t row = w * _bits_per_pixel / 8;
+    const size_t stride = _width * _bits_per_pixel / 8;
+    const size_t offset = x * _bits_per_pixel / 8;
+    plane.resize(frame.size(), 0xFF);
+    for (int16_t j = 0; j < h; ++j)
+    {
+      memcpy(&plane[(y + j) * stride + offset], data + j * row, row);
+    }
+  }
+
+private:
+  uint8_t _bits_per_pixel;
+  uint16_t _width;
+};
+
+#endif
@@ -0,0 +1,45 @@
+/* GxEPD2_3C stand-in for host builds of esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// The 3-color panel driver, see GxEPD2.h.
+
+#ifndef __HOST_GXEPD2_3C_H__
+#define __HOST_GXEPD2_3C_H__
+
+#include "GxEPD2.h"
+
+class GxEPD2_750c_GDEY075Z08 : public GxEPD2_EPD
+{
+public:
+  static const uint16_t WIDTH = 800;
+  static const uint16_t HEIGHT = 480;
+  static const uint16_t power_on_time = 100; // ms
+
+  GxEPD2_750c_GDEY075Z08(int16_t cs, int16_t dc, int16_t rst, int16_t busy) :
+    GxEPD2_EPD(WIDTH, HEIGHT, 1)
+  {
+  }
+
+  void writeImage(const uint8_t *black, const uint8_t *color,
+                  int16_t x, int16_t y, int16_t w, int16_t h)
+  {
+    store(frame, black, x, y, w, h);
+    store(color_frame, color, x, y, w, h);
+  }
+};
+
+#endif
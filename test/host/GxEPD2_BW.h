@@ -0,0 +1,62 @@
+/* GxEPD2_BW stand-in for host builds of esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// The black and white panel drivers, see GxEPD2.h.
+
+#ifndef __HOST_GXEPD2_BW_H__
+#define __HOST_GXEPD2_BW_H__
+
+#include "GxEPD2.h"
+
+template <uint16_t W, uint16_t H>
+class GxEPD2_BW_Driver : public GxEPD2_EPD
+{
+public:
+  static const uint16_t WIDTH = W;
+  static const uint16_t HEIGHT = H;
+  static const uint16_t power_on_time = 100; // ms
+
+  GxEPD2_BW_Driver(int16_t cs, int16_t dc, int16_t rst, int16_t busy) :
+    GxEPD2_EPD(W, H, 1)
+  {
+  }
+
+  void selectFastFullUpdate(bool) {}
+
+  void writeImage(const uint8_t bitmap[], int16_t x, int16_t y,
+                  int16_t w, int16_t h)
+  {
+    store(frame, bitmap, x, y, w, h);
+  }
+
+  void writeImageForFullRefresh(const uint8_t bitmap[], int16_t x, int16_t y,
+                                int16_t w, int16_t h)
+  {
+    store(frame, bitmap, x, y, w, h);
+  }
+
+  void writeImageAgain(const uint8_t bitmap[], int16_t x, int16_t y,
+                       int16_t w, int16_t h)
+  {
+    store(frame, bitmap, x, y, w, h);
+  }
+};
+
+typedef GxEPD2_BW_Driver<800, 480> GxEPD2_750_GDEY075T7;
+typedef GxEPD2_BW_Driver<640, 384> GxEPD2_750;
+
+#endif
@@ -0,0 +1,65 @@
+/* LittleFS stand-in for host builds of esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// A file system held in memory, that starts out empty. Files opened for
+// writing are created empty, and written at their end.
+
+#ifndef __HOST_LITTLEFS_H__
+#define __HOST_LITTLEFS_H__
+
+#include <map>
+#include <string>
+#include "FS.h"
+
+class HostFS
+{
+public:
+  bool begin(bool format_on_fail) { return true; }
+
+  bool exists(const char *path) const { return _files.count(path) > 0; }
+
+  File open(const char *path, const char *mode)
+  {
+    if (mode[0] == 'w')
+    {
+      _files[path] = std::make_shared<std::vector<uint8_t>>();
+    }
+    auto it = _files.find(path);
+    return it == _files.end() ? File() : File(it->second);
+  }
+
+  bool remove(const char *path) { return _files.erase(path) > 0; }
+
+  bool rename(const char *from, const char *to)
+  {
+    auto it = _files.find(from);
+    if (it == _files.end())
+    {
+      return false;
+    }
+    _files[to] = it->second;
+    _files.erase(from);
+    return true;
+  }
+
+private:
+  std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> _files;
+};
+
+inline HostFS LittleFS;
+
+#endif
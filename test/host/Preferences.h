@@ -0,0 +1,74 @@
+/* Preferences (NVS) stand-in for host builds of esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Keeps the namespace in memory. Declares only what the firmware sources built
+// on the host use.
+
+#ifndef __HOST_PREFERENCES_H__
+#define __HOST_PREFERENCES_H__
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences
+{
+public:
+  bool begin(const char *name, bool readOnly = false)
+  {
+    return true;
+  }
+
+  void end() {}
+
+  size_t getBytes(const char *key, void *buf, size_t maxLen)
+  {
+    auto it = values.find(key);
+    if (it == values.end() || it->second.size() > maxLen)
+    {
+      return 0;
+    }
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+  }
+
+  size_t putBytes(const char *key, const void *value, size_t len)
+  {
+    const uint8_t *bytes = static_cast<const uint8_t *>(value);
+    values[key].assign(bytes, bytes + len);
+    return len;
+  }
+
+  uint32_t getUInt(const char *key, uint32_t defaultValue = 0)
+  {
+    uint32_t value = defaultValue;
+    getBytes(key, &value, sizeof(value));
+    return value;
+  }
+
+  size_t putUInt(const char *key, uint32_t value)
+  {
+    return putBytes(key, &value, sizeof(value));
+  }
+
+private:
+  std::map<std::string, std::vector<uint8_t>> values;
+};
+
+#endif
@@ -0,0 +1,45 @@
+/* ESP-IDF heap stand-in for host builds of esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// The free internal memory is set by the host harness (hostFreeHeap), so that
+// the page buffer is sized as it would be on the esp32. Declares only what the
+// firmware sources built on the host use.
+
+#ifndef __HOST_ESP_HEAP_CAPS_H__
+#define __HOST_ESP_HEAP_CAPS_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+inline size_t hostFreeHeap = 120000; // bytes
+
+inline size_t heap_caps_get_free_size(uint32_t caps)
+{
+  return hostFreeHeap;
+}
+
+inline void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+  return size <= hostFreeHeap ? malloc(size) : nullptr;
+}
+
+#endif
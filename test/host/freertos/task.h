@@ -0,0 +1,95 @@
+/* FreeRTOS task stand-in for host builds of esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Tasks are run on threads, so that the work the firmware spreads over both
+// cores runs in parallel on the host too. A task ends when its function
+// returns. Declares only what the firmware sources built on the host use.
+
+#ifndef __HOST_FREERTOS_TASK_H__
+#define __HOST_FREERTOS_TASK_H__
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "FreeRTOS.h"
+
+typedef struct host_task
+{
+  std::mutex mutex;
+  std::condition_variable cv;
+  uint32_t notifications = 0;
+} *TaskHandle_t;
+
+typedef void (*TaskFunction_t)(void *);
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+  static thread_local host_task task;
+  return &task;
+}
+
+// Cores that tasks can be pinned to. Set to 1 to run as a single core chip,
+// on which tasks pinned to the second core fail to be created.
+inline int hostCores = portNUM_PROCESSORS;
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task,
+                                          const char *name,
+                                          uint32_t stack_depth, void *param,
+                                          UBaseType_t priority,
+                                          TaskHandle_t *created,
+                                          BaseType_t core_id)
+{
+  if (core_id >= hostCores)
+  {
+    return pdFAIL;
+  }
+  std::thread(task, param).detach();
+  return pdPASS;
+}
+
+inline void vTaskDelete(TaskHandle_t task) {}
+
+inline UBaseType_t uxTaskPriorityGet(TaskHandle_t task)
+{
+  return 1;
+}
+
+inline BaseType_t xPortGetCoreID()
+{
+  return 0;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+  std::lock_guard<std::mutex> lock(task->mutex);
+  ++task->notifications;
+  task->cv.notify_one();
+  return pdPASS;
+}
+
+// waits without a timeout
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  std::unique_lock<std::mutex> lock(task->mutex);
+  task->cv.wait(lock, [task] { return task->notifications > 0; });
+  const uint32_t value = task->notifications;
+  task->notifications = clear ? 0 : value - 1;
+  return value;
+}
+
+#endif
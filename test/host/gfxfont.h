@@ -0,0 +1,45 @@
+/* Adafruit GFX font format stand-in for host builds of esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// The font format of the Adafruit GFX Library, which the fonts in
+// lib/esp32-weather-epd-assets are converted to.
+
+#ifndef __HOST_GFXFONT_H__
+#define __HOST_GFXFONT_H__
+
+#include <cstdint>
+
+typedef struct
+{
+  uint16_t bitmapOffset;
+  uint8_t  width;
+  uint8_t  height;
+  uint8_t  xAdvance;
+  int8_t   xOffset;
+  int8_t   yOffset;
+} GFXglyph;
+
+typedef struct
+{
+  uint8_t  *bitmap;
+  GFXglyph *glyph;
+  uint16_t first;
+  uint16_t last;
+  uint8_t  yAdvance;
+} GFXfont;
+
+#endif
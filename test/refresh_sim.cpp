@@ -0,0 +1,157 @@
+/* Refresh policy battery simulation for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Estimates the battery life for a range of FAST_FULL_REFRESH_LIMIT values,
+// to choose a limit that suits the panel.
+//
+// Usage: refresh_sim -s sec -f sec [-p sec -P limit] [options]
+//   -s  standard full refresh duration      "Panel refresh (full)"
+//   -f  fast full refresh duration          "Panel refresh (fast full)"
+//   -p  partial refresh duration            "Panel refresh (partial)"
+//   -P  PARTIAL_REFRESH_LIMIT, with -p
+//   -d  minutes between updates (SLEEP_DURATION)              default 30
+//   -a  seconds awake per update, excluding the refresh       default 12
+//   -i  mA while awake, excluding the refresh                 default 80
+//   -r  mA during the refresh (esp32 waiting and panel)       default 25
+//   -z  uA in deep sleep                                      default 15
+//   -c  battery capacity, mAh                                 default 5000
+//
+// The refresh durations are required. Use the durations the firmware logs for
+// the panel (quoted above), they differ between panels and with temperature.
+// The currents are rough figures for a FireBeetle 2 ESP32-E, replace them with
+// measurements of the board where possible.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+typedef struct params
+{
+  double standard_s = 0;
+  double fast_s = 0;
+  double partial_s = 0;
+  int partial_limit = 0;
+  int interval_min = 30;
+  double awake_s = 12;
+  double awake_ma = 80;
+  double refresh_ma = 25;
+  double sleep_ua = 15;
+  double capacity_mah = 5000;
+} params_t;
+
+typedef struct result
+{
+  double mah_per_day;
+  double standard_per_day;
+} result_t;
+
+/* Simulates a year of updates with the refresh mode selection of EpdDisplay.
+ * A fast_limit of 0 is FAST_FULL_REFRESH disabled.
+ */
+static result_t simulate(const params_t &p, int fast_limit)
+{
+  const int days = 365;
+  const long wakes = static_cast<long>(days) * 24 * 60 / p.interval_min;
+  // RTC memory after a reset, see epd_display.cpp
+  bool frame_stored = false;
+  uint16_t partial_count = 0;
+  uint16_t fast_count = UINT16_MAX;
+  double refresh_s = 0;
+  long standard = 0;
+
+  for (long w = 0; w < wakes; ++w)
+  {
+    if (p.partial_limit > 0 && frame_stored
+     && partial_count < p.partial_limit)
+    {
+      refresh_s += p.partial_s;
+      ++partial_count;
+      continue;
+    }
+    const bool fast = fast_count < fast_limit;
+    refresh_s += fast ? p.fast_s : p.standard_s;
+    standard += !fast;
+    fast_count = fast ? fast_count + 1 : 0;
+    partial_count = 0;
+    frame_stored = true;
+  }
+
+  const double total_s = static_cast<double>(days) * 24 * 3600;
+  const double awake_s = wakes * p.awake_s;
+  const double sleep_s = total_s - awake_s - refresh_s;
+  const double mas = awake_s * p.awake_ma + refresh_s * p.refresh_ma
+                     + sleep_s * p.sleep_ua / 1000;
+  return {mas / 3600 / days, static_cast<double>(standard) / days};
+} // end simulate
+
+int main(int argc, char *argv[])
+{
+  params_t p;
+  int opt;
+  while ((opt = getopt(argc, argv, "s:f:p:P:d:a:i:r:z:c:")) != -1)
+  {
+    switch (opt)
+    {
+    case 's': p.standard_s    = atof(optarg); break;
+    case 'f': p.fast_s        = atof(optarg); break;
+    case 'p': p.partial_s     = atof(optarg); break;
+    case 'P': p.partial_limit = atoi(optarg); break;
+    case 'd': p.interval_min  = atoi(optarg); break;
+    case 'a': p.awake_s       = atof(optarg); break;
+    case 'i': p.awake_ma      = atof(optarg); break;
+    case 'r': p.refresh_ma    = atof(optarg); break;
+    case 'z': p.sleep_ua      = atof(optarg); break;
+    case 'c': p.capacity_mah  = atof(optarg); break;
+    default:
+      fprintf(stderr, "usage: %s -s sec -f sec [-p sec -P limit] "
+                      "[-d min] [-a sec] [-i mA] [-r mA] [-z uA] [-c mAh]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+  if (p.standard_s <= 0 || p.fast_s <= 0 || p.interval_min <= 0
+   || (p.partial_limit > 0 && p.partial_s <= 0))
+  {
+    fprintf(stderr, "%s: refresh durations (-s, -f, and -p with -P) and the "
+                    "update interval must be positive\n", argv[0]);
+    return 2;
+  }
+
+  printf("refresh: standard %.2fs, fast %.2fs", p.standard_s, p.fast_s);
+  if (p.partial_limit > 0)
+  {
+    printf(", partial %.2fs (limit %d)", p.partial_s, p.partial_limit);
+  }
+  printf("\nupdate every %d min, awake %.1fs at %.0fmA, refresh at %.0fmA, "
+         "sleep %.0fuA, %.0fmAh\n\n", p.interval_min, p.awake_s, p.awake_ma,
+         p.refresh_ma, p.sleep_ua, p.capacity_mah);
+
+  const int limits[] = {0, 1, 3, 5, 11, 23, 47, 95};
+  const result_t base = simulate(p, 0);
+  printf("%11s %13s %9s %7s %7s\n",
+         "fast limit", "standard/day", "mAh/day", "days", "gain");
+  for (int limit : limits)
+  {
+    result_t r = simulate(p, limit);
+    printf("%11d %13.1f %9.2f %7.0f %6.1f%%\n", limit, r.standard_per_day,
+           r.mah_per_day, p.capacity_mah / r.mah_per_day,
+           100 * (base.mah_per_day / r.mah_per_day - 1));
+  }
+  printf("\nfast limit 0: FAST_FULL_REFRESH disabled\n");
+  return 0;
+} // end main
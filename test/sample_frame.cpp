@@ -0,0 +1,359 @@
+/* Sample frame for the host benchmarks of esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// A frame laid out like the renderer's (renderer.cpp), with the same widgets,
+// fonts, icons and drawing calls, from fixed weather data. Widgets are
+// skipped on the pages they do not touch, text is measured to be aligned and
+// alert text is broken into lines, as the renderer does.
+
+#include <cmath>
+#include "config.h"
+#include "sample_frame.h"
+#include "text_metrics.h"
+
+#include FONT_HEADER
+#include "icons/196x196/wi_day_sunny_196x196.h"
+#include "icons/64x64/wi_cloudy_64x64.h"
+#include "icons/64x64/wi_day_cloudy_64x64.h"
+#include "icons/64x64/wi_day_sunny_64x64.h"
+#include "icons/64x64/wi_rain_64x64.h"
+#include "icons/64x64/wi_thunderstorm_64x64.h"
+#include "icons/48x48/air_filter_48x48.h"
+#include "icons/48x48/house_humidity_48x48.h"
+#include "icons/48x48/house_thermometer_48x48.h"
+#include "icons/48x48/visibility_icon_48x48.h"
+#include "icons/48x48/warning_icon_48x48.h"
+#include "icons/48x48/wi_barometer_48x48.h"
+#include "icons/48x48/wi_day_sunny_48x48.h"
+#include "icons/48x48/wi_humidity_48x48.h"
+#include "icons/48x48/wi_strong_wind_48x48.h"
+#include "icons/48x48/wi_sunrise_48x48.h"
+#include "icons/48x48/wi_sunset_48x48.h"
+#include "icons/32x32/wi_day_cloudy_32x32.h"
+#include "icons/32x32/wi_day_sunny_32x32.h"
+#include "icons/32x32/wi_night_clear_32x32.h"
+#include "icons/24x24/battery_full_90deg_24x24.h"
+#include "icons/16x16/wi_refresh_16x16.h"
+#include "icons/16x16/wifi_3_bar_16x16.h"
+
+#ifndef ACCENT_COLOR
+  #define ACCENT_COLOR GxEPD_BLACK
+#endif
+
+static const int16_t W = epd_driver_t::WIDTH;
+static const int16_t H = epd_driver_t::HEIGHT;
+
+static const uint8_t HATCH_EVEN_ROWS[8] = {0xAA, 0x00, 0xAA, 0x00,
+                                           0xAA, 0x00, 0xAA, 0x00};
+static const uint8_t HATCH_ODD_ROWS[8]  = {0x00, 0xAA, 0x00, 0xAA,
+                                           0x00, 0xAA, 0x00, 0xAA};
+
+typedef enum alignment
+{
+  LEFT,
+  RIGHT,
+  CENTER
+} alignment_t;
+
+/* Draws a string with alignment, in the current font.
+ */
+static void drawString(EpdDisplay &display, int16_t x, int16_t y,
+                       const String &text, alignment_t alignment,
+                       uint16_t color = GxEPD_BLACK)
+{
+  uint16_t w = measureText(display.getFont(), text.c_str()).w;
+  display.setTextColor(color);
+  if (alignment == RIGHT)
+  {
+    x = x - w;
+  }
+  if (alignment == CENTER)
+  {
+    x = x - w / 2;
+  }
+  display.setCursor(x, y);
+  display.print(text);
+} // end drawString
+
+/* Draws text over up to max_lines lines, in the current font.
+ */
+static void drawMultiLnString(EpdDisplay &display, int16_t x, int16_t y,
+                              const char *text, uint16_t max_width,
+                              uint16_t max_lines, int16_t line_spacing)
+{
+  const String str(text);
+  size_t start = 0;
+  for (uint16_t n = 0; n < max_lines && start < str.length(); ++n)
+  {
+    text_line_t line = breakLine(display.getFont(), text + start, max_width,
+                                 n == max_lines - 1);
+    String subStr = str.substring(start, start + line.len);
+    if (line.ellipsis)
+    {
+      subStr += "...";
+    }
+    drawString(display, x, y + n * line_spacing, subStr, LEFT);
+    start += line.next;
+  }
+} // end drawMultiLnString
+
+/* Current temperature, icon and the ten current conditions widgets. Only the
+ * icons and labels of the widgets are drawn with SAMPLE_CHROME_ONLY, and they
+ * are left out with SAMPLE_CHROME_SKIP.
+ */
+static void drawCurrentConditions(EpdDisplay &display, sample_chrome_t chrome)
+{
+  if (chrome != SAMPLE_CHROME_ONLY && display.isOnPage({0, 0, 360, 197}))
+  {
+    display.drawInvertedBitmap(0, 0, wi_day_sunny_196x196, 196, 196,
+                               GxEPD_BLACK);
+    display.setFont(&FONT_48pt8b_temperature);
+    drawString(display, 196 + 162 / 2 - 20, 196 / 2 + 69 / 2, "72", CENTER);
+    display.setFont(&FONT_14pt8b);
+    drawString(display, display.getCursorX(), 196 / 2 - 69 / 2 + 20, "\260F",
+               LEFT);
+    display.setFont(&FONT_12pt8b);
+    drawString(display, 196 + 162 / 2, 98 + 69 / 2 + 12 + 17,
+               "Feels Like 70\260", CENTER);
+  }
+
+  static const uint8_t *const icons[10] = {
+    wi_sunrise_48x48, wi_sunset_48x48, wi_strong_wind_48x48,
+    wi_humidity_48x48, wi_day_sunny_48x48, wi_barometer_48x48,
+    air_filter_48x48, visibility_icon_48x48, house_thermometer_48x48,
+    house_humidity_48x48};
+  static const char *const labels[10] = {
+    "Sunrise", "Sunset", "Wind", "Humidity", "UV Index", "Pressure",
+    "Air Quality", "Visibility", "Temperature", "Humidity"};
+  static const char *const values[10] = {
+    "6:42", "7:58", "12", "64%", "5", "30.12", "42", "10", "71\260", "48%"};
+  static const char *const units[10] = {
+    "am", "pm", "mph", "", "- Moderate", "inHg", "- Good", "mi", "", ""};
+  for (int pos = 0; pos < 10; ++pos)
+  {
+    const int16_t x = 162 * (pos % 2);
+    const int16_t y = 204 + (48 + 8) * (pos / 2);
+    if (!display.isOnPage({x, y, 162, 48 + 8}))
+    {
+      continue;
+    }
+    if (chrome != SAMPLE_CHROME_SKIP)
+    {
+      display.drawInvertedBitmap(x, y, icons[pos], 48, 48, GxEPD_BLACK);
+      display.setFont(&FONT_7pt8b);
+      drawString(display, x + 48, y + 10, labels[pos], LEFT);
+    }
+    if (chrome == SAMPLE_CHROME_ONLY)
+    {
+      continue;
+    }
+    display.setFont(&FONT_12pt8b);
+    drawString(display, x + 48, y + 17 / 2 + 48 / 2, values[pos], LEFT);
+    display.setFont(&FONT_8pt8b);
+    drawString(display, display.getCursorX(), y + 17 / 2 + 48 / 2, units[pos],
+               LEFT);
+  }
+} // end drawCurrentConditions
+
+/* Five day forecast.
+ */
+static void drawForecast(EpdDisplay &display)
+{
+  if (!display.isOnPage({318, 64, static_cast<int16_t>(W - 318), 136}))
+  {
+    return;
+  }
+  static const uint8_t *const icons[5] = {
+    wi_day_sunny_64x64, wi_day_cloudy_64x64, wi_rain_64x64,
+    wi_thunderstorm_64x64, wi_cloudy_64x64};
+  static const char *const days[5] = {"Sun", "Mon", "Tue", "Wed", "Thu"};
+  for (int i = 0; i < 5; ++i)
+  {
+    const int16_t x = 398 + i * 82;
+    display.drawInvertedBitmap(x, 98 + 69 / 2 - 32 - 6, icons[i], 64, 64,
+                               GxEPD_BLACK);
+    display.setFont(&FONT_11pt8b);
+    drawString(display, x + 31 - 2, 98 + 69 / 2 - 32 - 26 - 6 + 16, days[i],
+               CENTER);
+    display.setFont(&FONT_8pt8b);
+    drawString(display, x + 31, 98 + 69 / 2 + 38 - 6 + 12, "|", CENTER);
+    drawString(display, x + 31 - 4, 98 + 69 / 2 + 38 - 6 + 12,
+               String(75 + i) + "\260", RIGHT);
+    drawString(display, x + 31 + 5, 98 + 69 / 2 + 38 - 6 + 12,
+               String(58 - i) + "\260", LEFT);
+    display.setFont(&FONT_6pt8b);
+    drawString(display, x + 31, 98 + 69 / 2 + 38 - 6 + 26,
+               String(10 * i) + "%", CENTER);
+  }
+} // end drawForecast
+
+/* Location and date in the top right corner.
+ */
+static void drawLocationDate(EpdDisplay &display)
+{
+  if (!display.isOnPage({static_cast<int16_t>(W / 2), 0,
+                         static_cast<int16_t>(W / 2), 60}))
+  {
+    return;
+  }
+  display.setFont(&FONT_16pt8b);
+  drawString(display, W - 2, 23, "Minneapolis", RIGHT, ACCENT_COLOR);
+  display.setFont(&FONT_12pt8b);
+  drawString(display, W - 2, 30 + 4 + 17, "Saturday, October 17", RIGHT);
+} // end drawLocationDate
+
+/* Outlook graph of temperature and chance of precipitation.
+ */
+static void drawOutlookGraph(EpdDisplay &display)
+{
+  if (!display.isOnPage({300, 180, static_cast<int16_t>(W - 300),
+                         static_cast<int16_t>(H - 180 - 20)}))
+  {
+    return;
+  }
+  const int xPos0 = 350;
+  const int xPos1 = W - 46;
+  const int yPos0 = 216;
+  const int yPos1 = H - 46;
+  const int hours = 24;
+
+  display.drawLine(xPos0, yPos1    , xPos1, yPos1    , GxEPD_BLACK);
+  display.drawLine(xPos0, yPos1 - 1, xPos1, yPos1 - 1, GxEPD_BLACK);
+  const float yInterval = (yPos1 - yPos0) / 5.0f;
+  for (int i = 0; i <= 5; ++i)
+  {
+    const int yTick = static_cast<int>(yPos0 + i * yInterval);
+    display.setFont(&FONT_8pt8b);
+    drawString(display, xPos0 - 8, yTick + 4, String(80 - 5 * i) + "\260",
+               RIGHT, ACCENT_COLOR);
+    drawString(display, xPos1 + 8, yTick + 4, String(100 - 20 * i), LEFT);
+    display.setFont(&FONT_5pt8b);
+    drawString(display, display.getCursorX(), yTick + 4, "%", LEFT);
+    if (i < 5)
+    {
+      display.drawDottedHLine(xPos0, yTick + (yTick % 2), xPos1 + 2 - xPos0,
+                              3, GxEPD_BLACK);
+    }
+  }
+
+  const float xInterval = (xPos1 - xPos0 - 1) / static_cast<float>(hours);
+  int x_t[hours];
+  int y_t[hours];
+  for (int i = 0; i < hours; ++i)
+  {
+    x_t[i] = static_cast<int>(std::round(xPos0 + (i + 0.5f) * xInterval));
+    y_t[i] = static_cast<int>(std::round(yPos0 + (yPos1 - yPos0)
+                               * (0.5f + 0.35f * std::sin(i / 3.5f))));
+  }
+  static const uint8_t *const icons[3] = {
+    wi_day_sunny_32x32, wi_day_cloudy_32x32, wi_night_clear_32x32};
+  display.setFont(&FONT_8pt8b);
+  for (int i = 0; i < hours; ++i)
+  {
+    const int xTick = static_cast<int>(xPos0 + i * xInterval);
+    if (i > 0)
+    {
+      display.drawThickLine(x_t[i - 1], y_t[i - 1], x_t[i], y_t[i],
+                            ACCENT_COLOR);
+      if (i % 3 == 0)
+      {
+        display.drawInvertedBitmap(xTick - 16,
+                                   std::min(y_t[i - 1], y_t[i]) - 34,
+                                   icons[i / 3 % 3], 32, 32, GxEPD_BLACK);
+      }
+    }
+    const int pop = 50 + static_cast<int>(45 * std::cos(i / 2.5f));
+    const int x0 = static_cast<int>(std::round(xPos0 + 1 + i * xInterval));
+    const int x1 = static_cast<int>(std::round(xPos0 + 1
+                                               + (i + 1) * xInterval));
+    const int y0 = static_cast<int>(std::round(yPos1 - (yPos1 - yPos0)
+                                               * pop / 100.0f));
+    display.fillPattern(x0, y0 + 1, x1 - x0, yPos1 - 1 - y0,
+                        ((yPos1 - 1) & 1) ? HATCH_ODD_ROWS : HATCH_EVEN_ROWS,
+                        GxEPD_BLACK);
+    if (i % 3 == 0)
+    {
+      display.drawLine(xTick    , yPos1 + 1, xTick    , yPos1 + 4,
+                       GxEPD_BLACK);
+      display.drawLine(xTick + 1, yPos1 + 1, xTick + 1, yPos1 + 4,
+                       GxEPD_BLACK);
+      drawString(display, xTick, yPos1 + 1 + 12 + 4 + 3,
+                 String((i + 9) % 12 + 1) + (i + 9 < 12 ? "AM" : "PM"),
+                 CENTER);
+    }
+  }
+} // end drawOutlookGraph
+
+/* Weather alert, with its title broken into lines.
+ */
+static void drawAlerts(EpdDisplay &display)
+{
+  if (!display.isOnPage({196, 0, static_cast<int16_t>(W - 196), 64}))
+  {
+    return;
+  }
+  display.drawInvertedBitmap(196, 8, warning_icon_48x48, 48, 48, ACCENT_COLOR);
+  display.setFont(&FONT_12pt8b);
+  drawMultiLnString(display, 196 + 48 + 4, 24 + 8,
+                    "Winter Weather Advisory - Freezing Rain and Sleet "
+                    "Expected Through Sunday Evening",
+                    W - 196 - 48 - 4 - 220, 2, 23);
+} // end drawAlerts
+
+/* Status bar along the bottom edge.
+ */
+static void drawStatusBar(EpdDisplay &display)
+{
+  if (!display.isOnPage({0, static_cast<int16_t>(H - 24), W, 24}))
+  {
+    return;
+  }
+  display.setFont(&FONT_6pt8b);
+  int pos = W - 2;
+  drawString(display, pos, H - 1 - 2, "94% (4.12v)", RIGHT);
+  pos -= measureText(&FONT_6pt8b, "94% (4.12v)").w + 25;
+  display.drawInvertedBitmap(pos, H - 1 - 17, battery_full_90deg_24x24,
+                             24, 24, GxEPD_BLACK);
+  pos -= 23;
+  drawString(display, pos, H - 1 - 2, "Strong (-58dBm)", RIGHT);
+  pos -= measureText(&FONT_6pt8b, "Strong (-58dBm)").w + 18;
+  display.drawInvertedBitmap(pos, H - 1 - 13, wifi_3_bar_16x16, 16, 16,
+                             GxEPD_BLACK);
+  pos -= 23;
+  drawString(display, pos, H - 1 - 2, "Sat 7:30 am", RIGHT);
+  pos -= measureText(&FONT_6pt8b, "Sat 7:30 am").w + 25;
+  display.drawInvertedBitmap(pos, H - 1 - 21, wi_refresh_16x16, 16, 16,
+                             GxEPD_BLACK);
+} // end drawStatusBar
+
+/* Draws the sample frame, in the order in which main.cpp draws the widgets.
+ * With SAMPLE_CHROME_ONLY, only the chrome layer is drawn, as by
+ * drawChrome() in renderer.cpp.
+ */
+void drawSampleFrame(EpdDisplay &display, sample_chrome_t chrome)
+{
+  drawCurrentConditions(display, chrome);
+  if (chrome == SAMPLE_CHROME_ONLY)
+  {
+    return;
+  }
+  drawOutlookGraph(display);
+  drawForecast(display);
+  drawLocationDate(display);
+  drawAlerts(display);
+  drawStatusBar(display);
+} // end drawSampleFrame
@@ -0,0 +1,36 @@
+/* Sample frame for the host benchmarks of esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SAMPLE_FRAME_H__
+#define __SAMPLE_FRAME_H__
+
+#include "epd_display.h"
+
+// The chrome layer is the part of the frame that is the same on every wake:
+// the icons and labels of the current conditions widgets, as in renderer.cpp
+// (see CHROME_CACHE).
+typedef enum sample_chrome
+{
+  SAMPLE_CHROME_DRAW, // draw the chrome along with the values
+  SAMPLE_CHROME_ONLY, // draw the chrome alone
+  SAMPLE_CHROME_SKIP  // the chrome is already in the page buffer
+} sample_chrome_t;
+
+void drawSampleFrame(EpdDisplay &display,
+                     sample_chrome_t chrome = SAMPLE_CHROME_DRAW);
+
+#endif
@@ -0,0 +1,271 @@
+/* Line breaking tests for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Checks that breakLine() (text_metrics.cpp) breaks text into the same lines
+// as the drawMultiLnString() it replaced, which measured every candidate
+// line with Adafruit_GFX::getTextBounds(). The text is a corpus of weather
+// alert titles, as the renderer draws them, over a range of widths, line
+// counts and fonts. The corpus must include lines broken after a dash, lines
+// ended by an ellipsis and text without any break point.
+
+#include <cstdio>
+#include <vector>
+#include <Adafruit_GFX.h>
+#include "check.h"
+#include "config.h"
+#include "text_metrics.h"
+
+#include FONT_HEADER
+
+static const GFXfont *const FONTS[] = {
+  &FONT_8pt8b, &FONT_12pt8b, &FONT_14pt8b, &FONT_22pt8b};
+
+// title cased, and truncated at the first ',', '.' or '(' (see
+// truncateExtraAlertInfo())
+static const char *const ALERTS[] = {
+  "Air Quality Alert",
+  "Beach Hazards Statement",
+  "Blizzard Warning",
+  "Coastal Flood Advisory",
+  "Dense Fog Advisory",
+  "Excessive Heat Warning",
+  "Extreme Cold Watch",
+  "Flash Flood Warning",
+  "Freeze Warning",
+  "Frost Advisory",
+  "Gale Warning",
+  "Heat Advisory",
+  "Hurricane Force Wind Warning",
+  "Hydrologic Outlook",
+  "Lake-Effect Snow Warning",
+  "Lakeshore Flood Statement",
+  "Red Flag Warning",
+  "Rip Current Statement",
+  "Severe Thunderstorm Watch",
+  "Small Craft Advisory For Hazardous Seas",
+  "Special Weather Statement",
+  "Storm Surge Warning",
+  "Tornado Warning",
+  "Tropical Storm Warning",
+  "Wind Chill Advisory",
+  "Winter Storm Warning",
+  "Winter Weather Advisory - Freezing Rain And Sleet",
+  "Yellow Thunderstorm Warning - Moderate Risk",
+  "Orange Warning - Rain-Snow Mix Through Sunday",
+  "Severe Weather - High-Wind - Coastal Gales",
+  "Avertissement De Pluie Vergla\347ante",
+  "Unwetterwarnung Vor Orkanb\366en",
+  "Markante Wetterwarnung Vor Gl\344tte",
+  "Aviso Amarillo Por Tormentas - Nivel 2",
+  "Thunderstorm-Warning",
+  "Ice-Pellets-And-Freezing-Drizzle",
+  "Unwetterwarnungvorschneeverwehungen",
+  "Heat"};
+
+// Measures text, draws nothing
+class Canvas : public Adafruit_GFX
+{
+public:
+  Canvas() : Adafruit_GFX(800, 480) { setTextWrap(false); }
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {}
+};
+
+static Canvas canvas;
+
+/* The lines that drawMultiLnString() drew before breakLine(), as in the
+ * firmware, with each line collected instead of drawn.
+ */
+static std::vector<String> oldLines(const String &text, uint16_t max_width,
+                                    uint16_t max_lines)
+{
+  std::vector<String> lines;
+  uint16_t current_line = 0;
+  String textRemaining = text;
+  // print until we reach max_lines or no more text remains
+  while (current_line < max_lines && !textRemaining.isEmpty())
+  {
+    int16_t  x1, y1;
+    uint16_t w, h;
+
+    canvas.getTextBounds(textRemaining, 0, 0, &x1, &y1, &w, &h);
+
+    int endIndex = textRemaining.length();
+    // check if remaining text is to wide, if it is then print what we can
+    String subStr = textRemaining;
+    int splitAt = 0;
+    int keepLastChar = 0;
+    while (w > max_width && splitAt != -1)
+    {
+      if (keepLastChar)
+      {
+        // if we kept the last character during the last iteration of this
+        // while loop, remove it now so we don't get stuck in an infinite
+        // loop.
+        subStr.remove(subStr.length() - 1);
+      }
+
+      // find the last place in the string that we can break it.
+      if (current_line < max_lines - 1)
+      {
+        splitAt = std::max(subStr.lastIndexOf(" "),
+                           subStr.lastIndexOf("-"));
+      }
+      else
+      {
+        // this is the last line, only break at spaces so we can add
+        // ellipsis
+        splitAt = subStr.lastIndexOf(" ");
+      }
+
+      // if splitAt == -1 then there is an unbroken set of characters that is
+      // longer than max_width. Otherwise if splitAt != -1 then we can
+      // continue the loop until the string is <= max_width
+      if (splitAt != -1)
+      {
+        endIndex = splitAt;
+        subStr = subStr.substring(0, endIndex + 1);
+
+        char lastChar = subStr.charAt(endIndex);
+        if (lastChar == ' ')
+        {
+          // remove this char now so it is not counted towards line width
+          keepLastChar = 0;
+          subStr.remove(endIndex);
+          --endIndex;
+        }
+        else if (lastChar == '-')
+        {
+          // this char will be printed on this line and removed next
+          // iteration
+          keepLastChar = 1;
+        }
+
+        if (current_line < max_lines - 1)
+        {
+          // this is not the last line
+          canvas.getTextBounds(subStr, 0, 0, &x1, &y1, &w, &h);
+        }
+        else
+        {
+          // this is the last line, we need to make sure there is space for
+          // ellipsis
+          canvas.getTextBounds(subStr + "...", 0, 0, &x1, &y1, &w, &h);
+          if (w <= max_width)
+          {
+            // ellipsis fit, add them to subStr
+            subStr = subStr + "...";
+          }
+        }
+
+      } // end if (splitAt != -1)
+    } // end inner while
+
+    lines.push_back(subStr);
+
+    // update textRemaining to no longer include what was printed
+    // +1 for exclusive bounds, +1 to get passed space/dash
+    textRemaining = textRemaining.substring(endIndex + 2 - keepLastChar);
+
+    ++current_line;
+  } // end outer while
+
+  return lines;
+}
+
+/* The lines that drawMultiLnString() draws, as in renderer.cpp.
+ */
+static std::vector<String> newLines(const GFXfont *font, const String &text,
+                                    uint16_t max_width, uint16_t max_lines)
+{
+  std::vector<String> lines;
+  const char *str = text.c_str();
+  size_t start = 0;
+  for (uint16_t current_line = 0;
+       current_line < max_lines && start < text.length();
+       ++current_line)
+  {
+    text_line_t line = breakLine(font, str + start, max_width,
+                                 current_line == max_lines - 1);
+    String subStr = text.substring(start, start + line.len);
+    if (line.ellipsis)
+    {
+      subStr += "...";
+    }
+    lines.push_back(subStr);
+    start += line.next;
+  }
+  return lines;
+}
+
+/* Returns the lines joined with '|', for the failure messages.
+ */
+static String joinLines(const std::vector<String> &lines)
+{
+  String joined;
+  for (const String &line : lines)
+  {
+    joined += joined.isEmpty() ? "" : "|";
+    joined += line;
+  }
+  return joined;
+}
+
+int main()
+{
+  int dashBreaks = 0;
+  int ellipses = 0;
+  int unbroken = 0;
+  for (const GFXfont *font : FONTS)
+  {
+    canvas.setFont(font);
+    for (const char *alert : ALERTS)
+    {
+      const String text(alert);
+      for (uint16_t max_width = 40; max_width <= 480; max_width += 3)
+      {
+        for (uint16_t max_lines = 1; max_lines <= 3; ++max_lines)
+        {
+          const std::vector<String> expected = oldLines(text, max_width,
+                                                        max_lines);
+          const std::vector<String> lines = newLines(font, text, max_width,
+                                                     max_lines);
+          CHECK(lines == expected,
+                "\"%s\" in %u px, %u lines: \"%s\", expected \"%s\"",
+                alert, max_width, max_lines, joinLines(lines).c_str(),
+                joinLines(expected).c_str());
+
+          for (const String &line : lines)
+          {
+            const unsigned len = line.length();
+            dashBreaks += len > 0 && line.charAt(len - 1) == '-';
+            ellipses += line.lastIndexOf("...") >= 0;
+          }
+          unbroken += lines.size() == 1 && lines[0] == text
+                      && measureText(font, alert).w > max_width;
+        }
+      }
+    }
+  }
+
+  printf("lines broken after a dash: %d, ended by an ellipsis: %d, "
+         "unbroken text wider than the line: %d\n",
+         dashBreaks, ellipses, unbroken);
+  CHECK(dashBreaks > 0, "no line was broken after a dash");
+  CHECK(ellipses > 0, "no line was ended by an ellipsis");
+  CHECK(unbroken > 0, "no text without a break point was too wide");
+  return checkSummary();
+}
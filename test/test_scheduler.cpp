@@ -0,0 +1,406 @@
+/* Sleep scheduler tests for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Sweeps every minute of a year in TIMEZONE, including both DST transitions.
+// For each rule table:
+//  - following the schedule from wake to wake (also waking a little early or
+//    late, as the RTC does) makes exactly the updates the rules imply on every
+//    day, none doubled or missed
+//  - from every minute of the year, the next wake is the next update of that
+//    schedule
+// and for the rule that config.cpp builds from SLEEP_DURATION, BED_TIME and
+// WAKE_TIME:
+//  - every wake is the same as that of the hand written schedule it replaced
+//    (legacyNextWake()), except where a DST transition falls between the
+//    time and the wake, which the old schedule did not handle
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <map>
+#include <set>
+#include <vector>
+#include "check.h"
+#include "config.h"
+#include "scheduler.h"
+
+// as in config.cpp
+static const char *TEST_TIMEZONE = "EST5EDT,M3.2.0,M11.1.0";
+const int SLEEP_DURATION = 30;
+const sleep_rule_t SLEEP_RULES[] = {
+  {SCHED_EVERYDAY, SCHED_MIDNIGHT, 6 * 60, 0, 30},
+};
+const size_t NUM_SLEEP_RULES = sizeof(SLEEP_RULES) / sizeof(SLEEP_RULES[0]);
+
+static const int YEAR = 2026;
+static const int SUNRISE_MINUTE = 6 * 60 + 40;
+static const int SUNSET_MINUTE  = 19 * 60 + 10;
+
+/* Returns the time of the given local date and time (mktime() normalizes).
+ */
+static time_t localTime(int year, int mon, int mday, int hour, int min)
+{
+  tm t = {};
+  t.tm_year  = year - 1900;
+  t.tm_mon   = mon - 1;
+  t.tm_mday  = mday;
+  t.tm_hour  = hour;
+  t.tm_min   = min;
+  t.tm_isdst = -1;
+  return mktime(&t);
+}
+
+/* Returns the wall clock reading of t, as seconds of a clock without DST, so
+ * that wall clock readings can be compared and subtracted.
+ */
+static time_t wallTime(time_t t)
+{
+  tm local = {};
+  localtime_r(&t, &local);
+  return timegm(&local);
+}
+
+/* Returns the UTC offset at t, in seconds.
+ */
+static long utcOffset(time_t t)
+{
+  return wallTime(t) - t;
+}
+
+/* Returns the first time whose wall clock reading is at or after wall. This
+ * is the moment the clock is set forward for a reading that is skipped, and
+ * the first occurrence of a reading that is repeated when the clock is set
+ * back. The expected schedule is built from these, independently of the
+ * scheduler.
+ */
+static time_t firstTimeAt(time_t wall)
+{
+  // the UTC offset is between -12 and +14 hours
+  time_t lo = wall - 15 * 3600;
+  time_t hi = wall + 13 * 3600;
+  while (hi - lo > 1)
+  { // wall clock readings only go back by the DST shift, well before lo
+    time_t mid = lo + (hi - lo) / 2;
+    if (wallTime(mid) >= wall)
+    {
+      hi = mid;
+    }
+    else
+    {
+      lo = mid;
+    }
+  }
+  // a reading that repeats may have been found at its second occurrence
+  if (wallTime(hi - 3600) == wall)
+  {
+    hi -= 3600;
+  }
+  return hi;
+}
+
+/* Returns the updates that the rules imply between from and to, by
+ * enumerating the updates of each window on the wall clock.
+ */
+static std::vector<time_t> expectedSchedule(const sleep_rule_t *rules,
+                                            size_t numRules,
+                                            time_t from, time_t to)
+{
+  std::set<time_t> updates;
+  tm first = {};
+  localtime_r(&from, &first);
+  for (int day = -1; ; ++day)
+  {
+    tm date = first;
+    date.tm_mday += day;
+    date.tm_hour  = 0;
+    date.tm_min   = 0;
+    date.tm_sec   = 0;
+    date.tm_isdst = -1;
+    time_t midnight = mktime(&date);
+    if (midnight > to)
+    {
+      break;
+    }
+    tm midnightUtc = date;
+    const time_t wallMidnight = timegm(&midnightUtc);
+
+    for (size_t i = 0; i < numRules; ++i)
+    {
+      const sleep_rule_t &rule = rules[i];
+      if (!(rule.days & (1 << date.tm_wday)))
+      {
+        continue;
+      }
+      int anchor = 0;
+      if (rule.anchor == SCHED_SUNRISE)
+      {
+        anchor = SUNRISE_MINUTE;
+      }
+      else if (rule.anchor == SCHED_SUNSET)
+      {
+        anchor = SUNSET_MINUTE;
+      }
+      int length = rule.end - rule.start;
+      if (length <= 0)
+      {
+        length += 24 * 60;
+      }
+      for (int m = 0; m < length; m += rule.interval)
+      {
+        time_t wall = wallMidnight + (anchor + rule.start + m) * 60;
+        time_t t = firstTimeAt(wall);
+        if (t >= from && t <= to)
+        {
+          updates.insert(t);
+        }
+      }
+    }
+  }
+  return std::vector<time_t>(updates.begin(), updates.end());
+}
+
+/* Returns the next wake of the schedule replaced by the sleep rules, as
+ * computed by beginDeepSleep() before, without its RTC drift compensation.
+ */
+static time_t legacyNextWake(time_t now, int sleepDuration, int bedTime,
+                             int wakeTime)
+{
+  tm timeInfo = {};
+  localtime_r(&now, &timeInfo);
+  int bedtimeHour = INT_MAX;
+  if (bedTime != wakeTime)
+  {
+    bedtimeHour = (bedTime - wakeTime + 24) % 24;
+  }
+  int curHour = (timeInfo.tm_hour - wakeTime + 24) % 24;
+  const int curMinute = curHour * 60 + timeInfo.tm_min;
+  const int curSecond = curHour * 3600 + timeInfo.tm_min * 60
+                      + timeInfo.tm_sec;
+  const int desiredSleepSeconds = sleepDuration * 60;
+  const int offsetMinutes = curMinute % sleepDuration;
+  const int offsetSeconds = curSecond % desiredSleepSeconds;
+  int sleepMinutes = sleepDuration - offsetMinutes;
+  if (desiredSleepSeconds - offsetSeconds < 120
+   || offsetSeconds / (float)desiredSleepSeconds > 0.95f)
+  {
+    sleepMinutes += sleepDuration;
+  }
+  const int predictedWakeHour = ((curMinute + sleepMinutes) / 60) % 24;
+  long sleepSeconds;
+  if (predictedWakeHour < bedtimeHour)
+  {
+    sleepSeconds = sleepMinutes * 60 - timeInfo.tm_sec;
+  }
+  else
+  {
+    const int hoursUntilWake = 24 - curHour;
+    sleepSeconds = hoursUntilWake * 3600L
+                   - (timeInfo.tm_min * 60L + timeInfo.tm_sec);
+  }
+  return now + sleepSeconds;
+}
+
+typedef struct test_case
+{
+  const char *name;
+  std::vector<sleep_rule_t> rules;
+  int legacy[3]; // SLEEP_DURATION, BED_TIME, WAKE_TIME, if it is a legacy rule
+} test_case_t;
+
+/* Follows the schedule from wake to wake through the year, waking offset
+ * seconds late (or early, if negative), and checks that the wakes are the
+ * expected updates. Returns the wakes per local date.
+ */
+static std::map<int, int> checkChain(const test_case_t &tc,
+                                     const std::vector<time_t> &expected,
+                                     time_t from, time_t to, int offset)
+{
+  std::map<int, int> perDay;
+  size_t next = std::lower_bound(expected.begin(), expected.end(), from + 120)
+                - expected.begin();
+  time_t wake = getNextWakeTime(from, tc.rules.data(), tc.rules.size());
+  while (wake <= to)
+  {
+    while (next < expected.size() && expected[next] < wake)
+    {
+      CHECK(false, "%s (offset %ds): update at %ld missed", tc.name, offset,
+            (long)expected[next]);
+      ++next;
+    }
+    const bool due = next < expected.size() && expected[next] == wake;
+    CHECK(due, "%s (offset %ds): wake at %ld not in the schedule", tc.name,
+          offset, (long)wake);
+    if (due)
+    {
+      ++next;
+    }
+    tm local = {};
+    localtime_r(&wake, &local);
+    ++perDay[local.tm_yday];
+    wake = getNextWakeTime(wake + offset, tc.rules.data(), tc.rules.size());
+  }
+  CHECK(next == expected.size() || expected[next] > to,
+        "%s (offset %ds): updates from %ld on not made", tc.name, offset,
+        next < expected.size() ? (long)expected[next] : 0L);
+  return perDay;
+}
+
+/* Checks the next wake from every minute between from and to.
+ */
+static void checkSweep(const test_case_t &tc, time_t from, time_t to)
+{
+  // the skip window differs per rule
+  std::vector<std::vector<time_t>> perRule;
+  for (const sleep_rule_t &rule : tc.rules)
+  {
+    perRule.push_back(expectedSchedule(&rule, 1, from, to + 7 * 24 * 3600));
+  }
+  const bool legacy = tc.legacy[0] != 0;
+  long compared = 0;
+  for (time_t now = from; now <= to; now += 60)
+  {
+    // vary the second, updates do not start exactly on the minute
+    const time_t t = now + (now / 60 % 7) * 8;
+    const time_t wake = getNextWakeTime(t, tc.rules.data(), tc.rules.size());
+    // next update of the schedule, with the 2 minute / 5% skip rule
+    time_t due = 0;
+    for (size_t i = 0; i < tc.rules.size(); ++i)
+    {
+      const time_t skip = std::max(120, tc.rules[i].interval * 60 / 20);
+      auto it = std::lower_bound(perRule[i].begin(), perRule[i].end(),
+                                 t + skip);
+      if (it != perRule[i].end() && (due == 0 || *it < due))
+      {
+        due = *it;
+      }
+    }
+    // where the clock is set back, the second occurrence of a repeated
+    // update is only made if the first has passed when the time is set
+    bool repeated = wake < due && wallTime(wake) > wallTime(t)
+                    && firstTimeAt(wallTime(wake)) < t;
+    CHECK(wake == due || repeated, "%s: next wake after %ld is %ld, "
+          "expected %ld", tc.name, (long)t, (long)wake, (long)due);
+
+    if (legacy)
+    {
+      const time_t old = legacyNextWake(t, tc.legacy[0], tc.legacy[1],
+                                        tc.legacy[2]);
+      if (utcOffset(t) == utcOffset(old) && utcOffset(t) == utcOffset(wake))
+      {
+        CHECK(wake == old, "%s: next wake after %ld is %ld, legacy %ld",
+              tc.name, (long)t, (long)wake, (long)old);
+        ++compared;
+      }
+    }
+  }
+  if (legacy)
+  {
+    printf("  %ld minutes compared with the legacy schedule\n", compared);
+  }
+}
+
+/* Returns the local date of t as "mm-dd".
+ */
+static const char *dateString(int yday)
+{
+  static char buf[8];
+  tm t = {};
+  t.tm_year = YEAR - 1900;
+  t.tm_mday = yday + 1;
+  t.tm_isdst = -1;
+  mktime(&t);
+  strftime(buf, sizeof(buf), "%m-%d", &t);
+  return buf;
+}
+
+/* Returns a rule built from SLEEP_DURATION, BED_TIME and WAKE_TIME, as in
+ * config.cpp.
+ */
+static test_case_t legacyCase(const char *name, int sleepDuration,
+                              int bedTime, int wakeTime)
+{
+  return {name, {{SCHED_EVERYDAY, SCHED_MIDNIGHT,
+                  static_cast<int16_t>(wakeTime * 60),
+                  static_cast<int16_t>(bedTime * 60),
+                  static_cast<uint16_t>(sleepDuration)}},
+          {sleepDuration, bedTime, wakeTime}};
+}
+
+int main()
+{
+  setenv("TZ", TEST_TIMEZONE, 1);
+  tzset();
+  // sunrise and sunset are applied to every day
+  setSunTimes(localTime(YEAR, 6, 1, SUNRISE_MINUTE / 60, SUNRISE_MINUTE % 60),
+              localTime(YEAR, 6, 1, SUNSET_MINUTE / 60, SUNSET_MINUTE % 60));
+
+  std::vector<test_case_t> cases = {
+    // the defaults of config.cpp
+    legacyCase("default (30 min, 06-00)", 30, 0, 6),
+    legacyCase("15 min, no bed time", 15, 5, 5),
+    legacyCase("20 min, 07-23", 20, 23, 7),
+    legacyCase("60 min, no bed time", 60, 0, 0),
+    legacyCase("120 min, 00-22", 120, 22, 0),
+    legacyCase("daily at 07", 1440, 7, 7),
+    // intervals that do not divide an hour, across the DST transitions
+    legacyCase("45 min, no bed time", 45, 3, 3),
+    legacyCase("90 min, no bed time", 90, 0, 0),
+    {"weekdays, weekends and sunrise", {
+      {SCHED_WEEKDAYS, SCHED_MIDNIGHT, 6 * 60, 22 * 60, 30},
+      {SCHED_WEEKENDS, SCHED_MIDNIGHT, 8 * 60, 1 * 60, 60},
+      {SCHED_EVERYDAY, SCHED_SUNRISE, -60, 60, 15},
+      {SCHED_SAT, SCHED_MIDNIGHT, 1 * 60 + 30, 2 * 60 + 40, 10},
+      {SCHED_SUN, SCHED_SUNSET, 0, 2 * 60, 60},
+    }, {0, 0, 0}},
+  };
+
+  const time_t from = localTime(YEAR, 1, 1, 0, 0);
+  const time_t to   = localTime(YEAR + 1, 1, 1, 0, 0);
+  for (const test_case_t &tc : cases)
+  {
+    printf("%s\n", tc.name);
+    const std::vector<time_t> expected = expectedSchedule(
+      tc.rules.data(), tc.rules.size(), from, to + 7 * 24 * 3600);
+    std::map<int, int> perDay;
+    for (int offset : {0, -30, 30})
+    {
+      perDay = checkChain(tc, expected, from, to, offset);
+    }
+    checkSweep(tc, from, to);
+
+    // wakes on the days of the DST transitions and the days around them
+    std::map<int, int> expectedPerDay;
+    for (time_t t : expected)
+    {
+      tm local = {};
+      localtime_r(&t, &local);
+      if (t >= from + 120 && t <= to)
+      {
+        ++expectedPerDay[local.tm_yday];
+      }
+    }
+    CHECK(perDay == expectedPerDay, "%s: wakes per day differ", tc.name);
+    printf("  wakes per day:");
+    for (int yday : {65, 66, 67, 303, 304, 305}) // Mar 8 and Nov 1 2026
+    {
+      printf(" %s:%d", dateString(yday), perDay[yday]);
+    }
+    printf("\n");
+  }
+  return checkSummary();
+}
@@ -0,0 +1,221 @@
+/* ULP sample conversion tests for esp32-weather-epd.
+ * Copyright (C) 2026  Luke Marzen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Checks convertUlpSamples() against a model of the ULP program in
+// ulp_sensor.cpp:
+//  - after any number of samples, the last ULP_NUM_SAMPLES (or fewer) are
+//    converted, oldest first, whatever the ULP left in the upper half words
+//  - the integer compensation matches the datasheet example, and the
+//    datasheet's floating point formulas over the sensor's range
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "check.h"
+#include "ulp_history.h"
+
+// the temperature example of the BMP280 datasheet, which the BME280 shares
+static const bme280_calib_data EXAMPLE_CALIB = {
+  27504, 26435, -1000, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+// a BME280 in use
+static const bme280_calib_data SENSOR_CALIB = {
+  28485, 26735, 50, 0, 0, 0, 0, 0, 0, 0, 0, 0, 75, 362, 0, 313, 50, 30};
+
+/* Stores a sample as the ULP program does. ST writes the value to the lower
+ * half of the word and the address of the instruction to the upper half.
+ */
+static void ulpStore(uint32_t *data, uint16_t rawT, uint16_t rawH)
+{
+  const uint32_t upper = 0x5A5u << 16;
+  const uint32_t next = data[0] & 0xFFFF;
+  data[2 + 2 * next] = upper | rawT;
+  data[3 + 2 * next] = upper | rawH;
+  data[0] = upper | ((next + 1) & (ULP_NUM_SAMPLES - 1));
+  if ((data[1] & 0xFFFF) < ULP_NUM_SAMPLES)
+  {
+    data[1] = upper | ((data[1] & 0xFFFF) + 1);
+  }
+}
+
+/* Returns the temperature in Celsius with the datasheet's floating point
+ * formula, and t_fine.
+ */
+static double referenceTemperature(const bme280_calib_data &c, int32_t adcT,
+                                   double *tFine)
+{
+  const double var1 = (adcT / 16384.0 - c.dig_T1 / 1024.0) * c.dig_T2;
+  const double d = adcT / 131072.0 - c.dig_T1 / 8192.0;
+  const double var2 = d * d * c.dig_T3;
+  *tFine = var1 + var2;
+  return *tFine / 5120.0;
+}
+
+/* Returns the relative humidity in % with the datasheet's floating point
+ * formula.
+ */
+static double referenceHumidity(const bme280_calib_data &c, int32_t adcH,
+                                double tFine)
+{
+  double h = tFine - 76800.0;
+  h = (adcH - (c.dig_H4 * 64.0 + c.dig_H5 / 16384.0 * h))
+      * (c.dig_H2 / 65536.0 * (1.0 + c.dig_H6 / 67108864.0 * h
+                               * (1.0 + c.dig_H3 / 67108864.0 * h)));
+  h = h * (1.0 - c.dig_H1 * h / 524288.0);
+  return std::min(std::max(h, 0.0), 100.0);
+}
+
+/* Returns the raw temperature and humidity of sample k of a sequence in
+ * which the temperature rises and the humidity falls.
+ */
+static uint16_t rawTemp(int k)
+{
+  return 30000 + 7 * k;
+}
+
+static uint16_t rawHumidity(int k)
+{
+  return 28000 - 11 * k;
+}
+
+static void checkRing()
+{
+  // every count and next index visits each slot of the ring once
+  for (int count = 0; count <= ULP_NUM_SAMPLES; ++count)
+  {
+    for (uint32_t next = 0; next < ULP_NUM_SAMPLES; ++next)
+    {
+      std::vector<int> seen(ULP_NUM_SAMPLES, 0);
+      for (int n = 0; n < count; ++n)
+      {
+        ++seen[ulpSampleIndex(next, count, n)];
+      }
+      // the newest sample is just before next
+      CHECK(count == 0 || ulpSampleIndex(next, count, count - 1)
+                          == static_cast<int>((next + ULP_NUM_SAMPLES - 1)
+                                              % ULP_NUM_SAMPLES),
+            "count %d, next %u: newest sample misplaced", count, next);
+      int total = 0;
+      for (int s : seen)
+      {
+        CHECK(s <= 1, "count %d, next %u: slot used twice", count, next);
+        total += s;
+      }
+      CHECK(total == count, "count %d, next %u: %d slots", count, next,
+            total);
+    }
+  }
+
+  const uint32_t periodS = 600;
+  for (int taken = 0; taken <= 3 * ULP_NUM_SAMPLES + 1; ++taken)
+  {
+    uint32_t data[ULP_DATA_WORDS] = {};
+    for (int k = 0; k < taken; ++k)
+    {
+      ulpStore(data, rawTemp(k), rawHumidity(k));
+    }
+    const indoor_history_t h = convertUlpSamples(data, periodS, SENSOR_CALIB);
+    const int count = std::min(taken, ULP_NUM_SAMPLES);
+    if (count < 2)
+    {
+      CHECK(h.samples == 0, "%d taken: history from %d samples", taken,
+            h.samples);
+      continue;
+    }
+    CHECK(h.samples == count, "%d taken: %d samples, expected %d", taken,
+          h.samples, count);
+
+    // the expected history, from the last count samples
+    const int first = taken - count;
+    int32_t tFine;
+    const float minTemp = bme280Temperature(SENSOR_CALIB,
+                                            rawTemp(first) << 4, &tFine);
+    const float maxHumidity = bme280Humidity(SENSOR_CALIB,
+                                             rawHumidity(first), tFine);
+    const float maxTemp = bme280Temperature(SENSOR_CALIB,
+                                            rawTemp(taken - 1) << 4, &tFine);
+    const float minHumidity = bme280Humidity(SENSOR_CALIB,
+                                             rawHumidity(taken - 1), tFine);
+    double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+    for (int n = 0; n < count; ++n)
+    {
+      const double x = n * periodS / 3600.0;
+      const double y = bme280Temperature(SENSOR_CALIB,
+                                         rawTemp(first + n) << 4, &tFine);
+      sumX  += x;
+      sumY  += y;
+      sumXX += x * x;
+      sumXY += x * y;
+    }
+    const double trend = (count * sumXY - sumX * sumY)
+                         / (count * sumXX - sumX * sumX);
+    CHECK(h.minTemp == minTemp && h.maxTemp == maxTemp,
+          "%d taken: %.2f-%.2fC, expected %.2f-%.2fC", taken, h.minTemp,
+          h.maxTemp, minTemp, maxTemp);
+    CHECK(h.minHumidity == minHumidity && h.maxHumidity == maxHumidity,
+          "%d taken: %.2f-%.2f%%, expected %.2f-%.2f%%", taken,
+          h.minHumidity, h.maxHumidity, minHumidity, maxHumidity);
+    CHECK(fabs(h.tempTrend - trend) < 1e-3,
+          "%d taken: %.4fC/h, expected %.4fC/h", taken, h.tempTrend, trend);
+  }
+}
+
+static void checkCompensation()
+{
+  int32_t tFine;
+  const float example = bme280Temperature(EXAMPLE_CALIB, 519888, &tFine);
+  CHECK(tFine == 128422 && example == 25.08f,
+        "datasheet example: %.2fC, t_fine %d", example, tFine);
+
+  double maxTempError = 0, maxHumidityError = 0;
+  // the ULP reads adc_T >> 4, 16 bits
+  for (int32_t rawT = 0; rawT <= 0xFFFF; rawT += 3)
+  {
+    double refFine;
+    const double ref = referenceTemperature(SENSOR_CALIB, rawT << 4,
+                                            &refFine);
+    if (ref < -40 || ref > 85)
+    { // outside the sensor's operating range
+      continue;
+    }
+    const double temp = bme280Temperature(SENSOR_CALIB, rawT << 4, &tFine);
+    maxTempError = std::max(maxTempError, fabs(temp - ref));
+    CHECK(fabs(temp - ref) <= 0.01, "raw temperature %d: %.3fC, "
+          "reference %.3fC", rawT, temp, ref);
+
+    if (rawT % 300 != 0)
+    {
+      continue;
+    }
+    for (int32_t rawH = 0; rawH <= 0xFFFF; rawH += 97)
+    {
+      const double humidity = bme280Humidity(SENSOR_CALIB, rawH, tFine);
+      const double refH = referenceHumidity(SENSOR_CALIB, rawH, refFine);
+      maxHumidityError = std::max(maxHumidityError, fabs(humidity - refH));
+      CHECK(fabs(humidity - refH) <= 0.05, "raw humidity %d at %.2fC: "
+            "%.3f%%, reference %.3f%%", rawH, temp, humidity, refH);
+    }
+  }
+  printf("compensation error: %.4fC, %.4f%%RH at most\n", maxTempError,
+         maxHumidityError);
+}
+
+int main()
+{
+  checkRing();
+  checkCompensation();
+  return checkSummary();
+}